@@ -1,5 +1,9 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
+from esphome.components import sensor
+from esphome.const import STATE_CLASS_MEASUREMENT, STATE_CLASS_TOTAL_INCREASING
+
+AUTO_LOAD = ["sensor"]
 
 pico_io_ns = cg.esphome_ns.namespace('pico_io_extension')
 PicoIOExtension = pico_io_ns.class_('PicoIOExtension', cg.Component)
@@ -8,6 +12,23 @@ CONFIG_SCHEMA = cv.Schema({
 	cv.GenerateID(): cv.declare_id(PicoIOExtension),
 	cv.Optional("rx_pin", default=17): cv.int_,
 	cv.Optional("tx_pin", default=18): cv.int_,
+	cv.Optional("max_baud_rate", default=921600): cv.int_range(min=9600, max=921600),
+	cv.Optional("repeat_delay", default="400ms"): cv.positive_time_period_milliseconds,
+	cv.Optional("repeat_interval", default="40ms"): cv.positive_time_period_milliseconds,
+	cv.Optional("input_latency"): sensor.sensor_schema(
+		unit_of_measurement="ms",
+		accuracy_decimals=1,
+		state_class=STATE_CLASS_MEASUREMENT,
+	),
+	cv.Optional("frame_errors"): sensor.sensor_schema(
+		accuracy_decimals=0,
+		state_class=STATE_CLASS_TOTAL_INCREASING,
+	),
+	cv.Optional("link_rtt"): sensor.sensor_schema(
+		unit_of_measurement="ms",
+		accuracy_decimals=2,
+		state_class=STATE_CLASS_MEASUREMENT,
+	),
 })
 
 def to_code(config):
@@ -15,3 +36,15 @@ def to_code(config):
 	yield var
 	yield cg.register_component(var, config)
 	cg.add(var.set_uart_pins(config["rx_pin"], config["tx_pin"]))
+	cg.add(var.set_max_baud_rate(config["max_baud_rate"]))
+	cg.add(var.set_repeat_delay(config["repeat_delay"].total_milliseconds))
+	cg.add(var.set_repeat_interval(config["repeat_interval"].total_milliseconds))
+	if "input_latency" in config:
+		sens = yield sensor.new_sensor(config["input_latency"])
+		cg.add(var.set_input_latency_sensor(sens))
+	if "frame_errors" in config:
+		sens = yield sensor.new_sensor(config["frame_errors"])
+		cg.add(var.set_frame_errors_sensor(sens))
+	if "link_rtt" in config:
+		sens = yield sensor.new_sensor(config["link_rtt"])
+		cg.add(var.set_link_rtt_sensor(sens))
@@ -0,0 +1,87 @@
+#include "hid_key_tracker.h"
+
+namespace esphome {
+namespace pico_io_extension {
+
+// Keyboard reports this in every slot when too many keys are down
+static const uint8_t KEY_ERROR_ROLLOVER = 0x01;
+
+bool HidKeyTracker::is_held(uint8_t keycode) const {
+  for (uint8_t k : keys_) {
+    if (k == keycode)
+      return true;
+  }
+  return false;
+}
+
+void HidKeyTracker::emit(KeyEventType type, uint8_t keycode) {
+  if (event_cb_)
+    event_cb_(KeyEvent{type, keycode, modifiers_});
+}
+
+size_t HidKeyTracker::process_report(const uint8_t *report, uint32_t now_ms) {
+  const uint8_t *keys = report + 2;
+  if (keys[0] == KEY_ERROR_ROLLOVER)
+    return 0;
+  modifiers_ = report[0];
+  size_t events = 0;
+  for (uint8_t old_key : keys_) {
+    if (old_key == 0)
+      continue;
+    bool still_down = false;
+    for (size_t i = 0; i < MAX_KEYS; ++i)
+      still_down |= keys[i] == old_key;
+    if (!still_down) {
+      emit(KeyEventType::RELEASE, old_key);
+      events++;
+      if (old_key == repeat_key_)
+        repeat_key_ = 0;
+    }
+  }
+  for (size_t i = 0; i < MAX_KEYS; ++i) {
+    if (keys[i] == 0 || is_held(keys[i]))
+      continue;
+    emit(KeyEventType::PRESS, keys[i]);
+    events++;
+    // Newest key takes over auto-repeat, like a typematic keyboard; a key that
+    // does not repeat stops it
+    repeat_key_ = is_repeatable(keys[i]) ? keys[i] : 0;
+    next_repeat_ms_ = now_ms + repeat_delay_ms_;
+  }
+  for (size_t i = 0; i < MAX_KEYS; ++i)
+    keys_[i] = keys[i];
+  return events;
+}
+
+bool HidKeyTracker::is_repeatable(uint8_t keycode) {
+  switch (keycode) {
+    case 0x4A:  // Home
+    case 0x4B:  // Page Up
+    case 0x4D:  // End
+    case 0x4E:  // Page Down
+    case 0x4F:  // Right
+    case 0x50:  // Left
+    case 0x51:  // Down
+    case 0x52:  // Up
+      return true;
+    default:
+      return false;
+  }
+}
+
+size_t HidKeyTracker::tick(uint32_t now_ms) {
+  if (repeat_key_ == 0 || repeat_interval_ms_ == 0 || (int32_t) (now_ms - next_repeat_ms_) < 0)
+    return 0;
+  emit(KeyEventType::REPEAT, repeat_key_);
+  // Schedule from now rather than catching up, so a stalled loop never bursts repeats
+  next_repeat_ms_ = now_ms + repeat_interval_ms_;
+  return 1;
+}
+
+void HidKeyTracker::reset(uint32_t now_ms) {
+  uint8_t empty[2 + MAX_KEYS] = {};
+  process_report(empty, now_ms);
+}
+
+}  // namespace pico_io_extension
+}  // namespace esphome
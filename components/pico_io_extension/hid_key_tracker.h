@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace esphome {
+namespace pico_io_extension {
+
+enum class KeyEventType : uint8_t { PRESS, RELEASE, REPEAT };
+
+struct KeyEvent {
+  KeyEventType type;
+  uint8_t keycode;
+  uint8_t modifiers;
+};
+
+// Turns successive 6-key boot protocol reports into press/release events and
+// generates typematic repeat for the most recently pressed key from a clock,
+// independent of how often the keyboard resends its report. Only navigation
+// keys repeat; holding Enter or Esc must not run an action again.
+class HidKeyTracker {
+ public:
+  static constexpr size_t MAX_KEYS = 6;
+
+  void set_event_callback(std::function<void(const KeyEvent &)> cb) { event_cb_ = std::move(cb); }
+  void set_repeat_delay(uint32_t ms) { repeat_delay_ms_ = ms; }
+  // 0 disables auto-repeat
+  void set_repeat_interval(uint32_t ms) { repeat_interval_ms_ = ms; }
+
+  // Feed an 8-byte report; returns the number of events emitted
+  size_t process_report(const uint8_t *report, uint32_t now_ms);
+  // Emit due repeat events; call regularly from the main loop
+  size_t tick(uint32_t now_ms);
+  // Release everything, e.g. when the link to the keyboard is lost
+  void reset(uint32_t now_ms);
+  // Arrows, Page Up/Down, Home and End
+  static bool is_repeatable(uint8_t keycode);
+
+ private:
+  bool is_held(uint8_t keycode) const;
+  void emit(KeyEventType type, uint8_t keycode);
+
+  std::function<void(const KeyEvent &)> event_cb_;
+  uint8_t keys_[MAX_KEYS] = {};
+  uint8_t modifiers_ = 0;
+  uint8_t repeat_key_ = 0;
+  uint32_t next_repeat_ms_ = 0;
+  uint32_t repeat_delay_ms_ = 400;
+  uint32_t repeat_interval_ms_ = 40;
+};
+
+}  // namespace pico_io_extension
+}  // namespace esphome
@@ -1,13 +1,50 @@
-
 #include "pico_io_extension.h"
+#include "esphome/core/hal.h"
 #include "esphome/core/log.h"
 #include "driver/uart.h"
+#include "esp_timer.h"
+#include <cstring>
 
 namespace esphome {
 namespace pico_io_extension {
 
 static const char *TAG = "pico_io_extension";
 
+static const uart_port_t PICO_UART = UART_NUM_1;
+static const size_t REPORT_SIZE = 8;
+static const uint32_t STATS_PUBLISH_INTERVAL_MS = 10000;
+
+static const uint32_t BASE_BAUD_RATE = 9600;
+// Tried highest first; each step down is attempted once before falling back to the base rate
+static const uint32_t CANDIDATE_BAUD_RATES[] = {921600, 460800, 230400, 115200};
+static const size_t NUM_CANDIDATE_BAUD_RATES = sizeof(CANDIDATE_BAUD_RATES) / sizeof(CANDIDATE_BAUD_RATES[0]);
+static const uint32_t NEGOTIATION_TIMEOUT_MS = 250;
+static const uint32_t KEEPALIVE_INTERVAL_MS = 5000;
+static const uint8_t MAX_MISSED_PONGS = 3;
+
+void LatencyHistogram::record(uint32_t us) {
+  size_t i = 0;
+  while (i < NUM_BUCKETS - 1 && us >= BUCKET_LIMITS_US[i])
+    ++i;
+  buckets_[i]++;
+  count_++;
+  if (us > max_us_)
+    max_us_ = us;
+}
+
+uint32_t LatencyHistogram::percentile_us(uint8_t pct) const {
+  if (count_ == 0)
+    return 0;
+  uint32_t target = (count_ * pct + 99) / 100;
+  uint32_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    seen += buckets_[i];
+    if (seen >= target)
+      return i == NUM_BUCKETS - 1 ? max_us_ : BUCKET_LIMITS_US[i];
+  }
+  return max_us_;
+}
+
 void PicoIOExtension::set_uart_pins(int rx, int tx) {
   rx_pin_ = rx;
   tx_pin_ = tx;
@@ -17,35 +54,287 @@ void PicoIOExtension::set_key_press_callback(std::function<void(uint8_t keycode,
   key_press_cb_ = cb;
 }
 
+void PicoIOExtension::send_frame(uint8_t type, const uint8_t *payload, uint8_t len) {
+  uint8_t frame[protocol::MAX_FRAME];
+  size_t size = protocol::encode_frame(type, payload, len, frame);
+  uart_write_bytes(PICO_UART, (const char*)frame, size);
+}
+
 void PicoIOExtension::setPin(uint8_t pin, bool state) {
-  uint8_t cmd[4] = {0x01, pin, static_cast<uint8_t>(state ? 1 : 0), '\n'};
-  uart_write_bytes(UART_NUM_1, (const char*)cmd, 4);
+  uint8_t value = state ? 1 : 0;
+  // Last write per pin wins within a batch
+  for (uint8_t i = 0; i < pending_pins_len_; i += 2) {
+    if (pending_pins_[i] == pin) {
+      pending_pins_[i + 1] = value;
+      return;
+    }
+  }
+  if (pending_pins_len_ + 2u > sizeof(pending_pins_))
+    flush_pins();
+  pending_pins_[pending_pins_len_++] = pin;
+  pending_pins_[pending_pins_len_++] = value;
+}
+
+void PicoIOExtension::flush_pins() {
+  if (pending_pins_len_ == 0)
+    return;
+  send_frame(protocol::MSG_PIN_BATCH, pending_pins_, pending_pins_len_);
+  pending_pins_len_ = 0;
+}
+
+void PicoIOExtension::dispatch_key_event(const KeyEvent &event) {
+  if (key_event_cb_)
+    key_event_cb_(event);
+  if (key_press_cb_ && event.type != KeyEventType::RELEASE)
+    key_press_cb_(event.keycode, event.modifiers);
 }
 
 void PicoIOExtension::setup() {
-  ESP_LOGCONFIG(TAG, "Setting up UART (ESP-IDF) on RX=%d, TX=%d, baud rate=9600...", rx_pin_, tx_pin_);
+  keys_.set_event_callback([this](const KeyEvent &event) { dispatch_key_event(event); });
+  ESP_LOGCONFIG(TAG, "Setting up UART (ESP-IDF) on RX=%d, TX=%d, baud rate=%u...", rx_pin_, tx_pin_,
+                (unsigned) BASE_BAUD_RATE);
   const uart_config_t uart_config = {
-      .baud_rate = 9600,
+      .baud_rate = BASE_BAUD_RATE,
       .data_bits = UART_DATA_8_BITS,
       .parity    = UART_PARITY_DISABLE,
       .stop_bits = UART_STOP_BITS_1,
       .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
       .source_clk = UART_SCLK_APB,
   };
-  uart_driver_install(UART_NUM_1, 256, 0, 0, NULL, 0);
-  uart_param_config(UART_NUM_1, &uart_config);
-  uart_set_pin(UART_NUM_1, tx_pin_, rx_pin_, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+  // TX ring buffer so frame writes from loop() return without waiting for the wire
+  uart_driver_install(PICO_UART, 256, 256, 16, &uart_queue_, 0);
+  uart_param_config(PICO_UART, &uart_config);
+  uart_set_pin(PICO_UART, tx_pin_, rx_pin_, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+  if (xTaskCreate(reader_task, "pico_uart_rx", 3072, this, 5, &reader_task_) != pdPASS) {
+    ESP_LOGE(TAG, "Failed to start UART reader task");
+    mark_failed();
+    return;
+  }
+  propose_next_baud();
+}
+
+void PicoIOExtension::reader_task(void *arg) {
+  static_cast<PicoIOExtension *>(arg)->read_uart_events();
+}
+
+// Reader task body: blocks on the UART event queue and feeds the frame parser
+void PicoIOExtension::read_uart_events() {
+  uint8_t chunk[64];
+  int64_t frame_start_us = 0;
+  uart_event_t event;
+  while (true) {
+    if (xQueueReceive(uart_queue_, &event, portMAX_DELAY) != pdTRUE)
+      continue;
+    switch (event.type) {
+      case UART_DATA: {
+        int64_t now = esp_timer_get_time();
+        size_t available = event.size;
+        while (available > 0) {
+          int n = uart_read_bytes(PICO_UART, chunk, available < sizeof(chunk) ? available : sizeof(chunk), 0);
+          if (n <= 0)
+            break;
+          available -= n;
+          if (parser_.buffered() == 0)
+            frame_start_us = now;
+          parser_.feed(chunk, n, [&](const protocol::Frame &frame) { handle_frame(frame, frame_start_us); });
+          frame_errors_.store(parser_.stats().errors(), std::memory_order_relaxed);
+        }
+        break;
+      }
+      case UART_FIFO_OVF:
+      case UART_BUFFER_FULL:
+        ESP_LOGW(TAG, "UART RX overflow, flushing input");
+        uart_flush_input(PICO_UART);
+        xQueueReset(uart_queue_);
+        parser_.reset();
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+// Called from the reader task for every valid frame
+void PicoIOExtension::handle_frame(const protocol::Frame &frame, int64_t arrival_us) {
+  switch (frame.type) {
+    case protocol::MSG_HID_REPORT: {
+      if (frame.len != REPORT_SIZE)
+        break;
+      HidReport report;
+      memcpy(report.data, frame.payload, REPORT_SIZE);
+      report.arrival_us = arrival_us;
+      if (!reports_.push(report))
+        dropped_reports_++;
+      break;
+    }
+    case protocol::MSG_PING:
+      send_frame(protocol::MSG_PONG, frame.payload, frame.len);
+      break;
+    case protocol::MSG_PONG:
+    case protocol::MSG_BAUD_ACCEPT:
+    case protocol::MSG_BAUD_REJECT:
+      control_frames_.push(frame);
+      break;
+    default:
+      break;
+  }
 }
 
 void PicoIOExtension::loop() {
-  uint8_t report[8];
-  while (uart_read_bytes(UART_NUM_1, report, 8, 20 / portTICK_PERIOD_MS) == 8) {
-    uint8_t modifiers = report[0];
-    for (int i = 2; i < 8; ++i) {
-      if (report[i] == 0) continue;
-      if (key_press_cb_) key_press_cb_(report[i], modifiers);
+  HidReport report;
+  while (reports_.pop(report)) {
+    if (keys_.process_report(report.data, millis()) > 0)
+      latency_.record(static_cast<uint32_t>(esp_timer_get_time() - report.arrival_us));
+  }
+  keys_.tick(millis());
+  update_link();
+  flush_pins();
+  publish_stats();
+}
+
+void PicoIOExtension::update_link() {
+  protocol::Frame frame;
+  while (control_frames_.pop(frame))
+    handle_control_frame(frame);
+
+  uint32_t now = millis();
+  switch (link_state_) {
+    case LinkState::PROPOSING:
+      if ((int32_t) (now - link_deadline_ms_) >= 0)
+        propose_next_baud();
+      break;
+    case LinkState::VERIFYING:
+      if ((int32_t) (now - link_deadline_ms_) >= 0) {
+        // The Pico drops back to the base rate on its own when it hears nothing valid
+        ESP_LOGW(TAG, "No reply at %u baud, reverting", (unsigned) baud_rate_);
+        apply_baud_rate(BASE_BAUD_RATE);
+        propose_next_baud();
+      }
+      break;
+    case LinkState::READY:
+      if (now - last_ping_ms_ < KEEPALIVE_INTERVAL_MS)
+        break;
+      if (pong_pending_ && ++missed_pongs_ >= MAX_MISSED_PONGS) {
+        missed_pongs_ = 0;
+        // A held key's release may be among what got lost; don't repeat it forever
+        keys_.reset(now);
+        if (baud_rate_ != BASE_BAUD_RATE) {
+          ESP_LOGW(TAG, "Pico stopped answering at %u baud, renegotiating", (unsigned) baud_rate_);
+          apply_baud_rate(BASE_BAUD_RATE);
+          candidate_ = -1;
+          propose_next_baud();
+          break;
+        }
+      }
+      send_ping();
+      break;
+  }
+}
+
+void PicoIOExtension::handle_control_frame(const protocol::Frame &frame) {
+  switch (frame.type) {
+    case protocol::MSG_BAUD_ACCEPT:
+    case protocol::MSG_BAUD_REJECT: {
+      if (link_state_ != LinkState::PROPOSING || frame.len != 4 || candidate_ < 0 ||
+          protocol::get_u32(frame.payload) != CANDIDATE_BAUD_RATES[candidate_])
+        break;
+      proposal_answered_ = true;
+      if (frame.type == protocol::MSG_BAUD_REJECT) {
+        propose_next_baud();
+        break;
+      }
+      apply_baud_rate(CANDIDATE_BAUD_RATES[candidate_]);
+      link_state_ = LinkState::VERIFYING;
+      link_deadline_ms_ = millis() + NEGOTIATION_TIMEOUT_MS;
+      send_ping();
+      break;
+    }
+    case protocol::MSG_PONG: {
+      if (frame.len != 8)
+        break;
+      int64_t sent_us;
+      memcpy(&sent_us, frame.payload, sizeof(sent_us));
+      float rtt_ms = (esp_timer_get_time() - sent_us) / 1000.0f;
+      pong_pending_ = false;
+      missed_pongs_ = 0;
+      if (link_state_ == LinkState::VERIFYING) {
+        link_state_ = LinkState::READY;
+        ESP_LOGI(TAG, "Link running at %u baud, round trip %.2f ms", (unsigned) baud_rate_, rtt_ms);
+      } else if (link_state_ == LinkState::READY && renegotiate_on_pong_ && baud_rate_ == BASE_BAUD_RATE) {
+        ESP_LOGI(TAG, "Pico answering at %u baud, negotiating again", (unsigned) baud_rate_);
+        candidate_ = -1;
+        propose_next_baud();
+      }
+      if (link_rtt_sensor_ != nullptr)
+        link_rtt_sensor_->publish_state(rtt_ms);
+      break;
     }
+    default:
+      break;
+  }
+}
+
+void PicoIOExtension::propose_next_baud() {
+  if (candidate_ < 0) {
+    proposal_answered_ = false;
+    renegotiate_on_pong_ = false;
+  }
+  while (++candidate_ < (int) NUM_CANDIDATE_BAUD_RATES) {
+    uint32_t baud = CANDIDATE_BAUD_RATES[candidate_];
+    if (baud > max_baud_rate_)
+      continue;
+    uint8_t payload[4];
+    protocol::put_u32(payload, baud);
+    send_frame(protocol::MSG_BAUD_PROPOSE, payload, sizeof(payload));
+    link_state_ = LinkState::PROPOSING;
+    link_deadline_ms_ = millis() + NEGOTIATION_TIMEOUT_MS;
+    return;
+  }
+  ESP_LOGI(TAG, "No faster baud rate agreed, staying at %u", (unsigned) BASE_BAUD_RATE);
+  renegotiate_on_pong_ = !proposal_answered_;
+  link_state_ = LinkState::READY;
+  last_ping_ms_ = millis() - KEEPALIVE_INTERVAL_MS;
+}
+
+void PicoIOExtension::apply_baud_rate(uint32_t baud) {
+  // Let queued frames leave at the old rate first
+  uart_wait_tx_done(PICO_UART, pdMS_TO_TICKS(50));
+  uart_set_baudrate(PICO_UART, baud);
+  baud_rate_ = baud;
+  // Reports sent while the two ends disagree on the rate are lost, releases included
+  keys_.reset(millis());
+}
+
+void PicoIOExtension::send_ping() {
+  int64_t now_us = esp_timer_get_time();
+  uint8_t payload[8];
+  memcpy(payload, &now_us, sizeof(payload));
+  send_frame(protocol::MSG_PING, payload, sizeof(payload));
+  last_ping_ms_ = millis();
+  pong_pending_ = true;
+}
+
+void PicoIOExtension::publish_stats() {
+  uint32_t now = millis();
+  if (now - last_stats_publish_ms_ < STATS_PUBLISH_INTERVAL_MS)
+    return;
+  last_stats_publish_ms_ = now;
+  uint32_t frame_errors = frame_errors_.load(std::memory_order_relaxed);
+  if (frame_errors_sensor_ != nullptr)
+    frame_errors_sensor_->publish_state(frame_errors);
+  if (frame_errors != reported_frame_errors_) {
+    ESP_LOGW(TAG, "Link frame errors: %u new, %u total", (unsigned) (frame_errors - reported_frame_errors_),
+             (unsigned) frame_errors);
+    reported_frame_errors_ = frame_errors;
   }
+  if (latency_.count() == 0)
+    return;
+  ESP_LOGD(TAG, "Input latency: n=%u p50<=%uus p95<=%uus max=%uus dropped=%u", (unsigned) latency_.count(),
+           (unsigned) latency_.percentile_us(50), (unsigned) latency_.percentile_us(95), (unsigned) latency_.max_us(),
+           (unsigned) dropped_reports_.load());
+  if (input_latency_sensor_ != nullptr)
+    input_latency_sensor_->publish_state(latency_.percentile_us(95) / 1000.0f);
+  latency_.reset();
 }
 
 }  // namespace pico_io_extension
@@ -1,22 +1,123 @@
 #pragma once
 #include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+#include "hid_key_tracker.h"
+#include "pico_protocol.h"
+#include "spsc_ring.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstdint>
 #include <functional>
 
 namespace esphome {
 namespace pico_io_extension {
 
+// Fixed-bucket histogram of input latency in microseconds
+class LatencyHistogram {
+ public:
+  static constexpr size_t NUM_BUCKETS = 8;
+  // Upper bound (exclusive) of each bucket; the last bucket is open-ended
+  static constexpr uint32_t BUCKET_LIMITS_US[NUM_BUCKETS] = {500, 1000, 2000, 5000, 10000, 20000, 50000, UINT32_MAX};
+
+  void record(uint32_t us);
+  // Upper bound of the bucket holding the given percentile (0-100)
+  uint32_t percentile_us(uint8_t pct) const;
+  uint32_t count() const { return count_; }
+  uint32_t max_us() const { return max_us_; }
+  uint32_t bucket(size_t i) const { return buckets_[i]; }
+  void reset() { *this = LatencyHistogram(); }
+
+ private:
+  uint32_t buckets_[NUM_BUCKETS] = {};
+  uint32_t count_ = 0;
+  uint32_t max_us_ = 0;
+};
+
 class PicoIOExtension : public esphome::Component {
  public:
   void set_uart_pins(int rx, int tx);
+  // Called for key presses and auto-repeats of navigation keys
   void set_key_press_callback(std::function<void(uint8_t keycode, uint8_t modifiers)> cb);
+  // Called for every press, release and repeat
+  void set_key_event_callback(std::function<void(const KeyEvent &event)> cb) { key_event_cb_ = std::move(cb); }
+  void set_repeat_delay(uint32_t ms) { keys_.set_repeat_delay(ms); }
+  void set_repeat_interval(uint32_t ms) { keys_.set_repeat_interval(ms); }
+  void set_input_latency_sensor(sensor::Sensor *sensor) { input_latency_sensor_ = sensor; }
+  void set_frame_errors_sensor(sensor::Sensor *sensor) { frame_errors_sensor_ = sensor; }
+  void set_link_rtt_sensor(sensor::Sensor *sensor) { link_rtt_sensor_ = sensor; }
+  void set_max_baud_rate(uint32_t baud) { max_baud_rate_ = baud; }
+  uint32_t get_baud_rate() const { return baud_rate_; }
+  // Queues a pin change; all changes made in one loop iteration go out as one frame
   void setPin(uint8_t pin, bool state);
   void setup() override;
   void loop() override;
 
  private:
+  enum class LinkState : uint8_t {
+    PROPOSING,  // waiting for the Pico to accept or reject candidate_baud()
+    VERIFYING,  // switched baud rate, waiting for a pong at the new rate
+    READY,
+  };
+
+  struct HidReport {
+    uint8_t data[8];
+    int64_t arrival_us;
+  };
+
+  static void reader_task(void *arg);
+  void read_uart_events();
+  void handle_frame(const protocol::Frame &frame, int64_t arrival_us);
+  void send_frame(uint8_t type, const uint8_t *payload, uint8_t len);
+  void publish_stats();
+  void dispatch_key_event(const KeyEvent &event);
+  void flush_pins();
+  // Baud rate negotiation and keepalive, driven from loop()
+  void update_link();
+  void handle_control_frame(const protocol::Frame &frame);
+  void propose_next_baud();
+  void apply_baud_rate(uint32_t baud);
+  void send_ping();
+
   int rx_pin_ = 17;
   int tx_pin_ = 18;
   std::function<void(uint8_t, uint8_t)> key_press_cb_ = nullptr;
+  std::function<void(const KeyEvent &)> key_event_cb_ = nullptr;
+  HidKeyTracker keys_;
+  sensor::Sensor *input_latency_sensor_ = nullptr;
+  sensor::Sensor *frame_errors_sensor_ = nullptr;
+  sensor::Sensor *link_rtt_sensor_ = nullptr;
+
+  QueueHandle_t uart_queue_ = nullptr;
+  TaskHandle_t reader_task_ = nullptr;
+  // Filled by the reader task, drained by loop()
+  SpscRing<HidReport, 32> reports_;
+  std::atomic<uint32_t> dropped_reports_{0};
+  // Owned by the reader task; loop() only reads the error total
+  protocol::FrameParser parser_;
+  std::atomic<uint32_t> frame_errors_{0};
+  uint32_t reported_frame_errors_ = 0;
+  // Link control frames (baud replies, pongs) handed from the reader task to loop()
+  SpscRing<protocol::Frame, 8> control_frames_;
+
+  LinkState link_state_ = LinkState::PROPOSING;
+  uint32_t max_baud_rate_ = 921600;
+  uint32_t baud_rate_ = 9600;
+  int candidate_ = -1;  // index into the candidate baud list
+  // The Pico replied to a proposal in this round; if not, it was probably still
+  // booting, and the next pong at the base rate starts another round
+  bool proposal_answered_ = false;
+  bool renegotiate_on_pong_ = false;
+  uint32_t link_deadline_ms_ = 0;
+  uint32_t last_ping_ms_ = 0;
+  bool pong_pending_ = false;
+  uint8_t missed_pongs_ = 0;
+
+  uint8_t pending_pins_[protocol::MAX_PAYLOAD];
+  uint8_t pending_pins_len_ = 0;
+  LatencyHistogram latency_;
+  uint32_t last_stats_publish_ms_ = 0;
 };
 
 }  // namespace pico_io_extension
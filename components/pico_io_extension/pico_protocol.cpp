@@ -0,0 +1,83 @@
+#include "pico_protocol.h"
+
+namespace esphome {
+namespace pico_io_extension {
+namespace protocol {
+
+uint8_t crc8(const uint8_t *data, size_t len, uint8_t crc) {
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; ++b)
+      crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+  }
+  return crc;
+}
+
+size_t encode_frame(uint8_t type, const uint8_t *payload, uint8_t len, uint8_t *out) {
+  if (len > MAX_PAYLOAD)
+    len = MAX_PAYLOAD;
+  out[0] = SYNC;
+  out[1] = VERSION;
+  out[2] = type;
+  out[3] = len;
+  if (len > 0)
+    memcpy(out + HEADER_SIZE, payload, len);
+  out[HEADER_SIZE + len] = crc8(out + 1, HEADER_SIZE - 1 + len);
+  return HEADER_SIZE + len + 1;
+}
+
+void FrameParser::discard(size_t n) {
+  if (n >= len_) {
+    len_ = 0;
+    return;
+  }
+  memmove(buf_, buf_ + n, len_ - n);
+  len_ -= n;
+}
+
+bool FrameParser::parse_one() {
+  while (len_ > 0) {
+    if (buf_[0] != SYNC) {
+      size_t skip = 1;
+      while (skip < len_ && buf_[skip] != SYNC)
+        ++skip;
+      stats_.skipped_bytes += skip;
+      discard(skip);
+      continue;
+    }
+    if (len_ < 2)
+      return false;
+    if (buf_[1] != VERSION) {
+      stats_.version_errors++;
+      discard(1);
+      continue;
+    }
+    if (len_ < HEADER_SIZE)
+      return false;
+    uint8_t payload_len = buf_[3];
+    if (payload_len > MAX_PAYLOAD) {
+      stats_.length_errors++;
+      discard(1);
+      continue;
+    }
+    size_t total = HEADER_SIZE + payload_len + 1;
+    if (len_ < total)
+      return false;
+    if (crc8(buf_ + 1, total - 2) != buf_[total - 1]) {
+      stats_.crc_errors++;
+      discard(1);
+      continue;
+    }
+    frame_.type = buf_[2];
+    frame_.len = payload_len;
+    memcpy(frame_.payload, buf_ + HEADER_SIZE, payload_len);
+    stats_.frames++;
+    discard(total);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace protocol
+}  // namespace pico_io_extension
+}  // namespace esphome
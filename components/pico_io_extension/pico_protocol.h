@@ -0,0 +1,98 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace esphome {
+namespace pico_io_extension {
+
+// Framed link protocol between the ESP32 and the Pico USB host.
+//
+//   +------+---------+------+-----+-------------+-------+
+//   | 0xA5 | version | type | len | payload...  | crc8  |
+//   +------+---------+------+-----+-------------+-------+
+//
+// crc8 (poly 0x07, init 0x00) covers version, type, len and payload. A
+// receiver that sees a bad version, length or CRC drops only the sync byte
+// and rescans, so a lost or corrupted byte costs at most one frame.
+namespace protocol {
+
+static constexpr uint8_t SYNC = 0xA5;
+static constexpr uint8_t VERSION = 1;
+static constexpr size_t HEADER_SIZE = 4;
+static constexpr size_t MAX_PAYLOAD = 32;
+static constexpr size_t MAX_FRAME = HEADER_SIZE + MAX_PAYLOAD + 1;
+
+enum MessageType : uint8_t {
+  MSG_HID_REPORT = 0x01,    // Pico -> ESP: 8-byte boot protocol keyboard report
+  MSG_SET_PIN = 0x02,       // ESP -> Pico: pin, state
+  MSG_PING = 0x03,          // either way: opaque payload echoed back in a PONG
+  MSG_PONG = 0x04,
+  MSG_PIN_BATCH = 0x05,     // ESP -> Pico: up to 16 (pin, state) pairs applied in order
+  MSG_BAUD_PROPOSE = 0x06,  // ESP -> Pico: u32 LE baud rate
+  MSG_BAUD_ACCEPT = 0x07,   // Pico -> ESP: u32 LE baud rate, Pico switches after sending
+  MSG_BAUD_REJECT = 0x08,   // Pico -> ESP: u32 LE baud rate
+};
+
+inline void put_u32(uint8_t *out, uint32_t v) {
+  out[0] = v;
+  out[1] = v >> 8;
+  out[2] = v >> 16;
+  out[3] = v >> 24;
+}
+
+inline uint32_t get_u32(const uint8_t *in) {
+  return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+uint8_t crc8(const uint8_t *data, size_t len, uint8_t crc = 0);
+
+// Writes a complete frame into out (at least HEADER_SIZE + len + 1 bytes) and returns its size
+size_t encode_frame(uint8_t type, const uint8_t *payload, uint8_t len, uint8_t *out);
+
+struct Frame {
+  uint8_t type;
+  uint8_t len;
+  uint8_t payload[MAX_PAYLOAD];
+};
+
+struct FrameStats {
+  uint32_t frames = 0;
+  uint32_t crc_errors = 0;
+  uint32_t version_errors = 0;
+  uint32_t length_errors = 0;
+  uint32_t skipped_bytes = 0;  // bytes discarded while hunting for a sync byte
+
+  uint32_t errors() const { return crc_errors + version_errors + length_errors; }
+};
+
+// Streaming, resynchronising frame parser
+class FrameParser {
+ public:
+  // Calls on_frame(const Frame &) for every valid frame found in data
+  template<typename F> void feed(const uint8_t *data, size_t len, F &&on_frame) {
+    for (size_t i = 0; i < len; ++i) {
+      buf_[len_++] = data[i];
+      while (parse_one())
+        on_frame(frame_);
+    }
+  }
+
+  size_t buffered() const { return len_; }
+  const FrameStats &stats() const { return stats_; }
+  void reset() { len_ = 0; }
+
+ private:
+  // Extracts one frame from the buffer into frame_; false when more bytes are needed
+  bool parse_one();
+  void discard(size_t n);
+
+  uint8_t buf_[MAX_FRAME];
+  size_t len_ = 0;
+  Frame frame_;
+  FrameStats stats_;
+};
+
+}  // namespace protocol
+}  // namespace pico_io_extension
+}  // namespace esphome
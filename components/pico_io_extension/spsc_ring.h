@@ -0,0 +1,94 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace esphome {
+namespace pico_io_extension {
+
+// Lock-free single-producer/single-consumer ring. One task may push and one
+// other task may pop concurrently; N must be a power of two.
+template<typename T, size_t N> class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+ public:
+  bool push(const T &item) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == N)
+      return false;
+    items_[head & (N - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T &item) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire))
+      return false;
+    item = items_[tail & (N - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t size() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+  static constexpr size_t capacity() { return N; }
+
+ private:
+  T items_[N];
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+};
+
+// Byte stream ring for one producer and one consumer task. Both sides work on
+// contiguous spans of the buffer in place, so a consumer can parse the bytes
+// where the producer left them. N must be a power of two.
+template<size_t N> class SpscByteRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscByteRing capacity must be a power of two");
+
+ public:
+  // Copy as much of data as fits; returns the number of bytes taken
+  size_t write(const uint8_t *data, size_t len) {
+    size_t taken = 0;
+    while (taken < len) {
+      size_t span;
+      uint8_t *dst = this->write_span(span);
+      if (span == 0)
+        break;
+      span = std::min(span, len - taken);
+      memcpy(dst, data + taken, span);
+      this->commit(span);
+      taken += span;
+    }
+    return taken;
+  }
+
+  // Free space at the write position up to the end of the buffer; fill then commit()
+  uint8_t *write_span(size_t &len) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t free = N - (head - tail_.load(std::memory_order_acquire));
+    len = std::min(free, N - (head & (N - 1)));
+    return &bytes_[head & (N - 1)];
+  }
+  void commit(size_t len) { head_.store(head_.load(std::memory_order_relaxed) + len, std::memory_order_release); }
+
+  // Unread bytes at the read position up to the end of the buffer; use then consume()
+  const uint8_t *read_span(size_t &len) const {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    len = std::min(head_.load(std::memory_order_acquire) - tail, N - (tail & (N - 1)));
+    return &bytes_[tail & (N - 1)];
+  }
+  void consume(size_t len) { tail_.store(tail_.load(std::memory_order_relaxed) + len, std::memory_order_release); }
+
+  size_t size() const { return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire); }
+  static constexpr size_t capacity() { return N; }
+
+ private:
+  uint8_t bytes_[N];
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+};
+
+}  // namespace pico_io_extension
+}  // namespace esphome
@@ -1,20 +1,161 @@
 
 import esphome.codegen as cg
 import esphome.config_validation as cv
+from esphome import automation
+from esphome.components import sensor
+from esphome.const import CONF_ID, CONF_TRIGGER_ID, STATE_CLASS_MEASUREMENT
+from .menu_tables import (DEFAULT_BOOT_MESSAGES, DEFAULT_HEADER, DEFAULT_MENU, flatten_menu,
+                          generate_menu_tables, validate_menu)
+from .status_bindings import BINDING_SCHEMA, generate_status_bindings, validate_bindings
+
+AUTO_LOAD = ["sensor"]
 
 robco_display_ns = cg.esphome_ns.namespace('robco_display')
 RobcoDisplayComponent = robco_display_ns.class_('RobcoDisplayComponent', cg.Component)
+MenuActionTrigger = robco_display_ns.class_('MenuActionTrigger', automation.Trigger.template())
+DumpTraceAction = robco_display_ns.class_('DumpTraceAction', automation.Action)
+RenderMode = robco_display_ns.enum('RenderMode', is_class=True)
+RENDER_MODES = {
+    "labels": RenderMode.LABELS,
+    "cell_grid": RenderMode.CELL_GRID,
+}
+CursorStyle = robco_display_ns.enum('CursorStyle', is_class=True)
+CURSOR_STYLES = {
+    "none": CursorStyle.NONE,
+    "block": CursorStyle.BLOCK,
+    "underline": CursorStyle.UNDERLINE,
+}
+GlyphAtlasMode = robco_display_ns.enum('GlyphAtlasMode', is_class=True)
+GLYPH_ATLAS_MODES = {
+    "none": GlyphAtlasMode.NONE,
+    "mask": GlyphAtlasMode.MASK,
+    "rgb565": GlyphAtlasMode.RGB565,
+}
+TraceStage = robco_display_ns.enum('TraceStage', is_class=True)
+# Sensor key under trace: -> pipeline stage; each publishes the stage's p95 in ms
+TRACE_SENSORS = {
+    "key_time": TraceStage.KEY,
+    "view_time": TraceStage.VIEW,
+    "snapshot_time": TraceStage.SNAPSHOT,
+    "lock_wait": TraceStage.LOCK_WAIT,
+    "draw_time": TraceStage.DRAW,
+    "flush_time": TraceStage.FLUSH,
+    "key_to_draw": TraceStage.KEY_TO_DRAW,
+}
 
 # Import pico_io_extension namespace and class
 from ..pico_io_extension import pico_io_ns, PicoIOExtension
 from esphome.components import switch
 
-CONFIG_SCHEMA = cv.Schema({
+def _validate_scanout(config):
+    if "scanout_effects" in config and config["render_mode"] != "cell_grid":
+        raise cv.Invalid("scanout_effects requires render_mode: cell_grid")
+    return config
+
+def _validate_terminal(config):
+    if "terminal" not in config:
+        return config
+    if config["render_mode"] != "cell_grid":
+        raise cv.Invalid("terminal requires render_mode: cell_grid")
+    menu_id = config["terminal"]["menu_id"]
+    menu = config["menu"] if "menu" in config else validate_menu(DEFAULT_MENU)
+    if not any(n["menu_id"] == menu_id and n["type"] == "action" for n in flatten_menu(menu)):
+        raise cv.Invalid(f"terminal: no action entry with menu_id '{menu_id}'")
+    return config
+
+def _validate_menu_actions(config):
+    if "on_menu_action" not in config:
+        return config
+    menu = config["menu"] if "menu" in config else validate_menu(DEFAULT_MENU)
+    ids = {n["menu_id"] for n in flatten_menu(menu) if n["type"] == "action"}
+    for conf in config["on_menu_action"]:
+        if conf["menu_id"] not in ids:
+            raise cv.Invalid(f"on_menu_action: no action entry with menu_id '{conf['menu_id']}'")
+    return config
+
+def _validate_status_bindings(config):
+    menu = config["menu"] if "menu" in config else validate_menu(DEFAULT_MENU)
+    validate_bindings(config["status_bindings"], config["status_subscriptions"], flatten_menu(menu))
+    return config
+
+CONFIG_SCHEMA = cv.All(cv.Schema({
     cv.GenerateID(): cv.declare_id(RobcoDisplayComponent),
     cv.Optional("pico_io_extension"): cv.use_id(PicoIOExtension),
+    # Screen text, compiled into constexpr flash tables; defaults are the stock vault terminal
+    cv.Optional("header", default=DEFAULT_HEADER): cv.ensure_list(cv.string),
+    cv.Optional("boot_messages", default=DEFAULT_BOOT_MESSAGES): cv.ensure_list(cv.string),
+    cv.Optional("menu"): validate_menu,
     cv.Optional("red_light_pin", default=17): cv.int_,
     cv.Optional("green_light_pin", default=21): cv.int_,
-})
+    cv.Optional("render_mode", default="cell_grid"): cv.enum(RENDER_MODES, lower=True),
+    cv.Optional("glyph_atlas", default="mask"): cv.enum(GLYPH_ATLAS_MODES, lower=True),
+    cv.Optional("glyph_benchmark", default=False): cv.boolean,
+    # Cursor on the selection, password and boot text (cell_grid only); 0ms blink keeps it steady
+    cv.Optional("cursor", default="block"): cv.enum(CURSOR_STYLES, lower=True),
+    cv.Optional("cursor_blink_interval", default="500ms"): cv.positive_time_period_milliseconds,
+    # Post-processing of drawn cells in cell_grid mode; leave out to draw plain text
+    cv.Optional("crt_effects"): cv.Schema({
+        cv.Optional("scanline_brightness", default="75%"): cv.percentage,
+        cv.Optional("bloom", default="30%"): cv.percentage,
+        # Baked into cells drawn in different frames, these left the screen patchy
+        cv.Optional("flicker"): cv.invalid("flicker has moved to scanout_effects, which applies it to whole frames"),
+        cv.Optional("noise"): cv.invalid("noise is no longer supported"),
+    }),
+    # Scan the cell grid out from the RGB panel's bounce buffer ISR with per-line
+    # effects; needs render_mode cell_grid and replaces the panel framebuffers
+    cv.Optional("scanout_effects"): cv.Schema({
+        cv.Optional("scanline_brightness", default="80%"): cv.percentage,
+        cv.Optional("roll_bar_brightness", default="85%"): cv.percentage,
+        cv.Optional("roll_bar_height", default=40): cv.int_range(min=0, max=480),
+        cv.Optional("jitter", default=2): cv.int_range(min=0, max=16),
+        cv.Optional("flicker", default="5%"): cv.percentage,
+    }),
+    # The 800x480 panel at a 12 MHz pixel clock refreshes at about 25 Hz
+    cv.Optional("frame_interval", default="40ms"): cv.positive_time_period_milliseconds,
+    # Boot text is typed out at this many characters per second (0 = all at once)
+    cv.Optional("boot_typing_speed", default=120): cv.int_range(min=0, max=10000),
+    cv.Optional("boot_tick_budget", default="2ms"): cv.positive_time_period_microseconds,
+    # Core for the LVGL and render tasks (-1 = unpinned); keeps UI work off the networking core
+    cv.Optional("render_core", default=1): cv.int_range(min=-1, max=1),
+    # Data partition holding the log shown by menu entries of type logs; a ring of
+    # flash sectors that survives reboots. Empty disables the log.
+    cv.Optional("log_partition", default="spiffs"): cv.string,
+    # Cycle counter timing of the render pipeline; dump it with robco_display.dump_trace
+    cv.Optional("trace", default={}): cv.Schema({
+        cv.Optional("enabled", default=True): cv.boolean,
+        cv.Optional("update_interval", default="60s"): cv.positive_time_period_milliseconds,
+        **{cv.Optional(key): sensor.sensor_schema(
+            unit_of_measurement="ms",
+            accuracy_decimals=3,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ) for key in TRACE_SENSORS},
+    }),
+    # Door commands wait in a bounded outbox while MQTT is down; an unsent one is
+    # dropped after command_expiry, a sent one waits command_ack_timeout for the door state
+    cv.Optional("command_qos", default=1): cv.int_range(min=0, max=2),
+    cv.Optional("command_expiry", default="60s"): cv.positive_time_period_milliseconds,
+    cv.Optional("command_ack_timeout", default="10s"): cv.positive_time_period_milliseconds,
+    # MQTT topics shown in status entries, looked up through a generated perfect hash
+    cv.Optional("status_bindings", default=[]): cv.ensure_list(BINDING_SCHEMA),
+    # Filters to subscribe to instead of one subscription per bound topic, e.g. home/#
+    cv.Optional("status_subscriptions", default=[]): cv.ensure_list(cv.string),
+    # Status changes within this window of the first one share a render, so the
+    # burst of retained messages after connecting draws the screen once
+    cv.Optional("status_batch_window", default="100ms"): cv.positive_time_period_milliseconds,
+    # VT100/ANSI terminal on the cell grid, opened from a menu entry and closed with
+    # Esc; bytes come from the MQTT topic and from write_terminal() in lambdas
+    cv.Optional("terminal"): cv.Schema({
+        cv.Required("menu_id"): cv.string,
+        cv.Optional("topic"): cv.string,
+        # LF also returns the carriage, for sources that send bare \n line ends
+        cv.Optional("newline_mode", default=False): cv.boolean,
+    }),
+    # Automations run when the menu entry with the given id is activated
+    cv.Optional("on_menu_action"): automation.validate_automation({
+        cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(MenuActionTrigger),
+        cv.Required("menu_id"): cv.string,
+    }),
+}), _validate_scanout, _validate_terminal, _validate_menu_actions, _validate_status_bindings)
 
 def to_code(config):
     var = cg.new_Pvariable(config["id"])
@@ -22,8 +163,55 @@ def to_code(config):
     if "pico_io_extension" in config:
         ext = yield cg.get_variable(config["pico_io_extension"])
         cg.add(var.set_pico_io_extension(ext))
+    menu = config["menu"] if "menu" in config else validate_menu(DEFAULT_MENU)
+    nodes = generate_menu_tables(var, config[CONF_ID].id, config["header"], config["boot_messages"], menu)
+    generate_status_bindings(var, config[CONF_ID].id, config["status_bindings"], config["status_subscriptions"],
+                             nodes)
+    cg.add(var.set_status_batch_window(config["status_batch_window"].total_milliseconds))
     cg.add(var.set_red_light_pin(config.get("red_light_pin", 17)))
     cg.add(var.set_green_light_pin(config.get("green_light_pin", 21)))
+    cg.add(var.set_render_mode(config["render_mode"]))
+    cg.add(var.set_glyph_atlas_mode(config["glyph_atlas"]))
+    cg.add(var.set_glyph_benchmark(config["glyph_benchmark"]))
+    cg.add(var.set_cursor_style(config["cursor"]))
+    cg.add(var.set_cursor_blink_interval(config["cursor_blink_interval"].total_milliseconds))
+    if "crt_effects" in config:
+        effects = config["crt_effects"]
+        cg.add(var.set_crt_effects(effects["scanline_brightness"], effects["bloom"]))
+    if "scanout_effects" in config:
+        scanout = config["scanout_effects"]
+        cg.add(var.set_scanout_effects(scanout["scanline_brightness"], scanout["roll_bar_brightness"],
+                                       scanout["roll_bar_height"], scanout["jitter"], scanout["flicker"]))
+    cg.add(var.set_frame_interval(config["frame_interval"].total_milliseconds))
+    cg.add(var.set_boot_typing_speed(config["boot_typing_speed"]))
+    cg.add(var.set_boot_tick_budget(config["boot_tick_budget"].total_microseconds))
+    cg.add(var.set_render_core(config["render_core"]))
+    cg.add(var.set_log_partition(config["log_partition"]))
+    cg.add(var.set_command_qos(config["command_qos"]))
+    cg.add(var.set_command_expiry(config["command_expiry"].total_milliseconds))
+    cg.add(var.set_command_ack_timeout(config["command_ack_timeout"].total_milliseconds))
+    if "terminal" in config:
+        terminal = config["terminal"]
+        cg.add(var.set_terminal_menu_id(terminal["menu_id"]))
+        if "topic" in terminal:
+            cg.add(var.set_terminal_topic(terminal["topic"]))
+        cg.add(var.set_terminal_newline_mode(terminal["newline_mode"]))
+    trace = config["trace"]
+    cg.add(var.set_trace_enabled(trace["enabled"]))
+    cg.add(var.set_trace_interval(trace["update_interval"].total_milliseconds))
+    for key, stage in TRACE_SENSORS.items():
+        if key in trace:
+            sens = yield sensor.new_sensor(trace[key])
+            cg.add(var.set_trace_sensor(stage, sens))
+    for conf in config.get("on_menu_action", []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var, conf["menu_id"])
+        yield automation.build_automation(trigger, [], conf)
     yield cg.register_component(var, config)
 
+@automation.register_action("robco_display.dump_trace", DumpTraceAction,
+                            automation.maybe_simple_id({cv.GenerateID(): cv.use_id(RobcoDisplayComponent)}))
+def dump_trace_to_code(config, action_id, template_arg, args):
+    parent = yield cg.get_variable(config[CONF_ID])
+    yield cg.new_Pvariable(action_id, template_arg, parent)
+
 robco_display = RobcoDisplayComponent
@@ -0,0 +1,143 @@
+#include "bounce_scanout.h"
+#include "crt_effects.h"
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+#include <cstring>
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        static constexpr uint32_t CPU_MHZ = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+
+        void BounceScanout::configure(const ScanoutEffectConfig &config, const esp_lcd_rgb_timing_t &timing,
+                                      size_t bounce_lines)
+        {
+            config_ = config;
+            h_res_ = timing.h_res;
+            v_res_ = timing.v_res;
+            bounce_lines_ = bounce_lines;
+            // While one bounce buffer is filled the panel scans out the other one
+            uint32_t line_clocks = timing.h_res + timing.hsync_pulse_width + timing.hsync_back_porch + timing.hsync_front_porch;
+            line_budget_ns_ = (uint32_t)((uint64_t)line_clocks * 1000000000ull / timing.pclk_hz);
+            fill_budget_cycles_ = (uint32_t)((uint64_t)line_budget_ns_ * bounce_lines * CPU_MHZ / 1000);
+        }
+
+        bool BounceScanout::attach(esp_lcd_panel_handle_t panel)
+        {
+            esp_lcd_rgb_panel_event_callbacks_t cbs = {};
+            cbs.on_bounce_empty = on_bounce_empty;
+            cbs.on_bounce_frame_finish = on_frame_finish;
+            return esp_lcd_rgb_panel_register_event_callbacks(panel, &cbs, this) == ESP_OK;
+        }
+
+        IRAM_ATTR bool BounceScanout::on_bounce_empty(esp_lcd_panel_handle_t panel, void *bounce_buf, int pos_px,
+                                                      int len_bytes, void *user_ctx)
+        {
+            ((BounceScanout *)user_ctx)->fill((uint16_t *)bounce_buf, pos_px, len_bytes);
+            return false;
+        }
+
+        IRAM_ATTR bool BounceScanout::on_frame_finish(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata,
+                                                      void *user_ctx)
+        {
+            BounceScanout *self = (BounceScanout *)user_ctx;
+            self->frame_++;
+            if (self->config_.roll_bar_height > 0)
+            {
+                self->roll_top_ += self->config_.roll_bar_speed;
+                if (self->roll_top_ >= self->v_res_)
+                    self->roll_top_ -= self->v_res_ + self->config_.roll_bar_height;
+            }
+            if (self->config_.flicker_depth > 0)
+            {
+                uint32_t h = self->frame_ * 0x9E3779B1u;
+                h ^= h >> 16;
+                self->flicker_level_ = 32 - h % (self->config_.flicker_depth + 1);
+            }
+            self->frames_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        IRAM_ATTR void BounceScanout::fill(uint16_t *dst, int pos_px, int len_bytes)
+        {
+            uint32_t start = esp_cpu_get_cycle_count();
+            int lines = len_bytes / (h_res_ * (int)sizeof(uint16_t));
+            int line = pos_px / h_res_;
+            if (source_ == nullptr)
+            {
+                memset(dst, 0, len_bytes);
+            }
+            else
+            {
+                for (int i = 0; i < lines; ++i, dst += h_res_)
+                    fill_line(dst, source_ + (size_t)(line + i) * h_res_, line + i);
+            }
+            uint32_t cycles = esp_cpu_get_cycle_count() - start;
+            fills_.fetch_add(1, std::memory_order_relaxed);
+            lines_.fetch_add(lines, std::memory_order_relaxed);
+            total_cycles_.fetch_add(cycles, std::memory_order_relaxed);
+            if (cycles > max_fill_cycles_.load(std::memory_order_relaxed))
+                max_fill_cycles_.store(cycles, std::memory_order_relaxed);
+            if (cycles > fill_budget_cycles_)
+                overruns_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        IRAM_ATTR void BounceScanout::fill_line(uint16_t *dst, const uint16_t *src, int line)
+        {
+            uint8_t level = (line & 1) ? config_.scanline_level : 32;
+            if (line >= roll_top_ && line < roll_top_ + config_.roll_bar_height)
+                level = (uint8_t)((level * config_.roll_bar_level) >> 5);
+            level = (uint8_t)((level * flicker_level_) >> 5);
+            int shift = 0;
+            if (config_.jitter_px > 0)
+            {
+                // About one line in 64 per frame is displaced, like a loose horizontal hold
+                uint32_t h = (uint32_t)line * 0x9E3779B1u ^ frame_ * 0x85EBCA77u;
+                h ^= h >> 15;
+                h *= 0x2C1B3C6Du;
+                h ^= h >> 12;
+                if ((h & 63) == 0)
+                    shift = 1 + (int)((h >> 6) % config_.jitter_px);
+            }
+            if (shift > 0)
+            {
+                memset(dst, 0, shift * sizeof(uint16_t));
+                dst += shift;
+            }
+            int w = h_res_ - shift;
+            if (level >= 32)
+            {
+                memcpy(dst, src, w * sizeof(uint16_t));
+                return;
+            }
+            for (int x = 0; x < w; ++x)
+                dst[x] = CrtEffects::scale_packed(src[x], level);
+        }
+
+        ScanoutStats BounceScanout::take_stats()
+        {
+            ScanoutStats now;
+            now.frames = frames_.load(std::memory_order_relaxed);
+            now.fills = fills_.load(std::memory_order_relaxed);
+            uint32_t lines = lines_.load(std::memory_order_relaxed);
+            uint32_t cycles = total_cycles_.load(std::memory_order_relaxed);
+            now.overruns = overruns_.load(std::memory_order_relaxed);
+            ScanoutStats delta;
+            delta.frames = now.frames - taken_.frames;
+            delta.fills = now.fills - taken_.fills;
+            delta.overruns = now.overruns - taken_.overruns;
+            uint32_t delta_lines = lines - taken_lines_;
+            uint32_t delta_cycles = cycles - taken_cycles_;
+            delta.avg_line_ns = delta_lines ? (uint32_t)((uint64_t)delta_cycles * 1000 / CPU_MHZ / delta_lines) : 0;
+            uint32_t max_cycles = max_fill_cycles_.exchange(0, std::memory_order_relaxed);
+            delta.max_line_ns = bounce_lines_ ? (uint32_t)((uint64_t)max_cycles * 1000 / CPU_MHZ / bounce_lines_) : 0;
+            delta.budget_line_ns = line_budget_ns_;
+            taken_ = now;
+            taken_lines_ = lines;
+            taken_cycles_ = cycles;
+            return delta;
+        }
+    } // namespace robco_display
+} // namespace esphome
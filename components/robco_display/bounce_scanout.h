@@ -0,0 +1,82 @@
+#ifndef BOUNCE_SCANOUT_H
+#define BOUNCE_SCANOUT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+extern "C"
+{
+#include "esp_lcd_panel_rgb.h"
+}
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        struct ScanoutEffectConfig
+        {
+            // 5-bit brightness factors, 32 = unchanged
+            uint8_t scanline_level = 32; // odd panel lines
+            uint8_t roll_bar_level = 32; // lines inside the rolling bar
+            uint16_t roll_bar_height = 0;
+            uint16_t roll_bar_speed = 2; // lines the bar moves per frame
+            uint8_t jitter_px = 0;       // max horizontal displacement of a glitching line
+            uint8_t flicker_depth = 0;   // the whole frame's brightness drops by up to this much
+        };
+
+        struct ScanoutStats
+        {
+            uint32_t frames = 0;
+            uint32_t fills = 0;          // bounce buffers filled
+            uint32_t max_line_ns = 0;    // slowest fill divided by its line count
+            uint32_t avg_line_ns = 0;
+            uint32_t budget_line_ns = 0; // time the panel takes to scan one line out
+            uint32_t overruns = 0;       // fills slower than scanning out a bounce buffer
+        };
+
+        // Feeds the RGB panel from a framebuffer we own, one bounce buffer at a time,
+        // applying per-line CRT effects while copying. The panel must be created
+        // with no driver framebuffer so that IDF calls on_bounce_empty.
+        class BounceScanout
+        {
+        public:
+            void configure(const ScanoutEffectConfig &config, const esp_lcd_rgb_timing_t &timing, size_t bounce_lines);
+            // Framebuffer of h_res * v_res RGB565 pixels read from the ISR
+            void set_source(const uint16_t *fb) { source_ = fb; }
+            // Registers the fill and frame callbacks on the panel
+            bool attach(esp_lcd_panel_handle_t panel);
+            ScanoutStats take_stats();
+
+        private:
+            static bool on_bounce_empty(esp_lcd_panel_handle_t panel, void *bounce_buf, int pos_px, int len_bytes,
+                                        void *user_ctx);
+            static bool on_frame_finish(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata,
+                                        void *user_ctx);
+            void fill(uint16_t *dst, int pos_px, int len_bytes);
+            void fill_line(uint16_t *dst, const uint16_t *src, int line);
+
+            ScanoutEffectConfig config_;
+            const uint16_t *source_ = nullptr;
+            int h_res_ = 0;
+            int v_res_ = 0;
+            uint32_t fill_budget_cycles_ = 0;
+            uint32_t line_budget_ns_ = 0;
+            size_t bounce_lines_ = 0;
+            // Advanced once per frame by the ISR
+            uint32_t frame_ = 0;
+            int roll_top_ = 0;
+            uint8_t flicker_level_ = 32;
+            // Written from the ISR, read by take_stats()
+            std::atomic<uint32_t> frames_{0};
+            std::atomic<uint32_t> fills_{0};
+            std::atomic<uint32_t> lines_{0};
+            std::atomic<uint32_t> total_cycles_{0};
+            std::atomic<uint32_t> max_fill_cycles_{0};
+            std::atomic<uint32_t> overruns_{0};
+            ScanoutStats taken_;
+            uint32_t taken_lines_ = 0;
+            uint32_t taken_cycles_ = 0;
+        };
+    } // namespace robco_display
+} // namespace esphome
+#endif // BOUNCE_SCANOUT_H
@@ -0,0 +1,93 @@
+#include "crt_effects.h"
+#include <algorithm>
+#include <cstring>
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        // Reference 5-bit scale, one channel at a time
+        static inline uint16_t scale_channels(uint16_t px, uint8_t a)
+        {
+            uint32_t r = ((px >> 11) & 0x1F) * a >> 5;
+            uint32_t g = ((px >> 5) & 0x3F) * a >> 5;
+            uint32_t b = (px & 0x1F) * a >> 5;
+            return (uint16_t)((r << 11) | (g << 5) | b);
+        }
+
+        void CrtEffects::configure(const CrtEffectConfig &config, size_t max_width)
+        {
+            config_ = config;
+            enabled_ = config.scanline_level < 32 || config.bloom_level > 0;
+            row_.assign(max_width + 2, 0);
+        }
+
+        void CrtEffects::apply_reference(uint16_t *buf, size_t stride_px, int x, int y, int w, int h)
+        {
+            for (int j = 0; j < h; ++j)
+            {
+                uint16_t *px = buf + (size_t)(y + j) * stride_px + x;
+                memcpy(row_.data() + 1, px, w * sizeof(uint16_t));
+                row_[0] = row_[w + 1] = 0;
+                uint8_t level = row_level(y + j);
+                for (int i = 0; i < w; ++i)
+                {
+                    uint16_t p = row_[i + 1];
+                    if (config_.bloom_level && !is_lit(p))
+                    {
+                        if (is_lit(row_[i]))
+                            p = scale_channels(row_[i], config_.bloom_level);
+                        else if (is_lit(row_[i + 2]))
+                            p = scale_channels(row_[i + 2], config_.bloom_level);
+                    }
+                    px[i] = scale_channels(p, level);
+                }
+            }
+        }
+
+        void CrtEffects::apply(uint16_t *buf, size_t stride_px, int x, int y, int w, int h)
+        {
+            const bool bloom = config_.bloom_level > 0;
+            for (int j = 0; j < h; ++j)
+            {
+                uint16_t *px = buf + (size_t)(y + j) * stride_px + x;
+                uint8_t level = row_level(y + j);
+                if (bloom)
+                {
+                    memcpy(row_.data() + 1, px, w * sizeof(uint16_t));
+                    row_[0] = row_[w + 1] = 0;
+                    const uint16_t *src = row_.data() + 1;
+                    for (int i = 0; i < w; ++i)
+                    {
+                        if (!is_lit(src[i]))
+                        {
+                            if (is_lit(src[i - 1]))
+                                px[i] = scale_packed(src[i - 1], config_.bloom_level);
+                            else if (is_lit(src[i + 1]))
+                                px[i] = scale_packed(src[i + 1], config_.bloom_level);
+                        }
+                    }
+                }
+                if (level < 32)
+                {
+                    for (int i = 0; i < w; ++i)
+                        px[i] = scale_packed(px[i], level);
+                }
+            }
+        }
+
+        bool CrtEffects::self_test()
+        {
+            // Rows no wider than configure() sized the row buffer for
+            const int stride = 24, h = 8;
+            const int w = std::min<int>(stride, (int)row_.size() - 2);
+            uint16_t a[stride * h], b[stride * h];
+            for (int i = 0; i < stride * h; ++i)
+                a[i] = (i % 5 < 2) ? (uint16_t)(0x07E0 | (i * 0x0821)) : (uint16_t)(i * 0x1043 & 0x18E3);
+            memcpy(b, a, sizeof(a));
+            apply(a, stride, 0, 0, w, h);
+            apply_reference(b, stride, 0, 0, w, h);
+            return memcmp(a, b, sizeof(a)) == 0;
+        }
+    } // namespace robco_display
+} // namespace esphome
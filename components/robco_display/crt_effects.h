@@ -0,0 +1,56 @@
+#ifndef CRT_EFFECTS_H
+#define CRT_EFFECTS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        struct CrtEffectConfig
+        {
+            // Brightness factors are 5-bit fixed point: 32 = unchanged, 0 = black
+            uint8_t scanline_level = 32; // odd pixel rows
+            uint8_t bloom_level = 0;     // dark pixels next to lit ones take this share of their neighbour
+        };
+
+        // Post-process applied to freshly drawn regions of an RGB565 framebuffer:
+        // horizontal phosphor bloom and scanline darkening. Both depend only on
+        // the pixel's position and neighbours, so a cell comes out the same
+        // whichever frame drew it; frame flicker is a scanout effect.
+        //
+        // apply() is the packed fast path; apply_reference() is the plain
+        // per-channel implementation it must match bit for bit. Both use the same
+        // 5-bit channel scaling, c' = (c * a) >> 5, so the packed form is exact.
+        class CrtEffects
+        {
+        public:
+            void configure(const CrtEffectConfig &config, size_t max_width);
+            bool enabled() const { return enabled_; }
+            void apply(uint16_t *buf, size_t stride_px, int x, int y, int w, int h);
+            void apply_reference(uint16_t *buf, size_t stride_px, int x, int y, int w, int h);
+            // Runs both paths over a synthetic pattern; true if they agree
+            bool self_test();
+
+            // 5-bit scale of all three channels with one multiply: green is spread
+            // into the upper half-word so each channel has room to grow by 5 bits
+            static inline uint16_t scale_packed(uint16_t px, uint8_t a)
+            {
+                uint32_t x = (px | ((uint32_t)px << 16)) & 0x07E0F81F;
+                x = ((x * a) >> 5) & 0x07E0F81F;
+                return (uint16_t)(x | (x >> 16));
+            }
+
+        private:
+            uint8_t row_level(int y) const { return (y & 1) ? config_.scanline_level : 32; }
+            static bool is_lit(uint16_t px) { return (px & 0x07E0) >= (8 << 5); }
+
+            CrtEffectConfig config_;
+            bool enabled_ = false;
+            std::vector<uint16_t> row_;
+        };
+    } // namespace robco_display
+} // namespace esphome
+#endif // CRT_EFFECTS_H
@@ -5,7 +5,12 @@
 #include "esp_lcd_panel_rgb.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_lcd_panel_interface.h"
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include <algorithm>
+#include <cstring>
 
 /* LCD settings */
 #define APP_LCD_LVGL_FULL_REFRESH (0)
@@ -17,6 +22,14 @@
 #define APP_LCD_RGB_BUFFER_NUMS (2)
 #define APP_LCD_RGB_BOUNCE_BUFFER_HEIGHT (10)
 
+/* Cell grid settings */
+#define APP_GRID_LEFT_MARGIN (20)
+#define APP_GRID_TOP_MARGIN (0)
+
+/* Render task settings */
+#define APP_RENDER_TASK_PRIORITY (4)
+#define APP_RENDER_TASK_STACK (4096)
+
 #include "crt_terminal_renderer.h"
 // note, removed .static_bitmap field from the structure to compile
 #include "FSEX302.c"
@@ -25,6 +38,8 @@ namespace esphome
 {
     namespace robco_display
     {
+        static const char *TAG = "CRTTerminalRenderer";
+
         CRTTerminalRenderer::CRTTerminalRenderer() {}
 
         void CRTTerminalRenderer::lock()
@@ -39,10 +54,9 @@ namespace esphome
 
         void CRTTerminalRenderer::init()
         {
-            static const char *TAG = "CRTTerminalRenderer";
             // LCD panel init
             esp_lcd_panel_handle_t lcd_panel;
-            const esp_lcd_rgb_panel_config_t conf = {
+            esp_lcd_rgb_panel_config_t conf = {
                 .clk_src = LCD_CLK_SRC_DEFAULT,
                 .timings = BSP_LCD_PANEL_TIMING(),
                 .data_width = 16,
@@ -58,11 +72,49 @@ namespace esphome
                 .data_gpio_nums = BSP_LCD_GPIO_DATA(),
                 .flags = {.fb_in_psram = 1},
             };
+            const bool scanout = this->scanout_active();
+            // The cell grid draws into the panel's two framebuffers itself when the font
+            // suits it; LVGL only gets a display for the label renderer
+            const bool swap = !scanout && this->render_mode_ == RenderMode::CELL_GRID &&
+                              this->blitter_.init(&fixedsys);
+            if (scanout)
+            {
+                // Without a driver framebuffer IDF asks on_bounce_empty for every bounce buffer
+                conf.num_fbs = 0;
+                conf.flags.no_fb = 1;
+            }
+            else if (!swap && this->render_mode_ == RenderMode::CELL_GRID)
+            {
+                ESP_LOGE(TAG, "Font is not usable for cell rendering, falling back to labels");
+                this->render_mode_ = RenderMode::LABELS;
+            }
             if (esp_lcd_new_rgb_panel(&conf, &lcd_panel) != ESP_OK)
             {
                 ESP_LOGE(TAG, "RGB init failed");
                 return;
             }
+            if (scanout)
+            {
+                this->scanout_.configure(this->scanout_config_, conf.timings, APP_LCD_RGB_BOUNCE_BUFFER_HEIGHT);
+                if (!this->scanout_.attach(lcd_panel))
+                {
+                    ESP_LOGE(TAG, "Bounce buffer callback registration failed");
+                    esp_lcd_panel_del(lcd_panel);
+                    return;
+                }
+            }
+            if (swap)
+            {
+                esp_lcd_rgb_panel_event_callbacks_t cbs = {};
+                cbs.on_vsync = on_vsync;
+                this->vsync_ = xSemaphoreCreateBinary();
+                if (this->vsync_ == nullptr || esp_lcd_rgb_panel_register_event_callbacks(lcd_panel, &cbs, this) != ESP_OK)
+                {
+                    ESP_LOGE(TAG, "Vsync callback registration failed");
+                    esp_lcd_panel_del(lcd_panel);
+                    return;
+                }
+            }
             if (esp_lcd_panel_init(lcd_panel) != ESP_OK)
             {
                 ESP_LOGE(TAG, "LCD init failed");
@@ -74,7 +126,7 @@ namespace esphome
             const lvgl_port_cfg_t lvgl_cfg = {
                 .task_priority = 4,
                 .task_stack = 8192,
-                .task_affinity = -1,
+                .task_affinity = this->task_core_,
                 .task_max_sleep_ms = 500,
                 .timer_period_ms = 5};
             if (lvgl_port_init(&lvgl_cfg) != ESP_OK)
@@ -82,6 +134,44 @@ namespace esphome
                 ESP_LOGE(TAG, "LVGL port initialization failed");
                 return;
             }
+            if (scanout)
+            {
+                // LVGL keeps its task and lock but gets no display: the draw buffer is
+                // the only framebuffer and the ISR reads it directly. Cells are written
+                // while the panel scans, so a changing cell can show half-drawn for one frame.
+                lvgl_port_lock(0);
+                this->init_cell_grid(nullptr);
+                lvgl_port_unlock();
+                if (this->render_mode_ != RenderMode::CELL_GRID)
+                {
+                    ESP_LOGE(TAG, "Bounce scanout needs the cell grid, display stays blank");
+                    return;
+                }
+                this->scanout_.set_source(this->draw_buf_);
+                ESP_LOGI(TAG, "Bounce scanout: %u lines per fill", (unsigned)APP_LCD_RGB_BOUNCE_BUFFER_HEIGHT);
+                return;
+            }
+            if (swap)
+            {
+                // LVGL keeps its task, lock and timers but gets no display. Cells are drawn
+                // into the framebuffer the panel is not showing and present() swaps the two
+                // on vsync, the way the port's avoid_tearing mode does for LVGL's display.
+                void *fb0 = nullptr, *fb1 = nullptr;
+                if (esp_lcd_rgb_panel_get_frame_buffer(lcd_panel, 2, &fb0, &fb1) != ESP_OK)
+                {
+                    ESP_LOGE(TAG, "Panel framebuffers unavailable, display stays blank");
+                    return;
+                }
+                this->panel_ = lcd_panel;
+                this->fbs_[0] = (uint16_t *)fb0;
+                this->fbs_[1] = (uint16_t *)fb1;
+                memset(fb0, 0, BSP_LCD_H_RES * BSP_LCD_V_RES * sizeof(uint16_t));
+                lvgl_port_lock(0);
+                // The panel starts out showing the first buffer
+                this->init_cell_grid(this->fbs_[1]);
+                lvgl_port_unlock();
+                return;
+            }
             uint32_t buff_size = BSP_LCD_H_RES * 100;
             const lvgl_port_display_cfg_t disp_cfg = {
                 .panel_handle = lcd_panel,
@@ -97,13 +187,20 @@ namespace esphome
                     .buff_spiram = false,
                     .sw_rotate = false,
                     .swap_bytes = false,
-                    .full_refresh = true,
-                    .direct_mode = true},
+                    .full_refresh = APP_LCD_LVGL_FULL_REFRESH,
+                    .direct_mode = APP_LCD_LVGL_DIRECT_MODE},
             };
+            // Direct mode without full refresh: LVGL renders only invalidated areas into
+            // the back framebuffer and the port copies them to the other buffer after
+            // the vsync swap, so tearing is still avoided.
             const lvgl_port_display_rgb_cfg_t rgb_cfg = {
-                .flags = {.bb_mode = true, .avoid_tearing = true}};
-            lv_display_t *lvgl_disp = lvgl_port_add_disp_rgb(&disp_cfg, &rgb_cfg);
-            // Optionally store lvgl_disp in CRTTerminalRenderer if needed
+                .flags = {.bb_mode = true, .avoid_tearing = APP_LCD_LVGL_AVOID_TEAR}};
+            this->lvgl_disp_ = lvgl_port_add_disp_rgb(&disp_cfg, &rgb_cfg);
+            if (this->lvgl_disp_ == nullptr)
+            {
+                ESP_LOGE(TAG, "LVGL display registration failed");
+                return;
+            }
 
             // Initialize label style after LVGL is ready
             lv_style_init(&this->label_style);
@@ -116,11 +213,657 @@ namespace esphome
             lv_obj_t *scr = lv_scr_act();
             lv_obj_set_style_bg_color(scr, lv_color_black(), 0);
             lv_obj_set_style_bg_opa(scr, LV_OPA_COVER, 0);
+            lv_display_add_event_cb(this->lvgl_disp_, display_event_cb, LV_EVENT_REFR_START, this);
+            lv_display_add_event_cb(this->lvgl_disp_, display_event_cb, LV_EVENT_REFR_READY, this);
+            lv_display_add_event_cb(this->lvgl_disp_, display_event_cb, LV_EVENT_FLUSH_START, this);
+            lv_display_add_event_cb(this->lvgl_disp_, display_event_cb, LV_EVENT_FLUSH_FINISH, this);
+            lvgl_port_unlock();
+        }
+
+        static void atomic_max(std::atomic<uint32_t> &target, uint32_t value)
+        {
+            uint32_t prev = target.load(std::memory_order_relaxed);
+            while (value > prev && !target.compare_exchange_weak(prev, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        // Runs in the LVGL task with the port lock held
+        void CRTTerminalRenderer::display_event_cb(lv_event_t *e)
+        {
+            CRTTerminalRenderer *self = (CRTTerminalRenderer *)lv_event_get_user_data(e);
+            Counters &c = self->counters_;
+            int64_t now = esp_timer_get_time();
+            switch (lv_event_get_code(e))
+            {
+            case LV_EVENT_REFR_START:
+                self->refr_start_us_ = now;
+                self->frame_flushed_ = false;
+                break;
+            case LV_EVENT_FLUSH_START:
+            {
+                const lv_area_t *area = (const lv_area_t *)lv_event_get_param(e);
+                self->flush_start_us_ = now;
+                self->flush_start_cycles_ = RenderTrace::now();
+                self->frame_flushed_ = true;
+                if (area != nullptr)
+                {
+                    uint32_t w = lv_area_get_width(area);
+                    uint32_t h = lv_area_get_height(area);
+                    c.areas.fetch_add(1, std::memory_order_relaxed);
+                    c.rows.fetch_add(h, std::memory_order_relaxed);
+                    c.bytes.fetch_add(w * h * sizeof(uint16_t), std::memory_order_relaxed);
+                }
+                break;
+            }
+            case LV_EVENT_FLUSH_FINISH:
+                c.flush_us.fetch_add((uint32_t)(now - self->flush_start_us_), std::memory_order_relaxed);
+                if (self->trace_.enabled())
+                    self->trace_.record_since(TraceStage::FLUSH, self->flush_start_cycles_);
+                break;
+            case LV_EVENT_REFR_READY:
+                if (self->frame_flushed_)
+                {
+                    c.frames.fetch_add(1, std::memory_order_relaxed);
+                    atomic_max(c.max_frame_us, (uint32_t)(now - self->refr_start_us_));
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        IRAM_ATTR bool CRTTerminalRenderer::on_vsync(esp_lcd_panel_handle_t panel,
+                                                     const esp_lcd_rgb_panel_event_data_t *edata, void *user_ctx)
+        {
+            BaseType_t woken = pdFALSE;
+            xSemaphoreGiveFromISR(((CRTTerminalRenderer *)user_ctx)->vsync_, &woken);
+            return woken == pdTRUE;
+        }
+
+        FlushStats CRTTerminalRenderer::take_flush_stats()
+        {
+            // Unsigned deltas stay correct across 32-bit wraparound between calls
+            FlushStats now;
+            now.frames = this->counters_.frames.load(std::memory_order_relaxed);
+            now.areas = this->counters_.areas.load(std::memory_order_relaxed);
+            now.rows = this->counters_.rows.load(std::memory_order_relaxed);
+            now.text_lines = this->counters_.text_lines.load(std::memory_order_relaxed);
+            now.bytes = this->counters_.bytes.load(std::memory_order_relaxed);
+            now.flush_us = this->counters_.flush_us.load(std::memory_order_relaxed);
+            now.effects_us = this->counters_.effects_us.load(std::memory_order_relaxed);
+            now.cursor_blinks = this->counters_.cursor_blinks.load(std::memory_order_relaxed);
+            now.cursor_cells = this->counters_.cursor_cells.load(std::memory_order_relaxed);
+            now.scrolls = this->counters_.scrolls.load(std::memory_order_relaxed);
+            now.scrolled_lines = this->counters_.scrolled_lines.load(std::memory_order_relaxed);
+            FlushStats delta;
+            delta.frames = now.frames - this->flush_taken_.frames;
+            delta.areas = now.areas - this->flush_taken_.areas;
+            delta.rows = now.rows - this->flush_taken_.rows;
+            delta.text_lines = now.text_lines - this->flush_taken_.text_lines;
+            delta.bytes = (uint32_t)(now.bytes - this->flush_taken_.bytes);
+            delta.flush_us = now.flush_us - this->flush_taken_.flush_us;
+            delta.effects_us = now.effects_us - this->flush_taken_.effects_us;
+            delta.cursor_blinks = now.cursor_blinks - this->flush_taken_.cursor_blinks;
+            delta.cursor_cells = now.cursor_cells - this->flush_taken_.cursor_cells;
+            delta.scrolls = now.scrolls - this->flush_taken_.scrolls;
+            delta.scrolled_lines = now.scrolled_lines - this->flush_taken_.scrolled_lines;
+            delta.max_frame_us = this->counters_.max_frame_us.exchange(0, std::memory_order_relaxed);
+            this->flush_taken_ = now;
+            return delta;
+        }
+
+        RenderTaskStats CRTTerminalRenderer::take_task_stats()
+        {
+            RenderTaskStats now;
+            now.snapshots = this->counters_.snapshots.load(std::memory_order_relaxed);
+            now.dropped = this->counters_.dropped.load(std::memory_order_relaxed);
+            now.lock_wait_us = this->counters_.lock_wait_us.load(std::memory_order_relaxed);
+            RenderTaskStats delta;
+            delta.snapshots = now.snapshots - this->task_taken_.snapshots;
+            delta.dropped = now.dropped - this->task_taken_.dropped;
+            delta.lock_wait_us = now.lock_wait_us - this->task_taken_.lock_wait_us;
+            delta.max_lock_wait_us = this->counters_.max_lock_wait_us.exchange(0, std::memory_order_relaxed);
+            delta.queue_high_water = this->counters_.queue_high_water.load(std::memory_order_relaxed);
+            this->task_taken_ = now;
+            return delta;
+        }
+
+        bool CRTTerminalRenderer::start_render_task(int core)
+        {
+            BaseType_t affinity = core < 0 ? tskNO_AFFINITY : core;
+            if (xTaskCreatePinnedToCore(render_task, "robco_render", APP_RENDER_TASK_STACK, this,
+                                        APP_RENDER_TASK_PRIORITY, &this->render_task_, affinity) != pdPASS)
+            {
+                ESP_LOGE(TAG, "Failed to start render task");
+                return false;
+            }
+            return true;
+        }
+
+        bool CRTTerminalRenderer::submit(const ScreenSnapshot &snapshot)
+        {
+            if (!this->snapshots_.push(snapshot))
+            {
+                this->counters_.dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            atomic_max(this->counters_.queue_high_water, this->snapshots_.size());
+            xTaskNotifyGive(this->render_task_);
+            return true;
+        }
+
+        void CRTTerminalRenderer::render_task(void *arg)
+        {
+            ((CRTTerminalRenderer *)arg)->render_task_loop();
+        }
+
+        // The only place that draws after init(): applies queued snapshots in order
+        // and parses terminal input, so the ESPHome loop never touches the LVGL mutex.
+        void CRTTerminalRenderer::render_task_loop()
+        {
+            while (true)
+            {
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                if (!this->terminal_active_.load(std::memory_order_acquire))
+                {
+                    // Left over from a closed terminal
+                    size_t len;
+                    this->terminal_input_.read_span(len);
+                    while (len > 0)
+                    {
+                        this->terminal_input_.consume(len);
+                        this->terminal_input_.read_span(len);
+                    }
+                }
+                // The lock is dropped between terminal batches so LVGL keeps refreshing
+                while (this->snapshots_.size() != 0 || this->terminal_pending())
+                    this->render_pass();
+            }
+        }
+
+        bool CRTTerminalRenderer::terminal_pending() const
+        {
+            return this->terminal_reset_.load(std::memory_order_acquire) ||
+                   (this->terminal_active_.load(std::memory_order_acquire) && this->terminal_input_.size() != 0);
+        }
+
+        void CRTTerminalRenderer::render_pass()
+        {
+            const bool tracing = this->trace_.enabled();
+            int64_t wait_start = esp_timer_get_time();
+            uint32_t wait_cycles = tracing ? RenderTrace::now() : 0;
+            lvgl_port_lock(0);
+            uint32_t waited = (uint32_t)(esp_timer_get_time() - wait_start);
+            this->counters_.lock_wait_us.fetch_add(waited, std::memory_order_relaxed);
+            atomic_max(this->counters_.max_lock_wait_us, waited);
+            uint32_t draw_cycles = 0;
+            if (tracing)
+            {
+                draw_cycles = RenderTrace::now();
+                this->trace_.record(TraceStage::LOCK_WAIT, draw_cycles - wait_cycles);
+            }
+            int64_t input_us = 0;
+            while (this->snapshots_.pop(this->current_snapshot_))
+            {
+                const ScreenSnapshot &snap = this->current_snapshot_;
+                if (snap.input_us != 0 && input_us == 0)
+                    input_us = snap.input_us;
+                uint32_t lines = snap.dirty;
+                if (snap.scroll_delta != 0)
+                {
+                    this->scroll_lines(snap.scroll_top, snap.scroll_rows, snap.scroll_delta);
+                    // Moved lines are rewritten too; in the cell grid that finds nothing to redraw
+                    lines |= ((1u << snap.scroll_rows) - 1) << snap.scroll_top;
+                }
+                for (size_t i = 0; i < ScreenSnapshot::MAX_LINES; ++i)
+                {
+                    if (lines & (1u << i))
+                        this->render_line(snap.text[i], snap.len[i], i);
+                }
+                this->counters_.snapshots.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (this->terminal_active_.load(std::memory_order_acquire) ||
+                this->terminal_reset_.load(std::memory_order_acquire))
+            {
+                this->parse_terminal();
+                this->move_cursor(this->vt_.cursor_row(), this->vt_.cursor_col());
+                this->counters_.terminal_cells.fetch_add(this->grid_.dirty_count(), std::memory_order_relaxed);
+            }
+            else
+            {
+                this->move_cursor(this->current_snapshot_.cursor_row, this->current_snapshot_.cursor_col);
+            }
+            this->present();
+            if (tracing)
+            {
+                this->trace_.record_since(TraceStage::DRAW, draw_cycles);
+                // Timed with esp_timer: the key was handled on the loop task, possibly on the other core
+                if (input_us != 0)
+                {
+                    int64_t latency_us = std::min<int64_t>(esp_timer_get_time() - input_us,
+                                                           UINT32_MAX / TraceHistogram::CPU_MHZ);
+                    this->trace_.record(TraceStage::KEY_TO_DRAW, (uint32_t)latency_us * TraceHistogram::CPU_MHZ);
+                }
+            }
             lvgl_port_unlock();
         }
 
+        // Called with the LVGL lock held. The bytes are parsed where the producer
+        // wrote them; a batch ends at TERMINAL_BATCH bytes or the end of the input.
+        void CRTTerminalRenderer::parse_terminal()
+        {
+            if (this->terminal_reset_.exchange(false, std::memory_order_acq_rel))
+            {
+                this->vt_.reset();
+                this->pending_scroll_delta_ = 0;
+            }
+            int64_t start = esp_timer_get_time();
+            size_t parsed = 0;
+            while (parsed < TERMINAL_BATCH)
+            {
+                size_t len;
+                const uint8_t *data = this->terminal_input_.read_span(len);
+                if (len == 0)
+                    break;
+                len = std::min(len, TERMINAL_BATCH - parsed);
+                this->vt_.feed(data, len);
+                this->terminal_input_.consume(len);
+                parsed += len;
+            }
+            this->flush_terminal_scroll();
+            this->counters_.terminal_bytes.fetch_add(parsed, std::memory_order_relaxed);
+            this->counters_.terminal_parse_us.fetch_add((uint32_t)(esp_timer_get_time() - start),
+                                                        std::memory_order_relaxed);
+            this->counters_.terminal_unsupported.store(this->vt_.unsupported(), std::memory_order_relaxed);
+        }
+
+        bool CRTTerminalRenderer::begin_terminal()
+        {
+            if (this->render_mode_ != RenderMode::CELL_GRID || this->render_task_ == nullptr)
+                return false;
+            this->terminal_reset_.store(true, std::memory_order_release);
+            this->terminal_active_.store(true, std::memory_order_release);
+            xTaskNotifyGive(this->render_task_);
+            return true;
+        }
+
+        void CRTTerminalRenderer::end_terminal()
+        {
+            this->terminal_active_.store(false, std::memory_order_release);
+            if (this->render_task_ != nullptr)
+                xTaskNotifyGive(this->render_task_);
+        }
+
+        size_t CRTTerminalRenderer::write_terminal(const uint8_t *data, size_t len)
+        {
+            size_t taken = this->terminal_active() ? this->terminal_input_.write(data, len) : 0;
+            if (taken < len)
+                this->counters_.terminal_dropped.fetch_add(len - taken, std::memory_order_relaxed);
+            if (taken > 0)
+                xTaskNotifyGive(this->render_task_);
+            return taken;
+        }
+
+        TerminalStats CRTTerminalRenderer::take_terminal_stats()
+        {
+            TerminalStats now;
+            now.bytes = this->counters_.terminal_bytes.load(std::memory_order_relaxed);
+            now.dropped = this->counters_.terminal_dropped.load(std::memory_order_relaxed);
+            now.parse_us = this->counters_.terminal_parse_us.load(std::memory_order_relaxed);
+            now.cells = this->counters_.terminal_cells.load(std::memory_order_relaxed);
+            now.unsupported = this->counters_.terminal_unsupported.load(std::memory_order_relaxed);
+            TerminalStats delta;
+            delta.bytes = now.bytes - this->terminal_taken_.bytes;
+            delta.dropped = now.dropped - this->terminal_taken_.dropped;
+            delta.parse_us = now.parse_us - this->terminal_taken_.parse_us;
+            delta.cells = now.cells - this->terminal_taken_.cells;
+            delta.unsupported = now.unsupported - this->terminal_taken_.unsupported;
+            this->terminal_taken_ = now;
+            return delta;
+        }
+
+        // Draws into the given panel framebuffer, or into a PSRAM buffer of its own
+        // for the scanout to read
+        void CRTTerminalRenderer::init_cell_grid(uint16_t *framebuffer)
+        {
+            if (!this->blitter_.init(&fixedsys))
+            {
+                ESP_LOGE(TAG, "Font is not usable for cell rendering, falling back to labels");
+                this->render_mode_ = RenderMode::LABELS;
+                return;
+            }
+            size_t buf_size = BSP_LCD_H_RES * BSP_LCD_V_RES * sizeof(uint16_t);
+            this->draw_buf_ = framebuffer != nullptr ? framebuffer
+                                                       : (uint16_t *)heap_caps_malloc(buf_size, MALLOC_CAP_SPIRAM);
+            if (this->draw_buf_ == nullptr)
+            {
+                ESP_LOGE(TAG, "Canvas buffer allocation failed, falling back to labels");
+                this->render_mode_ = RenderMode::LABELS;
+                return;
+            }
+            memset(this->draw_buf_, 0, buf_size);
+            this->fg_color_ = lv_color_to_u16(lv_color_make(0, 255, 0));
+            this->bg_color_ = lv_color_to_u16(lv_color_black());
+            size_t cols = (BSP_LCD_H_RES - APP_GRID_LEFT_MARGIN) / GlyphBlitter::CELL_W;
+            size_t rows = (BSP_LCD_V_RES - APP_GRID_TOP_MARGIN) / GlyphBlitter::CELL_H;
+            this->grid_.resize(rows, cols);
+            this->vt_.attach(&this->grid_, [this](size_t top, size_t rows, int delta)
+                             { this->terminal_scroll(top, rows, delta); });
+            ESP_LOGI(TAG, "Cell grid renderer: %u x %u cells", (unsigned)cols, (unsigned)rows);
+            this->effects_.configure(this->effects_config_, GlyphBlitter::CELL_W);
+            if (this->effects_.enabled() && !this->effects_.self_test())
+            {
+                ESP_LOGE(TAG, "CRT effects fast path disagrees with the reference, effects disabled");
+                this->effects_.configure(CrtEffectConfig(), GlyphBlitter::CELL_W);
+            }
+            if (this->cursor_style_ != CursorStyle::NONE && this->cursor_blink_ms_ > 0)
+                this->cursor_timer_ = lv_timer_create(cursor_timer_cb, this->cursor_blink_ms_, this);
+            if (this->glyph_benchmark_)
+                this->run_glyph_benchmark();
+            if (this->atlas_mode_ != GlyphAtlasMode::NONE)
+            {
+                if (this->atlas_.build(this->blitter_, this->atlas_mode_, this->fg_color_, this->bg_color_))
+                    ESP_LOGI(TAG, "Glyph atlas: %u bytes of internal RAM%s", (unsigned)this->atlas_.size_bytes(),
+                             this->atlas_.mode() == GlyphAtlasMode::RGB565 ? ", RGB565 expanded" : "");
+                else
+                    ESP_LOGW(TAG, "Glyph atlas allocation failed, drawing from the flash font");
+            }
+        }
+
+        void CRTTerminalRenderer::draw_cell(size_t row, size_t col, const TerminalCell &cell)
+        {
+            int x = APP_GRID_LEFT_MARGIN + col * GlyphBlitter::CELL_W;
+            int y = APP_GRID_TOP_MARGIN + row * GlyphBlitter::CELL_H;
+            uint16_t *dst = this->draw_buf_ + y * BSP_LCD_H_RES + x;
+            uint8_t attr = cell.attr;
+            if (this->cursor_on_ && (int)row == this->cursor_row_ && (int)col == this->cursor_col_)
+                attr ^= this->cursor_style_ == CursorStyle::BLOCK ? CELL_ATTR_INVERSE
+                        : this->cursor_style_ == CursorStyle::UNDERLINE ? CELL_ATTR_UNDERLINE
+                                                                         : CELL_ATTR_NONE;
+            if (this->atlas_.ready())
+                this->atlas_.blit(dst, BSP_LCD_H_RES, cell.ch, attr, this->fg_color_, this->bg_color_);
+            else
+                this->blitter_.blit(dst, BSP_LCD_H_RES, cell.ch, attr, this->fg_color_, this->bg_color_);
+            if (this->effects_.enabled())
+            {
+                int64_t start = esp_timer_get_time();
+                this->effects_.apply(this->draw_buf_, BSP_LCD_H_RES, x, y, GlyphBlitter::CELL_W, GlyphBlitter::CELL_H);
+                this->counters_.effects_us.fetch_add((uint32_t)(esp_timer_get_time() - start), std::memory_order_relaxed);
+            }
+            this->mark_band(row, x, x + GlyphBlitter::CELL_W);
+        }
+
+        void CRTTerminalRenderer::mark_band(size_t row, int x0, int x1)
+        {
+            if (row >= MAX_BANDS)
+                return;
+            if (this->band_x1_[row] == 0)
+            {
+                this->band_x0_[row] = x0;
+                this->band_x1_[row] = x1;
+                return;
+            }
+            this->band_x0_[row] = std::min<int>(this->band_x0_[row], x0);
+            this->band_x1_[row] = std::max<int>(this->band_x1_[row], x1);
+        }
+
+        // Called with the LVGL lock held. A moved cursor shows solid and restarts its
+        // blink phase, so it does not vanish while the user is typing.
+        void CRTTerminalRenderer::move_cursor(int row, int col)
+        {
+            if (this->render_mode_ != RenderMode::CELL_GRID || this->cursor_style_ == CursorStyle::NONE)
+                return;
+            if (row >= (int)this->grid_.rows() || col >= (int)this->grid_.cols())
+                row = -1;
+            if (row == this->cursor_row_ && (row < 0 || col == this->cursor_col_))
+                return;
+            if (this->cursor_row_ >= 0)
+                this->grid_.mark_dirty(this->cursor_row_, this->cursor_col_);
+            this->cursor_row_ = row;
+            this->cursor_col_ = col;
+            this->cursor_on_ = true;
+            if (row >= 0)
+                this->grid_.mark_dirty(row, col);
+            if (this->cursor_timer_ != nullptr)
+                lv_timer_reset(this->cursor_timer_);
+        }
+
+        // Called with the LVGL lock held. Moves the cell contents and the matching
+        // framebuffer rows, so scrolled text is copied rather than rasterised again.
+        void CRTTerminalRenderer::scroll_lines(size_t top, size_t rows, int delta)
+        {
+            if (this->render_mode_ != RenderMode::CELL_GRID || top >= this->grid_.rows())
+                return;
+            rows = std::min(rows, this->grid_.rows() - top);
+            size_t distance = delta < 0 ? -delta : delta;
+            if (distance >= rows)
+                return;
+            this->grid_.scroll_rows(top, rows, delta);
+            this->scroll_pixels(top, rows, delta);
+        }
+
+        void CRTTerminalRenderer::scroll_pixels(size_t top, size_t rows, int delta)
+        {
+            size_t distance = delta < 0 ? -delta : delta;
+            size_t kept = rows - distance;
+            size_t from = delta > 0 ? top + distance : top;
+            size_t to = delta > 0 ? top : top + distance;
+            size_t row_px = GlyphBlitter::CELL_H * BSP_LCD_H_RES;
+            uint16_t *base = this->draw_buf_ + APP_GRID_TOP_MARGIN * BSP_LCD_H_RES;
+            memmove(base + to * row_px, base + from * row_px, kept * row_px * sizeof(uint16_t));
+            // The drawn cursor moved with the pixels, and the cell it sat on was overwritten
+            if (this->cursor_on_ && this->cursor_row_ >= (int)top && this->cursor_row_ < (int)(top + rows))
+            {
+                int moved_row = this->cursor_row_ - delta;
+                if (moved_row >= (int)to && moved_row < (int)(to + kept))
+                    this->grid_.mark_dirty(moved_row, this->cursor_col_);
+                this->grid_.mark_dirty(this->cursor_row_, this->cursor_col_);
+            }
+            this->counters_.scrolls.fetch_add(1, std::memory_order_relaxed);
+            this->counters_.scrolled_lines.fetch_add(kept, std::memory_order_relaxed);
+            for (size_t r = to; r < to + kept; ++r)
+                this->mark_band(r, 0, BSP_LCD_H_RES);
+        }
+
+        // A stream scrolling a line at a time would otherwise move the whole region's
+        // pixels once per line. Consecutive scrolls of one region in one direction
+        // add up and are copied once when the batch has been parsed.
+        void CRTTerminalRenderer::terminal_scroll(size_t top, size_t rows, int delta)
+        {
+            if (this->pending_scroll_delta_ != 0 &&
+                (top != this->pending_scroll_top_ || rows != this->pending_scroll_rows_ ||
+                 (delta > 0) != (this->pending_scroll_delta_ > 0)))
+                this->flush_terminal_scroll();
+            this->grid_.scroll_rows(top, rows, delta);
+            this->pending_scroll_top_ = top;
+            this->pending_scroll_rows_ = rows;
+            this->pending_scroll_delta_ += delta;
+        }
+
+        // Rows whose pixels the copy could not supply are redrawn in full
+        void CRTTerminalRenderer::flush_terminal_scroll()
+        {
+            int delta = this->pending_scroll_delta_;
+            if (delta == 0)
+                return;
+            this->pending_scroll_delta_ = 0;
+            size_t top = this->pending_scroll_top_;
+            size_t rows = this->pending_scroll_rows_;
+            size_t distance = delta < 0 ? -delta : delta;
+            size_t first = top;
+            if (distance < rows)
+            {
+                this->scroll_pixels(top, rows, delta);
+                first = delta > 0 ? top + rows - distance : top;
+                rows = distance;
+            }
+            for (size_t r = first; r < first + rows; ++r)
+                for (size_t c = 0; c < this->grid_.cols(); ++c)
+                    this->grid_.mark_dirty(r, c);
+        }
+
+        // Runs in the LVGL task with the port lock held; repaints only the cursor cell
+        void CRTTerminalRenderer::cursor_timer_cb(lv_timer_t *timer)
+        {
+            CRTTerminalRenderer *self = (CRTTerminalRenderer *)lv_timer_get_user_data(timer);
+            if (self->cursor_row_ < 0)
+                return;
+            self->cursor_on_ = !self->cursor_on_;
+            self->grid_.mark_dirty(self->cursor_row_, self->cursor_col_);
+            self->counters_.cursor_blinks.fetch_add(1, std::memory_order_relaxed);
+            self->counters_.cursor_cells.fetch_add(self->grid_.dirty_count(), std::memory_order_relaxed);
+            self->present();
+        }
+
+        // Draws a full screen of text into the (still blank) draw buffer once per
+        // atlas mode and logs the glyph throughput of each
+        void CRTTerminalRenderer::run_glyph_benchmark()
+        {
+            static const GlyphAtlasMode modes[] = {GlyphAtlasMode::NONE, GlyphAtlasMode::MASK, GlyphAtlasMode::RGB565};
+            static const char *const names[] = {"flash font", "mask atlas", "RGB565 atlas"};
+            const size_t rows = this->grid_.rows();
+            const size_t cols = this->grid_.cols();
+            const int passes = 4;
+            for (size_t m = 0; m < 3; ++m)
+            {
+                GlyphAtlas atlas;
+                if (modes[m] != GlyphAtlasMode::NONE &&
+                    (!atlas.build(this->blitter_, modes[m], this->fg_color_, this->bg_color_) || atlas.mode() != modes[m]))
+                {
+                    ESP_LOGW(TAG, "Glyph benchmark: %s unavailable", names[m]);
+                    continue;
+                }
+                uint32_t glyphs = 0;
+                int64_t start = esp_timer_get_time();
+                for (int pass = 0; pass < passes; ++pass)
+                {
+                    for (size_t r = 0; r < rows; ++r)
+                    {
+                        for (size_t c = 0; c < cols; ++c, ++glyphs)
+                        {
+                            char ch = (char)(GlyphBlitter::FIRST_CHAR + (r * cols + c + pass) % GlyphBlitter::NUM_CHARS);
+                            uint16_t *dst = this->draw_buf_ + (APP_GRID_TOP_MARGIN + r * GlyphBlitter::CELL_H) * BSP_LCD_H_RES +
+                                            APP_GRID_LEFT_MARGIN + c * GlyphBlitter::CELL_W;
+                            if (atlas.ready())
+                                atlas.blit(dst, BSP_LCD_H_RES, ch, CELL_ATTR_NONE, this->fg_color_, this->bg_color_);
+                            else
+                                this->blitter_.blit(dst, BSP_LCD_H_RES, ch, CELL_ATTR_NONE, this->fg_color_, this->bg_color_);
+                        }
+                    }
+                }
+                int64_t elapsed = esp_timer_get_time() - start;
+                ESP_LOGI(TAG, "Glyph benchmark: %s %u glyphs in %lld us, %.0f glyphs/s", names[m], (unsigned)glyphs,
+                         (long long)elapsed, elapsed > 0 ? glyphs * 1e6f / elapsed : 0.0f);
+            }
+            if (this->effects_.enabled())
+            {
+                // Post-process the last pass cell by cell, the way present() does, with both paths
+                for (int path = 0; path < 2; ++path)
+                {
+                    int64_t start = esp_timer_get_time();
+                    for (size_t r = 0; r < rows; ++r)
+                    {
+                        for (size_t c = 0; c < cols; ++c)
+                        {
+                            int x = APP_GRID_LEFT_MARGIN + c * GlyphBlitter::CELL_W;
+                            int y = APP_GRID_TOP_MARGIN + r * GlyphBlitter::CELL_H;
+                            if (path == 0)
+                                this->effects_.apply_reference(this->draw_buf_, BSP_LCD_H_RES, x, y, GlyphBlitter::CELL_W,
+                                                               GlyphBlitter::CELL_H);
+                            else
+                                this->effects_.apply(this->draw_buf_, BSP_LCD_H_RES, x, y, GlyphBlitter::CELL_W,
+                                                     GlyphBlitter::CELL_H);
+                        }
+                    }
+                    int64_t elapsed = esp_timer_get_time() - start;
+                    ESP_LOGI(TAG, "CRT effects benchmark: %s path, %u cells in %lld us", path == 0 ? "reference" : "fast",
+                             (unsigned)(rows * cols), (long long)elapsed);
+                }
+            }
+            memset(this->draw_buf_, 0, BSP_LCD_H_RES * BSP_LCD_V_RES * sizeof(uint16_t));
+        }
+
+        void CRTTerminalRenderer::present()
+        {
+            if (this->render_mode_ != RenderMode::CELL_GRID || (!this->grid_.has_dirty() && !this->bands_dirty()))
+                return;
+            const bool tracing = this->trace_.enabled();
+            uint32_t start_cycles = tracing ? RenderTrace::now() : 0;
+            int64_t start = esp_timer_get_time();
+            this->grid_.consume_dirty([this](size_t row, size_t col, const TerminalCell &cell)
+                                      { this->draw_cell(row, col, cell); });
+            if (this->fbs_[1] != nullptr)
+                this->swap_buffers();
+            // No LVGL flush events here: each drawn cell row counts as one flushed area
+            uint32_t areas = 0, bytes = 0;
+            for (size_t r = 0; r < MAX_BANDS; ++r)
+            {
+                if (this->band_x1_[r] == 0)
+                    continue;
+                areas++;
+                bytes += (this->band_x1_[r] - this->band_x0_[r]) * GlyphBlitter::CELL_H * sizeof(uint16_t);
+                this->band_x0_[r] = this->band_x1_[r] = 0;
+            }
+            uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+            Counters &c = this->counters_;
+            c.frames.fetch_add(1, std::memory_order_relaxed);
+            c.areas.fetch_add(areas, std::memory_order_relaxed);
+            c.rows.fetch_add(areas * GlyphBlitter::CELL_H, std::memory_order_relaxed);
+            c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+            c.flush_us.fetch_add(elapsed, std::memory_order_relaxed);
+            atomic_max(c.max_frame_us, elapsed);
+            if (tracing)
+                this->trace_.record_since(TraceStage::FLUSH, start_cycles);
+        }
+
+        bool CRTTerminalRenderer::bands_dirty() const
+        {
+            for (size_t r = 0; r < MAX_BANDS; ++r)
+                if (this->band_x1_[r] != 0)
+                    return true;
+            return false;
+        }
+
+        // The finished back buffer is shown from the next frame on. Once the panel scans
+        // it, the old front buffer becomes the back buffer and gets the bands drawn this
+        // time copied in, so both hold the same picture before anything else is drawn.
+        void CRTTerminalRenderer::swap_buffers()
+        {
+            uint16_t *shown = this->draw_buf_;
+            uint16_t *next = shown == this->fbs_[0] ? this->fbs_[1] : this->fbs_[0];
+            xSemaphoreTake(this->vsync_, 0);
+            // A pointer into one of the panel's framebuffers switches to it without a copy
+            esp_lcd_panel_draw_bitmap(this->panel_, 0, 0, BSP_LCD_H_RES, BSP_LCD_V_RES, shown);
+            if (xSemaphoreTake(this->vsync_, pdMS_TO_TICKS(100)) != pdTRUE)
+                ESP_LOGW(TAG, "No vsync after a buffer swap");
+            for (size_t r = 0; r < MAX_BANDS; ++r)
+            {
+                if (this->band_x1_[r] == 0)
+                    continue;
+                size_t width = (this->band_x1_[r] - this->band_x0_[r]) * sizeof(uint16_t);
+                size_t offset = (APP_GRID_TOP_MARGIN + r * GlyphBlitter::CELL_H) * BSP_LCD_H_RES + this->band_x0_[r];
+                for (size_t y = 0; y < GlyphBlitter::CELL_H; ++y, offset += BSP_LCD_H_RES)
+                    memcpy(next + offset, shown + offset, width);
+            }
+            this->draw_buf_ = next;
+        }
+
         void CRTTerminalRenderer::render_line(const std::string &line, size_t index, bool is_menu)
         {
+            this->render_line(line.c_str(), line.size(), index);
+        }
+
+        void CRTTerminalRenderer::render_line(const char *text, size_t len, size_t index)
+        {
+            this->counters_.text_lines.fetch_add(1, std::memory_order_relaxed);
+            if (this->render_mode_ == RenderMode::CELL_GRID)
+            {
+                this->grid_.write_line(index, text, len);
+                return;
+            }
+            if (this->lvgl_disp_ == nullptr)
+                return;
             lv_obj_t *scr = lv_scr_act();
             // Set screen background only once
             if (!this->screen_bg_set_)
@@ -141,7 +884,7 @@ namespace esphome
             // If label exists, update text; else create new label
             if (this->line_labels[index])
             {
-                lv_label_set_text(this->line_labels[index], line.c_str());
+                lv_label_set_text(this->line_labels[index], text);
                 lv_obj_set_pos(this->line_labels[index], left_margin, y);
                 lv_obj_clear_flag(this->line_labels[index], LV_OBJ_FLAG_HIDDEN);
             }
@@ -149,7 +892,7 @@ namespace esphome
             {
                 lv_obj_t *label = lv_label_create(scr);
                 lv_obj_add_style(label, &this->label_style, 0);
-                lv_label_set_text(label, line.c_str());
+                lv_label_set_text(label, text);
                 lv_obj_set_pos(label, left_margin, y);
                 this->line_labels[index] = label;
             }
@@ -1,37 +1,268 @@
 #ifndef CRT_TERMINAL_RENDERER_H
 #define CRT_TERMINAL_RENDERER_H
 
+#include <atomic>
 #include <string>
 #include <vector>
 extern "C"
 {
 #include "lvgl.h"
 #include "bsp.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 }
+#include "../pico_io_extension/spsc_ring.h"
+#include "bounce_scanout.h"
+#include "crt_effects.h"
+#include "glyph_atlas.h"
+#include "glyph_blitter.h"
+#include "render_trace.h"
+#include "terminal_grid.h"
+#include "vt_parser.h"
 
 
 namespace esphome
 {
     namespace robco_display
     {
+        enum class RenderMode
+        {
+            LABELS,    // one lv_label per line, laid out by LVGL
+            CELL_GRID, // fixed character cells blitted into the framebuffer
+        };
+
+        enum class CursorStyle
+        {
+            NONE,
+            BLOCK,     // inverse cell
+            UNDERLINE,
+        };
+
+        // Display flush counters, accumulated by LVGL display events for the labels
+        // and by present() for the cell grid
+        struct FlushStats
+        {
+            uint32_t frames = 0;       // refresh cycles that flushed at least one area
+            uint32_t areas = 0;        // areas handed to the flush callback, or cell rows drawn
+            uint32_t rows = 0;         // pixel rows covered by flushed areas
+            uint32_t text_lines = 0;   // text lines rewritten by render_line
+            uint64_t bytes = 0;        // framebuffer bytes covered by flushed areas
+            uint32_t flush_us = 0;     // time inside the flush callback, or in present() drawing and swapping
+            uint32_t max_frame_us = 0; // slowest refresh cycle, render + flush
+            uint32_t effects_us = 0;   // time spent post-processing drawn cells
+            uint32_t cursor_blinks = 0;
+            uint32_t cursor_cells = 0; // cells repainted by cursor blinks; one per blink
+            uint32_t scrolls = 0;
+            uint32_t scrolled_lines = 0; // text lines moved in the framebuffer instead of redrawn
+        };
+
+        // Render task lock contention and queue counters
+        struct RenderTaskStats
+        {
+            uint32_t snapshots = 0;     // snapshots applied
+            uint32_t dropped = 0;       // snapshots rejected because the queue was full
+            uint32_t lock_wait_us = 0;  // total time spent waiting for the LVGL lock
+            uint32_t max_lock_wait_us = 0;
+            uint32_t queue_high_water = 0;
+        };
+
+        // Terminal mode byte stream counters
+        struct TerminalStats
+        {
+            uint32_t bytes = 0;    // bytes parsed
+            uint32_t dropped = 0;  // bytes refused because the input ring was full or the terminal was closed
+            uint32_t parse_us = 0; // time spent parsing, including cell updates but not drawing
+            uint32_t cells = 0;    // cells drawn while the terminal was open
+            uint32_t unsupported = 0;
+        };
+
+        // Immutable copy of the changed screen lines, handed from the ESPHome loop
+        // to the render task. Only lines with their bit set in dirty are valid,
+        // plus the scroll region when scroll_delta is non-zero.
+        struct ScreenSnapshot
+        {
+            static constexpr size_t MAX_LINES = BSP_LCD_V_RES / GlyphBlitter::CELL_H;
+            static constexpr size_t MAX_LINE_LENGTH = 80;
+            uint32_t dirty = 0;
+            int8_t cursor_row = -1; // -1 hides the cursor
+            uint8_t cursor_col = 0;
+            // Lines scroll_top..scroll_top+scroll_rows-1 move up by scroll_delta lines
+            // (down if negative) before the dirty lines are applied
+            uint8_t scroll_top = 0;
+            uint8_t scroll_rows = 0;
+            int8_t scroll_delta = 0;
+            // esp_timer time of the earliest key press this snapshot shows the result of, 0 if none
+            int64_t input_us = 0;
+            uint8_t len[MAX_LINES];
+            char text[MAX_LINES][MAX_LINE_LENGTH + 1];
+        };
 
         class CRTTerminalRenderer
         {
         public:
             CRTTerminalRenderer();
             void init();
+            void set_render_mode(RenderMode mode) { render_mode_ = mode; }
+            void set_glyph_atlas_mode(GlyphAtlasMode mode) { atlas_mode_ = mode; }
+            // Log glyphs/second with and without the atlas during init()
+            void set_glyph_benchmark(bool enabled) { glyph_benchmark_ = enabled; }
+            // Scanline and bloom post-processing of drawn cells (cell grid only)
+            void set_crt_effects(const CrtEffectConfig &config) { effects_config_ = config; }
+            // Scan the cell grid out through the bounce buffer ISR with per-line effects,
+            // bypassing LVGL's display and the driver framebuffers (cell grid only)
+            void set_scanout_effects(const ScanoutEffectConfig &config)
+            {
+                scanout_config_ = config;
+                scanout_enabled_ = true;
+            }
+            bool scanout_active() const { return scanout_enabled_ && render_mode_ == RenderMode::CELL_GRID; }
+            ScanoutStats take_scanout_stats() { return scanout_.take_stats(); }
+            // Core for the LVGL and render tasks; -1 leaves them unpinned
+            void set_task_core(int core) { task_core_ = core; }
+            void set_cursor_style(CursorStyle style) { cursor_style_ = style; }
+            // 0 keeps the cursor steady
+            void set_cursor_blink_ms(uint32_t ms) { cursor_blink_ms_ = ms; }
+            RenderMode get_render_mode() const { return render_mode_; }
             void render_line(const std::string &line, size_t index, bool is_menu);
+            // text must be NUL-terminated at text[len]
+            void render_line(const char *text, size_t len, size_t index);
+            // Push pending cell changes to the display; call with the lock held
+            void present();
             void lock();
             void unlock();
+            // Return the counters gathered since the last call; lock-free
+            FlushStats take_flush_stats();
+            // Start the task that owns all LVGL drawing after init(); core < 0 means unpinned
+            bool start_render_task(int core);
+            // Queue a snapshot for the render task; never blocks. False if the queue is full.
+            bool submit(const ScreenSnapshot &snapshot);
+            RenderTaskStats take_task_stats();
+            // Terminal mode: the grid shows a VT100/ANSI byte stream instead of snapshots.
+            // Bytes are queued without blocking from any one producer task and parsed
+            // in place by the render task. Cell grid mode only.
+            bool begin_terminal();
+            void end_terminal();
+            bool terminal_active() const { return terminal_active_.load(std::memory_order_acquire); }
+            // Returns the number of bytes queued; the rest are dropped and counted
+            size_t write_terminal(const uint8_t *data, size_t len);
+            void set_terminal_newline_mode(bool enabled) { vt_.set_newline_mode(enabled); }
+            TerminalStats take_terminal_stats();
+            // Stage timings of the whole pipeline; the component records the input side
+            RenderTrace &get_trace() { return trace_; }
             size_t get_num_lines() const {
                 constexpr size_t display_height = BSP_LCD_V_RES;
-                constexpr size_t char_height = 24;
+                constexpr size_t char_height = GlyphBlitter::CELL_H;
                 return display_height / char_height;
             }
         private:
+            void init_cell_grid(uint16_t *framebuffer);
+            void draw_cell(size_t row, size_t col, const TerminalCell &cell);
+            // Pixel columns x0..x1-1 of a cell row were drawn since the last present()
+            void mark_band(size_t row, int x0, int x1);
+            bool bands_dirty() const;
+            void swap_buffers();
+            static bool on_vsync(esp_lcd_panel_handle_t panel, const esp_lcd_rgb_panel_event_data_t *edata,
+                                 void *user_ctx);
+            void run_glyph_benchmark();
+            void move_cursor(int row, int col);
+            // Move already drawn lines within a region, see ScreenSnapshot::scroll_delta
+            void scroll_lines(size_t top, size_t rows, int delta);
+            // Framebuffer half of scroll_lines, for cells that have already been moved
+            void scroll_pixels(size_t top, size_t rows, int delta);
+            // Parser scroll callback: cells move at once, pixels once per parsed batch
+            void terminal_scroll(size_t top, size_t rows, int delta);
+            void flush_terminal_scroll();
+            bool terminal_pending() const;
+            // One pass of the render task: queued snapshots and up to a batch of terminal input
+            void render_pass();
+            void parse_terminal();
+            static void cursor_timer_cb(lv_timer_t *timer);
+            static void display_event_cb(lv_event_t *e);
+            static void render_task(void *arg);
+            void render_task_loop();
+            // Cumulative counters written from the LVGL and render tasks; readers take deltas
+            struct Counters
+            {
+                std::atomic<uint32_t> frames{0};
+                std::atomic<uint32_t> areas{0};
+                std::atomic<uint32_t> rows{0};
+                std::atomic<uint32_t> text_lines{0};
+                std::atomic<uint32_t> bytes{0};
+                std::atomic<uint32_t> flush_us{0};
+                std::atomic<uint32_t> max_frame_us{0};
+                std::atomic<uint32_t> effects_us{0};
+                std::atomic<uint32_t> cursor_blinks{0};
+                std::atomic<uint32_t> cursor_cells{0};
+                std::atomic<uint32_t> scrolls{0};
+                std::atomic<uint32_t> scrolled_lines{0};
+                std::atomic<uint32_t> snapshots{0};
+                std::atomic<uint32_t> dropped{0};
+                std::atomic<uint32_t> lock_wait_us{0};
+                std::atomic<uint32_t> max_lock_wait_us{0};
+                std::atomic<uint32_t> queue_high_water{0};
+                std::atomic<uint32_t> terminal_bytes{0};
+                std::atomic<uint32_t> terminal_dropped{0};
+                std::atomic<uint32_t> terminal_parse_us{0};
+                std::atomic<uint32_t> terminal_cells{0};
+                std::atomic<uint32_t> terminal_unsupported{0};
+            };
+            Counters counters_;
+            FlushStats flush_taken_;
+            RenderTaskStats task_taken_;
+            TerminalStats terminal_taken_;
+            lv_display_t *lvgl_disp_ = nullptr;
+            TaskHandle_t render_task_ = nullptr;
+            int task_core_ = 1;
+            pico_io_extension::SpscRing<ScreenSnapshot, 4> snapshots_;
+            ScreenSnapshot current_snapshot_;
+            bool frame_flushed_ = false;
+            int64_t refr_start_us_ = 0;
+            int64_t flush_start_us_ = 0;
+            uint32_t flush_start_cycles_ = 0;
+            RenderTrace trace_;
+            // Terminal mode
+            static constexpr size_t TERMINAL_BATCH = 4096; // bytes parsed per LVGL lock hold
+            pico_io_extension::SpscByteRing<16384> terminal_input_;
+            VtParser vt_;
+            std::atomic<bool> terminal_active_{false};
+            std::atomic<bool> terminal_reset_{false};
+            size_t pending_scroll_top_ = 0;
+            size_t pending_scroll_rows_ = 0;
+            int pending_scroll_delta_ = 0;
             std::vector<lv_obj_t *> line_labels;
             lv_style_t label_style;
             bool screen_bg_set_ = false;
+            RenderMode render_mode_ = RenderMode::CELL_GRID;
+            // Cell grid mode
+            TerminalGrid grid_;
+            GlyphBlitter blitter_;
+            GlyphAtlas atlas_;
+            GlyphAtlasMode atlas_mode_ = GlyphAtlasMode::MASK;
+            bool glyph_benchmark_ = false;
+            CrtEffects effects_;
+            CrtEffectConfig effects_config_;
+            BounceScanout scanout_;
+            ScanoutEffectConfig scanout_config_;
+            bool scanout_enabled_ = false;
+            // Cursor overlay, drawn by draw_cell on top of the grid contents
+            CursorStyle cursor_style_ = CursorStyle::BLOCK;
+            uint32_t cursor_blink_ms_ = 500;
+            lv_timer_t *cursor_timer_ = nullptr;
+            int cursor_row_ = -1;
+            int cursor_col_ = 0;
+            bool cursor_on_ = true;
+            // Where cells are drawn: the panel's back buffer, or with the scanout our own
+            uint16_t *draw_buf_ = nullptr;
+            esp_lcd_panel_handle_t panel_ = nullptr;
+            uint16_t *fbs_[2] = {nullptr, nullptr}; // panel framebuffers; unused with the scanout
+            SemaphoreHandle_t vsync_ = nullptr;
+            // Drawn pixel columns per cell row, x1 == 0 for rows left alone
+            static constexpr size_t MAX_BANDS = ScreenSnapshot::MAX_LINES;
+            uint16_t band_x0_[MAX_BANDS] = {};
+            uint16_t band_x1_[MAX_BANDS] = {};
+            uint16_t fg_color_ = 0;
+            uint16_t bg_color_ = 0;
 
         };
     } // namespace robco_display
@@ -0,0 +1,29 @@
+#include "flash_log_partition.h"
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        bool FlashLogPartition::open(const char *label)
+        {
+            this->partition_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+            return this->partition_ != nullptr;
+        }
+
+        bool FlashLogPartition::read(size_t offset, void *dst, size_t len)
+        {
+            return esp_partition_read(this->partition_, offset, dst, len) == ESP_OK;
+        }
+
+        bool FlashLogPartition::write(size_t offset, const void *src, size_t len)
+        {
+            return esp_partition_write(this->partition_, offset, src, len) == ESP_OK;
+        }
+
+        bool FlashLogPartition::erase_sector(size_t sector)
+        {
+            size_t sector_size = this->partition_->erase_size;
+            return esp_partition_erase_range(this->partition_, sector * sector_size, sector_size) == ESP_OK;
+        }
+    } // namespace robco_display
+} // namespace esphome
@@ -0,0 +1,31 @@
+#ifndef FLASH_LOG_PARTITION_H
+#define FLASH_LOG_PARTITION_H
+
+#include "log_store.h"
+extern "C"
+{
+#include "esp_partition.h"
+}
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        // LogPartition on a data partition of the SPI flash, found by label
+        class FlashLogPartition : public LogPartition
+        {
+        public:
+            bool open(const char *label);
+            const char *label() const { return partition_ != nullptr ? partition_->label : ""; }
+            size_t size() const override { return partition_ != nullptr ? partition_->size : 0; }
+            size_t sector_size() const override { return partition_ != nullptr ? partition_->erase_size : 0; }
+            bool read(size_t offset, void *dst, size_t len) override;
+            bool write(size_t offset, const void *src, size_t len) override;
+            bool erase_sector(size_t sector) override;
+
+        private:
+            const esp_partition_t *partition_ = nullptr;
+        };
+    } // namespace robco_display
+} // namespace esphome
+#endif // FLASH_LOG_PARTITION_H
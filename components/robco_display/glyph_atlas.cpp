@@ -0,0 +1,91 @@
+#include "glyph_atlas.h"
+#include "terminal_grid.h"
+#include "esp_heap_caps.h"
+#include <cstring>
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        GlyphAtlas::~GlyphAtlas()
+        {
+            release();
+        }
+
+        void GlyphAtlas::release()
+        {
+            heap_caps_free(masks_);
+            heap_caps_free(pixels_);
+            masks_ = nullptr;
+            pixels_ = nullptr;
+            mode_ = GlyphAtlasMode::NONE;
+        }
+
+        bool GlyphAtlas::build(const GlyphBlitter &src, GlyphAtlasMode mode, uint16_t fg, uint16_t bg)
+        {
+            release();
+            if (mode == GlyphAtlasMode::NONE)
+                return false;
+            const uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+            masks_ = (uint16_t *)heap_caps_malloc(GlyphBlitter::NUM_CHARS * GlyphBlitter::CELL_H * sizeof(uint16_t), caps);
+            if (masks_ == nullptr)
+                return false;
+            for (uint32_t i = 0; i < GlyphBlitter::NUM_CHARS; ++i)
+            {
+                char ch = (char)(GlyphBlitter::FIRST_CHAR + i);
+                for (int y = 0; y < GlyphBlitter::CELL_H; ++y)
+                    masks_[i * GlyphBlitter::CELL_H + y] = src.row_mask(ch, y);
+            }
+            mode_ = GlyphAtlasMode::MASK;
+            fg_ = fg;
+            bg_ = bg;
+            if (mode == GlyphAtlasMode::RGB565)
+            {
+                pixels_ = (uint16_t *)heap_caps_malloc(GlyphBlitter::NUM_CHARS * CELL_PIXELS * sizeof(uint16_t), caps);
+                // Keep the mask atlas if the expanded one does not fit
+                if (pixels_ == nullptr)
+                    return true;
+                for (uint32_t i = 0; i < GlyphBlitter::NUM_CHARS; ++i)
+                {
+                    char ch = (char)(GlyphBlitter::FIRST_CHAR + i);
+                    src.blit(pixels_ + i * CELL_PIXELS, GlyphBlitter::CELL_W, ch, CELL_ATTR_NONE, fg, bg);
+                }
+                mode_ = GlyphAtlasMode::RGB565;
+            }
+            return true;
+        }
+
+        size_t GlyphAtlas::size_bytes() const
+        {
+            size_t size = 0;
+            if (masks_ != nullptr)
+                size += GlyphBlitter::NUM_CHARS * GlyphBlitter::CELL_H * sizeof(uint16_t);
+            if (pixels_ != nullptr)
+                size += GlyphBlitter::NUM_CHARS * CELL_PIXELS * sizeof(uint16_t);
+            return size;
+        }
+
+        void GlyphAtlas::blit(uint16_t *dst, size_t stride_px, char ch, uint8_t attr, uint16_t fg, uint16_t bg) const
+        {
+            uint32_t idx = (uint8_t)ch - GlyphBlitter::FIRST_CHAR;
+            if (idx >= GlyphBlitter::NUM_CHARS)
+                idx = 0; // draw unknown characters as blanks
+            if (pixels_ != nullptr && attr == CELL_ATTR_NONE && fg == fg_ && bg == bg_)
+            {
+                const uint16_t *src = pixels_ + idx * CELL_PIXELS;
+                for (int y = 0; y < GlyphBlitter::CELL_H; ++y, dst += stride_px, src += GlyphBlitter::CELL_W)
+                    memcpy(dst, src, GlyphBlitter::CELL_W * sizeof(uint16_t));
+                return;
+            }
+            if (attr & CELL_ATTR_INVERSE)
+            {
+                uint16_t t = fg;
+                fg = bg;
+                bg = t;
+            }
+            const uint16_t *masks = masks_ + idx * GlyphBlitter::CELL_H;
+            for (int y = 0; y < GlyphBlitter::CELL_H; ++y, dst += stride_px)
+                GlyphBlitter::expand_row(dst, GlyphBlitter::decorate_row(masks[y], attr, y), fg, bg);
+        }
+    } // namespace robco_display
+} // namespace esphome
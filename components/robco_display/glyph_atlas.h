@@ -0,0 +1,45 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <cstddef>
+#include <cstdint>
+#include "glyph_blitter.h"
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        enum class GlyphAtlasMode
+        {
+            NONE,   // decode glyphs from the flash font on every draw
+            MASK,   // one 16-bit row mask per glyph row in internal RAM (~4.5 KB)
+            RGB565, // masks plus every glyph pre-expanded in the phosphor colour (~58 KB)
+        };
+
+        // Printable ASCII glyphs unpacked once at startup into internal SRAM, so
+        // drawing a cell never touches the flash-resident 1bpp bitmap.
+        class GlyphAtlas
+        {
+        public:
+            ~GlyphAtlas();
+            // Builds the atlas from an initialised blitter; false if internal RAM is short
+            bool build(const GlyphBlitter &src, GlyphAtlasMode mode, uint16_t fg, uint16_t bg);
+            bool ready() const { return masks_ != nullptr; }
+            GlyphAtlasMode mode() const { return mode_; }
+            size_t size_bytes() const;
+            // Same contract as GlyphBlitter::blit
+            void blit(uint16_t *dst, size_t stride_px, char ch, uint8_t attr, uint16_t fg, uint16_t bg) const;
+
+        private:
+            static constexpr size_t CELL_PIXELS = GlyphBlitter::CELL_W * GlyphBlitter::CELL_H;
+            void release();
+
+            GlyphAtlasMode mode_ = GlyphAtlasMode::NONE;
+            uint16_t *masks_ = nullptr;  // NUM_CHARS * CELL_H row masks
+            uint16_t *pixels_ = nullptr; // NUM_CHARS * CELL_PIXELS, RGB565 mode only
+            uint16_t fg_ = 0;
+            uint16_t bg_ = 0;
+        };
+    } // namespace robco_display
+} // namespace esphome
+#endif // GLYPH_ATLAS_H
@@ -0,0 +1,74 @@
+#include "glyph_blitter.h"
+#include "terminal_grid.h"
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        bool GlyphBlitter::init(const lv_font_t *font)
+        {
+            const lv_font_fmt_txt_dsc_t *dsc = (const lv_font_fmt_txt_dsc_t *)font->dsc;
+            if (dsc == nullptr || dsc->bpp != 1 || dsc->cmap_num < 1)
+                return false;
+            const lv_font_fmt_txt_cmap_t &cmap = dsc->cmaps[0];
+            if (cmap.type != LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY || cmap.range_start > FIRST_CHAR ||
+                cmap.range_start + cmap.range_length < FIRST_CHAR + NUM_CHARS)
+                return false;
+            bitmap_ = dsc->glyph_bitmap;
+            // LVGL places a glyph's bottom edge ofs_y pixels above the baseline
+            int baseline_y = font->line_height - font->base_line;
+            for (uint32_t i = 0; i < NUM_CHARS; ++i)
+            {
+                const lv_font_fmt_txt_glyph_dsc_t &g = dsc->glyph_dsc[cmap.glyph_id_start + FIRST_CHAR + i - cmap.range_start];
+                glyphs_[i].bitmap_index = g.bitmap_index;
+                glyphs_[i].box_w = g.box_w;
+                glyphs_[i].box_h = g.box_h;
+                glyphs_[i].x = g.ofs_x;
+                glyphs_[i].y = baseline_y - g.box_h - g.ofs_y;
+            }
+            return true;
+        }
+
+        uint16_t GlyphBlitter::row_mask(char ch, int y) const
+        {
+            uint32_t idx = (uint8_t)ch - FIRST_CHAR;
+            if (bitmap_ == nullptr || idx >= NUM_CHARS)
+                return 0;
+            const Glyph &g = glyphs_[idx];
+            int gy = y - g.y;
+            if (gy < 0 || gy >= g.box_h)
+                return 0;
+            // Glyph bitmaps are packed MSB first with no per-row padding
+            uint32_t bit = g.bitmap_index * 8 + gy * g.box_w;
+            uint16_t mask = 0;
+            for (int gx = 0; gx < g.box_w; ++gx, ++bit)
+            {
+                int x = g.x + gx;
+                if (x < 0 || x >= CELL_W)
+                    continue;
+                if (bitmap_[bit >> 3] & (0x80 >> (bit & 7)))
+                    mask |= 1 << (CELL_W - 1 - x);
+            }
+            return mask;
+        }
+
+        uint16_t GlyphBlitter::decorate_row(uint16_t mask, uint8_t attr, int y)
+        {
+            if ((attr & CELL_ATTR_UNDERLINE) && y >= CELL_H - 3 && y < CELL_H - 1)
+                mask = (1 << CELL_W) - 1;
+            return mask;
+        }
+
+        void GlyphBlitter::blit(uint16_t *dst, size_t stride_px, char ch, uint8_t attr, uint16_t fg, uint16_t bg) const
+        {
+            if (attr & CELL_ATTR_INVERSE)
+            {
+                uint16_t t = fg;
+                fg = bg;
+                bg = t;
+            }
+            for (int y = 0; y < CELL_H; ++y, dst += stride_px)
+                expand_row(dst, decorate_row(row_mask(ch, y), attr, y), fg, bg);
+        }
+    } // namespace robco_display
+} // namespace esphome
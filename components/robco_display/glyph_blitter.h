@@ -0,0 +1,55 @@
+#ifndef GLYPH_BLITTER_H
+#define GLYPH_BLITTER_H
+
+#include <cstddef>
+#include <cstdint>
+extern "C"
+{
+#include "lvgl.h"
+}
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        // Draws fixed-size character cells from a 1bpp LVGL fmt_txt font straight
+        // into an RGB565 buffer, bypassing LVGL label layout entirely.
+        class GlyphBlitter
+        {
+        public:
+            static constexpr int CELL_W = 12;
+            static constexpr int CELL_H = 24;
+            static constexpr uint32_t FIRST_CHAR = 0x20;
+            static constexpr uint32_t NUM_CHARS = 95;
+
+            // Decodes glyph metrics from the font; returns false if the font is not 1bpp ASCII
+            bool init(const lv_font_t *font);
+            // Paint one CELL_W x CELL_H cell whose top-left pixel is dst
+            void blit(uint16_t *dst, size_t stride_px, char ch, uint8_t attr, uint16_t fg, uint16_t bg) const;
+            // Row mask of a glyph: bit (CELL_W - 1 - x) set means pixel x is lit
+            uint16_t row_mask(char ch, int y) const;
+
+            // Apply per-row cell attributes (underline) to a glyph row mask
+            static uint16_t decorate_row(uint16_t mask, uint8_t attr, int y);
+            // Expand one row mask into CELL_W RGB565 pixels
+            static void expand_row(uint16_t *dst, uint16_t mask, uint16_t fg, uint16_t bg)
+            {
+                for (int x = 0; x < CELL_W; ++x)
+                    dst[x] = (mask & (1 << (CELL_W - 1 - x))) ? fg : bg;
+            }
+
+        private:
+            struct Glyph
+            {
+                uint32_t bitmap_index;
+                uint8_t box_w;
+                uint8_t box_h;
+                int8_t x;
+                int8_t y;
+            };
+            const uint8_t *bitmap_ = nullptr;
+            Glyph glyphs_[NUM_CHARS] = {};
+        };
+    } // namespace robco_display
+} // namespace esphome
+#endif // GLYPH_BLITTER_H
@@ -0,0 +1,250 @@
+#include "log_store.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#endif
+
+// On-flash layout. Each sector starts with a header whose sequence number
+// grows by one per sector opened; records follow, padded to 4 bytes.
+namespace {
+constexpr uint32_t kSectorMagic = 0x474F4C52; // "RLOG"
+constexpr uint16_t kRecordMagic = 0x4C52;
+constexpr size_t kSectorHeaderSize = 16;
+constexpr size_t kRecordHeaderSize = 8;
+
+struct SectorHeader {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t seq_inverted;     // guards against a header cut short while being written
+    uint32_t reserved;
+};
+
+struct RecordHeader {
+    uint16_t magic;
+    uint16_t len;
+    uint32_t crc;              // over len and the text
+};
+
+size_t record_size(size_t len) {
+    return (kRecordHeaderSize + len + 3) & ~size_t(3);
+}
+
+uint32_t crc32(uint32_t crc, const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+uint32_t record_crc(uint16_t len, const void* text) {
+    return crc32(crc32(0, &len, sizeof(len)), text, len);
+}
+
+void* alloc_large(size_t size) {
+#ifdef ESP_PLATFORM
+    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+#else
+    return malloc(size);
+#endif
+}
+} // namespace
+
+LogStore::~LogStore() {
+    free(cache_);
+    free(index_);
+}
+
+bool LogStore::mount(LogPartition* partition) {
+    partition_ = nullptr;
+    count_ = first_ = 0;
+    stats_ = LogStoreStats();
+    sector_size_ = partition->sector_size();
+    sectors_ = sector_size_ > 0 ? partition->size() / sector_size_ : 0;
+    // Per-sector record counts are kept in 16 bits
+    if (sectors_ < 2 || sector_size_ > 65536 || sector_size_ < kSectorHeaderSize + record_size(kMaxEntryLength))
+        return false;
+
+    free(cache_);
+    free(index_);
+    // Without room for the cache every read goes to the partition
+    cache_ = (uint8_t*)alloc_large(sectors_ * sector_size_);
+    if (cache_ != nullptr && !partition->read(0, cache_, sectors_ * sector_size_)) {
+        free(cache_);
+        cache_ = nullptr;
+    }
+    index_capacity_ = sectors_ * ((sector_size_ - kSectorHeaderSize) / record_size(0));
+    index_ = (uint32_t*)alloc_large(index_capacity_ * sizeof(uint32_t));
+    if (index_ == nullptr) return false;
+    partition_ = partition;
+    sector_records_.assign(sectors_, 0);
+
+    // The head is the sector with the newest header; the ring is every sector
+    // before it whose sequence number counts down without a gap
+    bool found = false;
+    for (size_t s = 0; s < sectors_; ++s) {
+        uint32_t seq;
+        if (read_sector_header(s, seq) && (!found || seq > head_seq_)) {
+            head_ = s;
+            head_seq_ = seq;
+            found = true;
+        }
+    }
+    if (!found) {
+        // Blank or foreign partition: start the ring at sector 0
+        head_ = sectors_ - 1;
+        head_seq_ = 0;
+        return open_next_sector();
+    }
+    size_t oldest = head_;
+    size_t used = 1;
+    while (used < sectors_) {
+        size_t prev = (oldest + sectors_ - 1) % sectors_;
+        uint32_t seq;
+        if (!read_sector_header(prev, seq) || seq != head_seq_ - used) break;
+        oldest = prev;
+        used++;
+    }
+    for (size_t k = 0; k < used; ++k) {
+        size_t s = (oldest + k) % sectors_;
+        bool damaged = false;
+        size_t end = scan_sector(s, damaged);
+        if (s == head_) {
+            write_offset_ = end;
+            sealed_ = damaged;
+        }
+    }
+    return true;
+}
+
+size_t LogStore::capacity(size_t entry_length) const {
+    if (sectors_ == 0) return 0;
+    size_t size = record_size(std::min(entry_length, kMaxEntryLength));
+    // The sector being recycled is erased before it is rewritten
+    return (sectors_ - 1) * ((sector_size_ - kSectorHeaderSize) / size);
+}
+
+bool LogStore::read_bytes(size_t offset, void* dst, size_t len) const {
+    if (cache_ != nullptr) {
+        memcpy(dst, cache_ + offset, len);
+        return true;
+    }
+    return partition_->read(offset, dst, len);
+}
+
+bool LogStore::write_bytes(size_t offset, const void* src, size_t len) {
+    if (!partition_->write(offset, src, len)) {
+        stats_.write_errors++;
+        // The bytes are now unknown; the cache must not claim otherwise
+        if (cache_ != nullptr) partition_->read(offset, cache_ + offset, len);
+        return false;
+    }
+    if (cache_ != nullptr) memcpy(cache_ + offset, src, len);
+    return true;
+}
+
+bool LogStore::erase(size_t sector) {
+    stats_.erases++;
+    if (!partition_->erase_sector(sector)) {
+        stats_.write_errors++;
+        return false;
+    }
+    if (cache_ != nullptr) memset(cache_ + sector * sector_size_, 0xFF, sector_size_);
+    return true;
+}
+
+bool LogStore::read_sector_header(size_t sector, uint32_t& seq) const {
+    SectorHeader header;
+    if (!read_bytes(sector * sector_size_, &header, sizeof(header))) return false;
+    if (header.magic != kSectorMagic || header.seq != ~header.seq_inverted) return false;
+    seq = header.seq;
+    return true;
+}
+
+size_t LogStore::scan_sector(size_t sector, bool& damaged) {
+    size_t base = sector * sector_size_;
+    size_t offset = kSectorHeaderSize;
+    char text[kMaxEntryLength];
+    while (offset + kRecordHeaderSize <= sector_size_) {
+        RecordHeader header;
+        if (!read_bytes(base + offset, &header, sizeof(header))) break;
+        if (header.magic == 0xFFFF && header.len == 0xFFFF && header.crc == 0xFFFFFFFF) return offset;
+        if (header.magic != kRecordMagic || header.len > kMaxEntryLength ||
+            offset + record_size(header.len) > sector_size_ ||
+            !read_bytes(base + offset + kRecordHeaderSize, text, header.len) ||
+            record_crc(header.len, text) != header.crc) {
+            break;
+        }
+        index_[(first_ + count_++) % index_capacity_] = base + offset;
+        sector_records_[sector]++;
+        offset += record_size(header.len);
+    }
+    // Whatever follows a damaged record cannot be trusted, including erased-looking bytes
+    if (offset + kRecordHeaderSize <= sector_size_) {
+        damaged = true;
+        stats_.torn++;
+    }
+    return offset;
+}
+
+bool LogStore::open_next_sector() {
+    size_t next = (head_ + 1) % sectors_;
+    // Sectors holding entries run up to the head, so if the next one holds any
+    // they are the oldest and sit at the front of the index
+    size_t dropped = sector_records_[next];
+    first_ = (first_ + dropped) % index_capacity_;
+    count_ -= dropped;
+    stats_.evicted += dropped;
+    sector_records_[next] = 0;
+    head_ = next;
+    sealed_ = true;
+    if (!erase(next)) return false;
+    uint32_t seq = head_seq_ + 1;
+    SectorHeader header = {kSectorMagic, seq, ~seq, 0xFFFFFFFF};
+    if (!write_bytes(next * sector_size_, &header, sizeof(header))) return false;
+    head_seq_ = seq;
+    write_offset_ = kSectorHeaderSize;
+    sealed_ = false;
+    return true;
+}
+
+bool LogStore::append(const char* text, size_t len) {
+    if (partition_ == nullptr) return false;
+    len = std::min(len, kMaxEntryLength);
+    size_t size = record_size(len);
+    if ((sealed_ || write_offset_ + size > sector_size_) && !open_next_sector()) return false;
+
+    uint8_t record[kRecordHeaderSize + kMaxEntryLength + 3];
+    memset(record, 0xFF, sizeof(record));
+    RecordHeader header = {kRecordMagic, (uint16_t)len, record_crc((uint16_t)len, text)};
+    memcpy(record, &header, sizeof(header));
+    memcpy(record + kRecordHeaderSize, text, len);
+    size_t offset = head_ * sector_size_ + write_offset_;
+    if (!write_bytes(offset, record, size)) {
+        sealed_ = true;
+        return false;
+    }
+    index_[(first_ + count_++) % index_capacity_] = offset;
+    sector_records_[head_]++;
+    write_offset_ += size;
+    stats_.appends++;
+    return true;
+}
+
+size_t LogStore::read(size_t index, char* buf, size_t size) const {
+    if (size == 0) return 0;
+    RecordHeader header;
+    size_t offset = index < count_ ? record_offset(index) : 0;
+    if (index >= count_ || !read_bytes(offset, &header, sizeof(header))) {
+        buf[0] = '\0';
+        return 0;
+    }
+    size_t len = std::min((size_t)header.len, size - 1);
+    if (!read_bytes(offset + kRecordHeaderSize, buf, len)) len = 0;
+    buf[len] = '\0';
+    return len;
+}
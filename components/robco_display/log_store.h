@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Raw storage behind a LogStore, with NOR flash semantics: it is divided into
+// erasable sectors, erased bytes read 0xFF and writes only ever clear bits.
+class LogPartition {
+public:
+    virtual ~LogPartition() = default;
+    virtual size_t size() const = 0;
+    virtual size_t sector_size() const = 0;
+    virtual bool read(size_t offset, void* dst, size_t len) = 0;
+    virtual bool write(size_t offset, const void* src, size_t len) = 0;
+    virtual bool erase_sector(size_t sector) = 0;
+};
+
+struct LogStoreStats {
+    uint32_t appends = 0;
+    uint32_t evicted = 0;        // entries dropped with the oldest sector
+    uint32_t erases = 0;
+    uint32_t torn = 0;           // damaged records found while mounting
+    uint32_t write_errors = 0;
+};
+
+// Append-only ring of short text entries on a LogPartition. Sectors are filled
+// in turn and the oldest one is erased when the ring wraps, so every sector
+// sees the same number of erases. Records carry a CRC; a record cut short by a
+// reset is skipped at mount and writing resumes in a fresh sector.
+//
+// Memory is fixed by the partition size: a RAM copy of the partition (PSRAM
+// on the device) and an index of record offsets. Appends and evictions are
+// constant time and any entry can be read by position.
+class LogStore {
+public:
+    static constexpr size_t kMaxEntryLength = 80;
+
+    LogStore() = default;
+    LogStore(const LogStore&) = delete;
+    LogStore& operator=(const LogStore&) = delete;
+    ~LogStore();
+    // Index every intact record on the partition; false if it is unusable
+    bool mount(LogPartition* partition);
+    bool mounted() const { return partition_ != nullptr; }
+    // Store one entry, truncated to kMaxEntryLength
+    bool append(const char* text, size_t len);
+    size_t count() const { return count_; }
+    // Entries the ring holds at most when every entry is this long
+    size_t capacity(size_t entry_length) const;
+    // Copy entry index (0 = oldest) into buf and NUL-terminate it; returns the length
+    size_t read(size_t index, char* buf, size_t size) const;
+    const LogStoreStats& stats() const { return stats_; }
+
+private:
+    size_t record_offset(size_t index) const { return index_[(first_ + index) % index_capacity_]; }
+    bool read_bytes(size_t offset, void* dst, size_t len) const;
+    bool write_bytes(size_t offset, const void* src, size_t len);
+    bool erase(size_t sector);
+    bool read_sector_header(size_t sector, uint32_t& seq) const;
+    // Index the records of one sector; returns the offset after the last intact one
+    size_t scan_sector(size_t sector, bool& damaged);
+    // Start writing the sector after the head, evicting the oldest entries it holds
+    bool open_next_sector();
+
+    LogPartition* partition_ = nullptr;
+    size_t sector_size_ = 0;
+    size_t sectors_ = 0;
+    uint8_t* cache_ = nullptr;           // copy of the whole partition, or nullptr to read through
+    uint32_t* index_ = nullptr;          // ring of record offsets, oldest first
+    size_t index_capacity_ = 0;
+    size_t first_ = 0;
+    size_t count_ = 0;
+    std::vector<uint16_t> sector_records_;
+    size_t head_ = 0;                    // sector being written
+    uint32_t head_seq_ = 0;
+    size_t write_offset_ = 0;            // within the head sector
+    bool sealed_ = false;                // head sector must not be written again
+    LogStoreStats stats_;
+};
@@ -1,20 +1,51 @@
 #include "menu_state.h"
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
-MenuState::MenuState() {}
+// Fixed-capacity line composer used by update_view; truncates at kMaxLineLength
+class MenuState::LineBuilder {
+public:
+    LineBuilder& append(const char* s, size_t n) {
+        n = std::min(n, kMaxLineLength - len_);
+        memcpy(buf_ + len_, s, n);
+        len_ += n;
+        return *this;
+    }
+    LineBuilder& append(const char* s) { return append(s, strlen(s)); }
+    LineBuilder& append(const std::string& s) { return append(s.data(), s.size()); }
+    LineBuilder& fill(char c, size_t n) {
+        n = std::min(n, kMaxLineLength - len_);
+        memset(buf_ + len_, c, n);
+        len_ += n;
+        return *this;
+    }
+    const char* data() const { return buf_; }
+    size_t size() const { return len_; }
+private:
+    char buf_[kMaxLineLength];
+    size_t len_ = 0;
+};
+
+MenuState::MenuState() {
+    tree_.add_status_listener([this](int32_t) { status_dirty_ = true; });
+}
 
 void MenuState::start_password_entry(const std::string& prompt) {
+    layout_dirty_ = true;
     password_entry_mode_ = true;
     password_.clear();
     password_prompt_ = prompt;
 }
 
 void MenuState::append_password_char(char c) {
+    layout_dirty_ = true;
     if (password_entry_mode_)
         password_ += c;
 }
 
 void MenuState::remove_password_char() {
+    layout_dirty_ = true;
     if (password_entry_mode_ && !password_.empty())
         password_.pop_back();
 }
@@ -28,6 +59,7 @@ std::string MenuState::get_password() const {
 }
 
 void MenuState::end_password_entry() {
+    layout_dirty_ = true;
     password_entry_mode_ = false;
     password_.clear();
     password_prompt_.clear();
@@ -37,138 +69,278 @@ std::string MenuState::get_password_prompt() const {
     return password_prompt_;
 }
 
-void MenuState::set_boot_messages(const std::vector<std::string>& messages) {
-    boot_messages_ = messages;
-}
-
-void MenuState::set_menu(const std::vector<MenuEntry>& menu) {
-    menu_ = menu;
+void MenuState::set_definition(const MenuDefinition& definition) {
+    layout_dirty_ = true;
+    header_ = definition.header;
+    header_count_ = definition.header_count;
+    boot_messages_ = definition.boot_messages;
+    boot_message_count_ = definition.boot_message_count;
+    tree_.assign(definition.nodes, definition.node_count, definition.ids, definition.id_count);
+    current_menu_ = MenuTree::kRoot;
+    selected_ = tree_.node(MenuTree::kRoot).first_navigable_child;
+    open_list();
 }
 
 void MenuState::on_key_press(uint8_t keycode) {
-    auto is_navigable_type = [](MenuEntry::Type type) {
-        return type == MenuEntry::Type::ACTION || type == MenuEntry::Type::SUBMENU;
-    };
-    auto set_first_navigable = [&](const std::vector<MenuEntry>* menu) {
-        for (size_t i = 0; i < menu->size(); ++i) {
-            if (is_navigable_type((*menu)[i].type)) {
-                selected_index_ = i;
-                return;
-            }
-        }
-        selected_index_ = -11;
-    };
+    layout_dirty_ = true;
     if (!boot_complete_) {
         boot_complete_ = true;
-        set_first_navigable(&menu_);
+        current_menu_ = MenuTree::kRoot;
+        selected_ = tree_.node(MenuTree::kRoot).first_navigable_child;
+        open_list();
         return;
     }
-    std::vector<MenuEntry>* current_menu = &menu_;
-    for (size_t i = 0; i < menu_stack_.size(); ++i) {
-        int idx = menu_stack_[i];
-        if (idx >= 0 && idx < current_menu->size()) {
-            current_menu = &(*current_menu)[idx].subitems;
-        }
-    }
-    int menu_size = current_menu->size();
-    if (menu_size == 0) return;
-    auto is_navigable = [&](int idx) {
-        return is_navigable_type((*current_menu)[idx].type);
-    };
     if (keycode == 0x52) { // Up
-        int next = selected_index_;
-        do {
-            next = (next - 1 + menu_size) % menu_size;
-        } while (!is_navigable(next) && next != selected_index_);
-        if (is_navigable(next)) selected_index_ = next;
+        if (showing_logs()) viewport_.scroll_by(-1);
+        else if (selected_ != MenuTree::kNoNode) selected_ = tree_.node(selected_).prev_navigable;
+        follow_selection();
     } else if (keycode == 0x51) { // Down
-        int next = selected_index_;
-        do {
-            next = (next + 1) % menu_size;
-        } while (!is_navigable(next) && next != selected_index_);
-        if (is_navigable(next)) selected_index_ = next;
+        if (showing_logs()) viewport_.scroll_by(1);
+        else if (selected_ != MenuTree::kNoNode) selected_ = tree_.node(selected_).next_navigable;
+        follow_selection();
+    } else if (keycode == 0x4B) { // Page Up
+        viewport_.page_up();
+        select_in_window();
+    } else if (keycode == 0x4E) { // Page Down
+        viewport_.page_down();
+        select_in_window();
     } else if (keycode == 0x28) { // Enter
-        if ((*current_menu)[selected_index_].type == MenuEntry::Type::SUBMENU) {
-            menu_stack_.push_back(selected_index_);
-            set_first_navigable(&(*current_menu)[selected_index_].subitems);
+        if (selected_ != MenuTree::kNoNode && (tree_.node(selected_).type == MenuEntry::Type::SUBMENU ||
+                                               tree_.node(selected_).type == MenuEntry::Type::LOGS)) {
+            current_menu_ = selected_;
+            selected_ = tree_.node(selected_).first_navigable_child;
+            open_list();
         }
     } else if (keycode == 0x29) { // Escape
-        if (!menu_stack_.empty()) {
-            selected_index_ = menu_stack_.back();
-            menu_stack_.pop_back();
+        if (current_menu_ != MenuTree::kRoot) {
+            selected_ = current_menu_;
+            current_menu_ = tree_.node(current_menu_).parent;
+            open_list();
         }
     }
 }
 
-const std::vector<std::string>& MenuState::get_boot_messages() const {
-    return boot_messages_;
+void MenuState::set_screen_lines(size_t n) {
+    layout_dirty_ = true;
+    screen_lines_ = std::min(n, kMaxLines);
+    viewport_.set_rows(list_rows());
+    follow_selection();
+}
+
+size_t MenuState::list_rows() const {
+    return screen_lines_ > header_count_ ? screen_lines_ - header_count_ : 1;
+}
+
+void MenuState::open_list() {
+    if (showing_logs()) {
+        // Log views open on the newest entries
+        list_first_ = MenuTree::kNoNode;
+        viewport_.reset(get_log_count(), list_rows());
+        viewport_.scroll_to(viewport_.max_offset());
+        return;
+    }
+    list_first_ = tree_.node(current_menu_).first_child;
+    viewport_.reset(tree_.child_count(current_menu_), list_rows());
+    follow_selection();
+}
+
+void MenuState::follow_selection() {
+    if (selected_ != MenuTree::kNoNode && list_first_ != MenuTree::kNoNode) viewport_.follow(selected_ - list_first_);
+}
+
+void MenuState::select_in_window() {
+    if (selected_ == MenuTree::kNoNode || list_first_ == MenuTree::kNoNode || viewport_.visible() == 0) return;
+    int32_t top = list_first_ + viewport_.offset();
+    int32_t bottom = top + viewport_.visible() - 1;
+    if (selected_ >= top && selected_ <= bottom) return;
+    bool below = selected_ < top;
+    int32_t candidate = below ? top : bottom;
+    if (!MenuTree::is_navigable(tree_.node(candidate).type))
+        candidate = below ? tree_.node(candidate).next_navigable : tree_.node(candidate).prev_navigable;
+    // Leave the selection off screen if the window has nothing selectable
+    if (candidate >= top && candidate <= bottom) selected_ = candidate;
+}
+
+size_t MenuState::get_boot_text_length() const {
+    size_t total = 0;
+    for (size_t i = 0; i < boot_message_count_; ++i) total += strlen(boot_messages_[i]) + 1;
+    return total;
 }
 
 bool MenuState::is_boot_complete() const {
     return boot_complete_;
 }
 
-const MenuEntry* MenuState::get_current_menu() const {
-    if (menu_stack_.empty()) return nullptr;
-    return &menu_[menu_stack_.back()];
+void MenuState::set_log_store(LogStore* store) {
+    logs_ = store;
+    if (showing_logs()) open_list();
+    layout_dirty_ = true;
 }
 
-int MenuState::get_selected_index() const {
-    return selected_index_;
+void MenuState::add_log(const std::string& entry) {
+    if (logs_ == nullptr) return;
+    uint32_t evicted = logs_->stats().evicted;
+    logs_->append(entry.data(), entry.size());
+    if (!showing_logs()) return;
+    // Entries dropped from the front renumber the rest; keep the same entries in
+    // view, unless the view shows the newest entry and follows new ones
+    evicted = logs_->stats().evicted - evicted;
+    bool at_end = viewport_.offset() == viewport_.max_offset();
+    shown_offset_ = shown_offset_ > evicted ? shown_offset_ - evicted : 0;
+    viewport_.scroll_by(-(long)evicted);
+    viewport_.set_count(logs_->count());
+    if (at_end) viewport_.scroll_to(viewport_.max_offset());
+    layout_dirty_ = true;
 }
 
-void MenuState::set_header(const std::vector<std::string>& header) {
-    header_lines_ = header;
+void MenuState::commit_line(size_t index, const LineBuilder& line) {
+    if (index >= kMaxLines) return;
+    if (line_len_[index] == line.size() && memcmp(lines_[index], line.data(), line.size()) == 0) return;
+    memcpy(lines_[index], line.data(), line.size());
+    lines_[index][line.size()] = '\0';
+    line_len_[index] = line.size();
+    line_generation_[index]++;
+    dirty_lines_ |= 1u << index;
 }
 
-std::string MenuState::get_display_text() const {
-    if (!boot_complete_) {
-        std::string text;
-        for (const auto& line : boot_messages_) text += line + "\n";
-        return text;
+void MenuState::shift_lines(size_t top, size_t rows, int delta) {
+    if (top >= kMaxLines) return;
+    rows = std::min(rows, kMaxLines - top);
+    // A pending shift the consumer has not taken yet can only be merged if it
+    // covers the same lines; otherwise fall back to redrawing those lines
+    if (pending_scroll_.delta != 0 && (pending_scroll_.top != top || pending_scroll_.rows != rows)) {
+        for (size_t i = pending_scroll_.top; i < pending_scroll_.top + pending_scroll_.rows; ++i) dirty_lines_ |= 1u << i;
+        pending_scroll_.delta = 0;
     }
-    std::string header_text;
-    for (const auto& header : header_lines_) {
-        header_text += header + "\n";
+    size_t distance = delta < 0 ? -delta : delta;
+    if (distance >= rows || (size_t)std::abs(pending_scroll_.delta + delta) >= rows) {
+        // Nothing survives on screen; every line gets recomposed and redrawn
+        for (size_t i = top; i < top + rows; ++i) dirty_lines_ |= 1u << i;
+        pending_scroll_.delta = 0;
+        return;
     }
-    if (password_entry_mode_) {
-        std::string masked(password_.size(), '*');
-        return header_text + password_prompt_ + "\n" + masked;
+    size_t kept = rows - distance;
+    size_t from = delta > 0 ? top + distance : top;
+    size_t to = delta > 0 ? top : top + distance;
+    memmove(lines_[to], lines_[from], kept * sizeof(lines_[0]));
+    memmove(&line_len_[to], &line_len_[from], kept * sizeof(line_len_[0]));
+    // Lines that are dirty keep their flag at their new position
+    uint32_t region = (rows < 32 ? (1u << rows) - 1 : ~0u) << top;
+    uint32_t moved = delta > 0 ? (dirty_lines_ & region) >> distance : (dirty_lines_ & region) << distance;
+    dirty_lines_ = (dirty_lines_ & ~region) | (moved & region);
+    for (size_t i = to; i < to + kept; ++i) line_generation_[i]++;
+    pending_scroll_ = {top, rows, pending_scroll_.delta + delta};
+}
+
+void MenuState::compose_menu_line(size_t row, int32_t node_index) {
+    if (row >= kMaxLines) return;
+    const MenuNode& node = tree_.node(node_index);
+    LineBuilder line;
+    line.append(node_index == selected_ ? "> " : "  ").append(node.title);
+    StatusValue status = tree_.status(node_index);
+    if (node.type == MenuEntry::Type::STATUS && status.len > 0) {
+        line.append(": ").append(status.data, status.len);
     }
-    const std::vector<MenuEntry>* current_menu = &menu_;
-    for (size_t i = 0; i < menu_stack_.size(); ++i) {
-        int idx = menu_stack_[i];
-        if (idx >= 0 && idx < current_menu->size()) {
-            current_menu = &(*current_menu)[idx].subitems;
+    line_node_[row] = node_index;
+    line_status_version_[row] = status.version;
+    commit_line(row, line);
+}
+
+uint32_t MenuState::update_view() {
+    if (!layout_dirty_) {
+        // Only status values changed: recompose just the visible lines whose value moved on
+        if (status_dirty_) {
+            status_dirty_ = false;
+            for (size_t row = 0; row < kMaxLines; ++row) {
+                int32_t node = line_node_[row];
+                if (node != MenuTree::kNoNode && tree_.status(node).version != line_status_version_[row])
+                    compose_menu_line(row, node);
+            }
         }
+        return dirty_lines_;
     }
-    std::string text = "";
-    for (size_t i = 0; i < current_menu->size(); ++i) {
-        std::string line = (i == selected_index_ ? "> " : "  ") + (*current_menu)[i].title;
-        if ((*current_menu)[i].type == MenuEntry::Type::STATUS && !(*current_menu)[i].status_value.empty()) {
-            line += ": " + (*current_menu)[i].status_value;
+    layout_dirty_ = false;
+    status_dirty_ = false;
+    std::fill(std::begin(line_node_), std::end(line_node_), (int16_t)MenuTree::kNoNode);
+    size_t n = 0;
+    cursor_row_ = -1;
+    cursor_col_ = 0;
+    if (!boot_complete_) {
+        // The caret follows the typed text and rests after the last line once done
+        size_t remaining = boot_visible_chars_;
+        size_t last_len = 0;
+        for (size_t m = 0; m < boot_message_count_; ++m) {
+            const char* msg = boot_messages_[m];
+            size_t len = strlen(msg);
+            last_len = len;
+            if (cursor_row_ < 0 && remaining <= len) {
+                cursor_row_ = n;
+                cursor_col_ = remaining;
+            }
+            size_t shown = std::min(len, remaining);
+            commit_line(n++, LineBuilder().append(msg, shown));
+            remaining -= shown;
+            if (remaining > 0) remaining--; // the line break
+        }
+        if (cursor_row_ < 0 && n > 0) {
+            cursor_row_ = n - 1;
+            cursor_col_ = last_len;
+        }
+    } else {
+        for (size_t i = 0; i < header_count_; ++i) commit_line(n++, LineBuilder().append(header_[i]));
+        if (password_entry_mode_) {
+            commit_line(n++, LineBuilder().append(password_prompt_));
+            cursor_row_ = n;
+            cursor_col_ = password_.size();
+            commit_line(n++, LineBuilder().fill('*', password_.size()));
+        } else {
+            // Only the visible window is composed; lines that stayed on screen
+            // across a scroll are shifted rather than rebuilt
+            size_t offset = viewport_.offset();
+            if (shown_list_ == current_menu_ && shown_top_ == n && shown_rows_ == viewport_.rows() &&
+                shown_offset_ != offset) {
+                shift_lines(n, viewport_.rows(), (int)((long)offset - (long)shown_offset_));
+            }
+            shown_list_ = current_menu_;
+            shown_top_ = n;
+            shown_rows_ = viewport_.rows();
+            shown_offset_ = offset;
+            for (size_t k = 0; k < viewport_.visible(); ++k) {
+                if (list_first_ == MenuTree::kNoNode) {
+                    char entry[LogStore::kMaxEntryLength + 1];
+                    size_t len = logs_->read(offset + k, entry, sizeof(entry));
+                    commit_line(n++, LineBuilder().append(entry, len));
+                    continue;
+                }
+                int32_t i = list_first_ + offset + k;
+                if (i == selected_) cursor_row_ = n;
+                compose_menu_line(n++, i);
+            }
         }
-        text += line + "\n";
     }
-    return header_text + text;
-}
-
-void MenuState::add_log(const std::string& entry) {
-    logs_.push_back(entry);
+    if (!boot_complete_ || password_entry_mode_) shown_list_ = MenuTree::kNoNode;
+    // Blank whatever the previous view left below the new content
+    for (; n < kMaxLines; ++n) commit_line(n, LineBuilder());
+    return dirty_lines_;
 }
 
-void MenuState::remove_log(int index) {
-    if (index >= 0 && index < logs_.size()) logs_.erase(logs_.begin() + index);
+ScrollShift MenuState::take_scroll() {
+    ScrollShift shift = pending_scroll_;
+    pending_scroll_ = {0, 0, 0};
+    return shift;
 }
 
-const std::vector<std::string>& MenuState::get_logs() const {
-    return logs_;
+uint32_t MenuState::take_dirty_lines() {
+    uint32_t dirty = dirty_lines_;
+    dirty_lines_ = 0;
+    return dirty;
 }
 
-void MenuState::set_status(const std::string& value) {
-    status_value_ = value;
+LineSpan MenuState::get_line(size_t index) const {
+    if (index >= kMaxLines) return {"", 0};
+    return {lines_[index], line_len_[index]};
 }
 
-std::string MenuState::get_status() const {
-    return status_value_;
+uint32_t MenuState::get_line_generation(size_t index) const {
+    return index < kMaxLines ? line_generation_[index] : 0;
 }
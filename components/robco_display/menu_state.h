@@ -1,21 +1,32 @@
 
 #pragma once
 #include <string>
-#include <vector>
 #include <cstdint>
+#include "log_store.h"
+#include "menu_tree.h"
+#include "scroll_viewport.h"
 
 
-struct MenuEntry {
-    std::string title;
-    enum class Type { STATIC, SUBMENU, ACTION, STATUS, LOGS } type;
-    std::vector<MenuEntry> subitems;
-    std::vector<std::string> logs;
-    std::string status_value;
+// View of one display line; data is NUL-terminated and owned by MenuState
+struct LineSpan {
+    const char* data;
+    size_t len;
 };
 
+// Screen lines top..top+rows-1 whose content moved up by delta lines (down if
+// negative) without being flagged dirty; the consumer shifts what it already
+// drew instead of redrawing it. delta 0 means nothing moved.
+struct ScrollShift {
+    size_t top;
+    size_t rows;
+    int delta;
+};
 
 class MenuState {
 public:
+    static constexpr size_t kMaxLines = 32;        // width of the dirty bitmask
+    static constexpr size_t kMaxLineLength = 80;
+
     MenuState();
     // Password entry mode
     void start_password_entry(const std::string& prompt);
@@ -25,34 +36,96 @@ public:
     std::string get_password() const;
     void end_password_entry();
     std::string get_password_prompt() const;
-    void set_header(const std::vector<std::string>& header);
-    void set_boot_messages(const std::vector<std::string>& messages);
-    void set_menu(const std::vector<MenuEntry>& menu);
+    // Header, boot text and menu from generated tables, used in place
+    void set_definition(const MenuDefinition& definition);
+    // Arrows move the selection, Page Up/Down scroll a page and move the
+    // selection into view; Enter opens submenus and log views
     void on_key_press(uint8_t keycode);
-    const std::vector<std::string>& get_boot_messages() const;
+    // Lines the display shows; lists that do not fit below the header scroll
+    void set_screen_lines(size_t n);
+    // Window over the open menu or log list
+    const ScrollViewport& get_viewport() const { return viewport_; }
+    // Characters in the boot text, counting one per line break
+    size_t get_boot_text_length() const;
+    // Show only the first n characters of the boot text (SIZE_MAX shows all)
+    void set_boot_visible_chars(size_t n) {
+        if (n != boot_visible_chars_) layout_dirty_ = true;
+        boot_visible_chars_ = n;
+    }
     bool is_boot_complete() const;
-    const MenuEntry* get_current_menu() const;
-    int get_selected_index() const;
-    std::string get_display_text() const;
+    // Node whose children are on screen (MenuTree::kRoot at the top level)
+    int32_t get_current_menu() const { return current_menu_; }
+    // Selected node, or MenuTree::kNoNode
+    int32_t get_selected_node() const { return selected_; }
+    // Recompose the fixed line view in place (no heap allocation) and flag
+    // every line whose content changed. Returns the accumulated dirty mask.
+    // When only status values changed since the last call, just the lines
+    // showing those values are recomposed.
+    uint32_t update_view();
+    // Return the dirty bitmask (bit i = line i) and clear it
+    uint32_t take_dirty_lines();
+    // Return the shift update_view() applied since the last call and clear it
+    ScrollShift take_scroll();
+    // Re-flag lines whose update could not be delivered
+    void mark_lines_dirty(uint32_t mask) { dirty_lines_ |= mask; }
+    LineSpan get_line(size_t index) const;
+    // Cursor cell chosen by the last update_view(); row -1 means no cursor
+    int get_cursor_row() const { return cursor_row_; }
+    size_t get_cursor_col() const { return cursor_col_; }
+    uint32_t get_line_generation(size_t index) const;
+    // Entries shown by LOGS menu views; without a store they stay empty
+    void set_log_store(LogStore* store);
     void add_log(const std::string& entry);
-    void remove_log(int index);
-    const std::vector<std::string>& get_logs() const;
-    void set_status(const std::string& value);
-    std::string get_status() const;
-    std::vector<MenuEntry>& get_menu();
-    const std::vector<int>& get_menu_stack() const { return menu_stack_; }
+    size_t get_log_count() const { return logs_ != nullptr ? logs_->count() : 0; }
+    MenuTree& get_menu_tree() { return tree_; }
+    const MenuTree& get_menu_tree() const { return tree_; }
 private:
-    std::vector<std::string> header_lines_;
-    std::vector<std::string> boot_messages_;
+    class LineBuilder;
+    void commit_line(size_t index, const LineBuilder& line);
+    void compose_menu_line(size_t row, int32_t node_index);
+    bool showing_logs() const { return tree_.node(current_menu_).type == MenuEntry::Type::LOGS; }
+    size_t list_rows() const;
+    // Point the viewport at the children (or logs) of current_menu_
+    void open_list();
+    void follow_selection();
+    // After a page scroll, move the selection to the nearest navigable entry in view
+    void select_in_window();
+    void shift_lines(size_t top, size_t rows, int delta);
+    const char* const* header_ = nullptr;
+    size_t header_count_ = 0;
+    const char* const* boot_messages_ = nullptr;
+    size_t boot_message_count_ = 0;
     bool boot_complete_ = false;
-    std::vector<MenuEntry> menu_;
-    int selected_index_ = 0;
-    int current_menu_level_ = 0;
-    std::vector<int> menu_stack_;
-    std::vector<std::string> logs_;
-    std::string status_value_;
+    size_t boot_visible_chars_ = SIZE_MAX;
+    MenuTree tree_;
+    int32_t current_menu_ = MenuTree::kRoot;
+    int32_t selected_ = MenuTree::kNoNode;
+    LogStore* logs_ = nullptr;
     // Password entry state
     bool password_entry_mode_ = false;
     std::string password_;
     std::string password_prompt_;
+    // Line view
+    char lines_[kMaxLines][kMaxLineLength + 1] = {};
+    uint8_t line_len_[kMaxLines] = {};
+    uint32_t line_generation_[kMaxLines] = {};
+    uint32_t dirty_lines_ = 0;
+    int cursor_row_ = -1;
+    size_t cursor_col_ = 0;
+    // Set by anything that changes what is on screen other than a status value
+    bool layout_dirty_ = true;
+    bool status_dirty_ = false;
+    // Menu node shown on each line and the status version it was composed with
+    int16_t line_node_[kMaxLines] = {};
+    uint32_t line_status_version_[kMaxLines] = {};
+    // Scrolling
+    size_t screen_lines_ = kMaxLines;
+    ScrollViewport viewport_;
+    int32_t list_first_ = MenuTree::kNoNode; // node shown at viewport index 0; kNoNode for logs
+    // List, position and offset the line view was last composed with
+    int32_t shown_list_ = MenuTree::kNoNode;
+    size_t shown_top_ = 0;
+    size_t shown_rows_ = 0;
+    size_t shown_offset_ = 0;
+    ScrollShift pending_scroll_ = {0, 0, 0};
 };
@@ -0,0 +1,221 @@
+"""Compile the YAML menu, header and boot text into constexpr C++ tables.
+
+MenuTree in menu_tree.cpp uses the tables in place: siblings are stored
+contiguously and next/prev navigable links wrap around within each sibling
+group.
+"""
+import logging
+
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.helpers import cpp_string_escape
+
+_LOGGER = logging.getLogger(__name__)
+
+MENU_ITEM_TYPES = ["static", "submenu", "action", "status", "logs"]
+NAVIGABLE_TYPES = ("action", "submenu", "logs")
+MAX_NODES = 32767
+
+DEFAULT_HEADER = [
+    "        ROBCO INDUSTRIES UNIFIED OPERATING SYSTEM",
+    "           COPYRIGHT 2075-2077 ROBCO INDUSTRIES",
+    "",
+    "                        -Server 1-",
+    "Welcome, Overseer.",
+    "------------------",
+]
+
+DEFAULT_BOOT_MESSAGES = [
+    "RobCo Industries (TM) Termlink Protocol",
+    "Established 2075",
+    "",
+    "VAULT-TEC TERMINAL SYSTEM",
+    "Initializing...",
+    "",
+    "Boot Sequence Started",
+    "Loading System Drivers...",
+    "Checking Memory Banks...",
+    "Network Interface: ONLINE",
+    "Security Protocols: ACTIVE",
+    "",
+    "System Status: NOMINAL",
+    "Security Level: AUTHORIZED",
+    "Access Level: OVERSEER",
+    "",
+    "Welcome to RobCo Termlink",
+    "Have a Nice Day!",
+    "",
+    "> Press any key to continue...",
+]
+
+DEFAULT_MENU = [
+    "",
+    {"title": "Vault Door Control", "items": [
+        {"title": "Open Vault Door", "type": "action", "menu_id": "open_vault_door"},
+        "",
+        {"title": "Close Vault Door", "type": "action", "menu_id": "close_vault_door"},
+    ]},
+    "",
+    {"title": "System Status", "items": [
+        "Power: Stable",
+        "",
+        {"title": "Door", "type": "status", "menu_id": "door_status", "status": "Unknown"},
+        "",
+        "Security: Nominal",
+    ]},
+    "",
+    {"title": "Overseer Logs", "items": [
+        "CORRUPTED MEMORY BANK",
+        "##??DATA ERROR??##",
+        "@!X1Z!@#%$*",
+        "??ERROR??",
+        "DATA_CORRUPT A9!B7#C",
+    ]},
+    "",
+]
+
+
+def menu_item(value):
+    """A menu entry; a bare string is a static line."""
+    if isinstance(value, str):
+        value = {"title": value}
+    value = cv.Schema({
+        cv.Optional("title", default=""): cv.string,
+        cv.Optional("type"): cv.one_of(*MENU_ITEM_TYPES, lower=True),
+        cv.Optional("menu_id"): cv.string,
+        cv.Optional("status", default=""): cv.string,
+        cv.Optional("items", default=[]): cv.ensure_list(menu_item),
+    })(value)
+    if "type" not in value:
+        value["type"] = "submenu" if value["items"] else "static"
+    if value["items"] and value["type"] != "submenu":
+        raise cv.Invalid("only submenus can have items")
+    return value
+
+
+def validate_menu(items):
+    items = cv.ensure_list(menu_item)(items)
+    seen = set()
+
+    def walk(entries):
+        for entry in entries:
+            if "menu_id" in entry:
+                if entry["menu_id"] in seen:
+                    raise cv.Invalid(f"duplicate menu_id '{entry['menu_id']}'")
+                seen.add(entry["menu_id"])
+            walk(entry["items"])
+
+    walk(items)
+    return items
+
+
+def flatten_menu(items):
+    """Lay the menu out as MenuTree nodes; node 0 is the synthetic root."""
+    nodes = [{"title": "", "menu_id": None, "status": "", "type": "submenu", "parent": -1,
+              "first_child": -1, "child_count": 0, "next_sibling": -1, "first_nav": -1, "next_nav": 0, "prev_nav": 0,
+              "status_slot": -1}]
+    status_slots = 0
+
+    def add_children(parent, children):
+        nonlocal status_slots
+        if not children:
+            return
+        first = len(nodes)
+        for i, item in enumerate(children):
+            slot = -1
+            if item["type"] == "status":
+                slot = status_slots
+                status_slots += 1
+            nodes.append({"title": item["title"], "menu_id": item.get("menu_id"), "status": item["status"],
+                          "type": item["type"], "parent": parent, "first_child": -1, "child_count": 0,
+                          "next_sibling": first + i + 1 if i + 1 < len(children) else -1,
+                          "first_nav": -1, "next_nav": -1, "prev_nav": -1, "status_slot": slot})
+        nodes[parent]["first_child"] = first
+        nodes[parent]["child_count"] = len(children)
+        nav = [first + i for i, item in enumerate(children) if item["type"] in NAVIGABLE_TYPES]
+        if nav:
+            nodes[parent]["first_nav"] = nav[0]
+            # Nearest navigable sibling after and before each entry, wrapping around;
+            # one pass each way keeps large groups linear
+            following = nav[0]
+            for i in range(first + len(children) - 1, first - 1, -1):
+                nodes[i]["next_nav"] = following
+                if nodes[i]["type"] in NAVIGABLE_TYPES:
+                    following = i
+            preceding = nav[-1]
+            for i in range(first, first + len(children)):
+                nodes[i]["prev_nav"] = preceding
+                if nodes[i]["type"] in NAVIGABLE_TYPES:
+                    preceding = i
+        for i, item in enumerate(children):
+            add_children(first + i, item["items"])
+
+    add_children(0, items)
+    if len(nodes) > MAX_NODES:
+        raise cv.Invalid(f"menu has {len(nodes)} entries, at most {MAX_NODES} are supported")
+    return nodes
+
+
+def _string_array(name, strings):
+    if not strings:
+        return "nullptr", 0
+    body = ", ".join(cpp_string_escape(s) for s in strings)
+    cg.add_global(cg.RawStatement(f"static constexpr const char *{name}[] = {{{body}}};"))
+    return name, len(strings)
+
+
+def _size_report(header, boot, nodes, ids):
+    """Estimate RAM and flash use on the 32-bit target, before and after."""
+    ptr, std_string, heap_overhead = 4, 24, 8
+
+    def heap_string(s):
+        # libstdc++ keeps up to 15 characters inline
+        return 0 if len(s) <= 15 else (len(s) + 1 + 3) // 4 * 4 + heap_overhead
+
+    texts = [n["title"] for n in nodes] + [n["status"] for n in nodes] + header + boot
+    # Header and boot lines as std::vector<std::string>, and MenuTree nodes with two
+    # std::string members plus six int32 links, and an unordered_map id index
+    before = sum(std_string + heap_string(s) for s in header + boot) + 2 * heap_overhead
+    before += sum(2 * std_string + 4 + 6 * 4 + heap_string(n["title"]) + heap_string(n["status"]) for n in nodes)
+    before += sum(std_string + heap_string(i) + 4 + 2 * ptr + heap_overhead for i in ids) + ptr * len(ids)
+    node_bytes = 3 * ptr + 1 + 1 + 8 * 2
+    flash = (len(nodes) * node_bytes + len(ids) * 2 * ptr + (len(header) + len(boot)) * ptr
+             + sum(len(s) + 1 for s in texts) + sum(len(i) + 1 for i in ids))
+    status_nodes = [n for n in nodes if n["status_slot"] >= 0]
+    # MenuTree::StatusSlot: kMaxStatusLength + 1 chars, a length byte and a version
+    after = len(status_nodes) * (33 + 1 + 4 + 2) + heap_overhead
+    _LOGGER.info("Menu tables: %d nodes, %d ids, %d status values; ~%d bytes flash, ~%d bytes RAM "
+                 "(was ~%d bytes of heap)", len(nodes), len(ids), len(status_nodes), flash, after, before)
+
+
+def generate_menu_tables(var, prefix, header, boot, menu):
+    """Emit the tables as globals and hand them to the component; returns the nodes."""
+    nodes = flatten_menu(menu)
+    header_name, header_count = _string_array(f"{prefix}_menu_header", header)
+    boot_name, boot_count = _string_array(f"{prefix}_menu_boot", boot)
+
+    rows = []
+    for n in nodes:
+        menu_id = cpp_string_escape(n["menu_id"]) if n["menu_id"] else "nullptr"
+        rows.append(f"{{{cpp_string_escape(n['title'])}, {menu_id}, {cpp_string_escape(n['status'])}, "
+                    f"MenuEntry::Type::{n['type'].upper()}, {n['parent']}, {n['first_child']}, "
+                    f"{n['child_count']}, {n['next_sibling']}, {n['first_nav']}, {n['next_nav']}, {n['prev_nav']}, "
+                    f"{n['status_slot']}}}")
+    nodes_name = f"{prefix}_menu_nodes"
+    cg.add_global(cg.RawStatement(f"static constexpr MenuNode {nodes_name}[] = {{\n  " + ",\n  ".join(rows) + "};"))
+
+    # Sorted bytewise to match the strcmp binary search in MenuTree::find_id
+    ids = sorted(((n["menu_id"], i) for i, n in enumerate(nodes) if n["menu_id"]), key=lambda e: e[0].encode())
+    ids_name, id_count = "nullptr", 0
+    if ids:
+        ids_name, id_count = f"{prefix}_menu_ids", len(ids)
+        body = ", ".join(f"{{{cpp_string_escape(i)}, {node}}}" for i, node in ids)
+        cg.add_global(cg.RawStatement(f"static constexpr MenuIdIndex {ids_name}[] = {{{body}}};"))
+
+    definition = f"{prefix}_menu"
+    cg.add_global(cg.RawStatement(
+        f"static constexpr MenuDefinition {definition} = {{{header_name}, {header_count}, {boot_name}, "
+        f"{boot_count}, {nodes_name}, {len(nodes)}, {ids_name}, {id_count}}};"))
+    cg.add(var.set_menu_definition(cg.RawExpression(f"&{definition}")))
+    _size_report(header, boot, nodes, [i for i, _ in ids])
+    return nodes
@@ -0,0 +1,66 @@
+#include "menu_tree.h"
+#include <algorithm>
+#include <cstring>
+
+// A menu with nothing in it, until assign() is given the generated tables
+static const MenuNode kEmptyMenu[] = {{"", nullptr, "", MenuEntry::Type::SUBMENU, MenuTree::kNoNode, MenuTree::kNoNode,
+                                       0, MenuTree::kNoNode, MenuTree::kNoNode, MenuTree::kRoot, MenuTree::kRoot,
+                                       MenuTree::kNoNode}};
+
+MenuTree::MenuTree() {
+    assign(kEmptyMenu, 1, nullptr, 0);
+}
+
+void MenuTree::assign(const MenuNode* nodes, size_t node_count, const MenuIdIndex* ids, size_t id_count) {
+    nodes_ = nodes;
+    size_ = node_count;
+    ids_ = ids;
+    id_count_ = id_count;
+    // Only STATUS nodes get a mutable slot; everything else stays in the tables
+    size_t slots = 0;
+    for (size_t i = 0; i < node_count; ++i) {
+        if (nodes[i].status_slot >= 0) slots = std::max(slots, (size_t)nodes[i].status_slot + 1);
+    }
+    status_.assign(slots, StatusSlot());
+    for (size_t i = 0; i < node_count; ++i) {
+        if (nodes[i].status_slot < 0 || nodes[i].status == nullptr) continue;
+        StatusSlot& slot = status_[nodes[i].status_slot];
+        slot.len = std::min(strlen(nodes[i].status), kMaxStatusLength);
+        memcpy(slot.value, nodes[i].status, slot.len);
+        slot.value[slot.len] = '\0';
+        slot.version = 1;
+    }
+}
+
+StatusValue MenuTree::status(int32_t index) const {
+    int16_t slot = nodes_[index].status_slot;
+    if (slot < 0) return {"", 0, 0};
+    const StatusSlot& s = status_[slot];
+    return {s.value, s.len, s.version};
+}
+
+bool MenuTree::set_status(int32_t index, const char* value, size_t len) {
+    int16_t slot = nodes_[index].status_slot;
+    if (slot < 0) return false;
+    StatusSlot& s = status_[slot];
+    len = std::min(len, kMaxStatusLength);
+    if (s.len == len && memcmp(s.value, value, len) == 0) return false;
+    memcpy(s.value, value, len);
+    s.value[len] = '\0';
+    s.len = len;
+    s.version++;
+    for (auto& listener : listeners_) listener(index);
+    return true;
+}
+
+int32_t MenuTree::find_id(const char* id) const {
+    size_t lo = 0, hi = id_count_;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int cmp = strcmp(ids_[mid].id, id);
+        if (cmp == 0) return ids_[mid].node;
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return kNoNode;
+}
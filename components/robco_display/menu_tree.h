@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+// Kinds of menu entry; the generated tables refer to them as MenuEntry::Type
+struct MenuEntry {
+    enum class Type : uint8_t { STATIC, SUBMENU, ACTION, STATUS, LOGS };
+};
+
+
+// One compiled menu node. Links are indices into the node array and -1 marks
+// a missing link. Nodes never change after compilation, so menus generated
+// from YAML stay in flash; live status values are kept by MenuTree.
+struct MenuNode {
+    const char* title;
+    const char* id;        // nullptr if unbound
+    const char* status;    // initial status value
+    MenuEntry::Type type;
+    int16_t parent;
+    int16_t first_child;
+    int16_t child_count;   // children are contiguous from first_child on
+    int16_t next_sibling;
+    int16_t first_navigable_child;
+    // Nearest navigable siblings in each direction, wrapping around; a node
+    // that is the only navigable one in its menu links to itself
+    int16_t next_navigable;
+    int16_t prev_navigable;
+    int16_t status_slot;   // index of the node's live value for STATUS nodes, else -1
+};
+
+// Live value of a STATUS node; version increases on every change
+struct StatusValue {
+    const char* data;
+    size_t len;
+    uint32_t version;
+};
+
+// Entry of the id lookup table, which is sorted by id
+struct MenuIdIndex {
+    const char* id;
+    int16_t node;
+};
+
+// Everything the terminal shows outside live values; generated from YAML as
+// constexpr tables by robco_display/menu_tables.py
+struct MenuDefinition {
+    const char* const* header;
+    size_t header_count;
+    const char* const* boot_messages;
+    size_t boot_message_count;
+    const MenuNode* nodes;
+    size_t node_count;
+    const MenuIdIndex* ids;
+    size_t id_count;
+};
+
+// Flat menu tree. Siblings are stored contiguously, and every link that
+// navigation needs is precomputed, so moving the selection, entering or
+// leaving a submenu are single index loads.
+class MenuTree {
+public:
+    static constexpr int32_t kNoNode = -1;
+    static constexpr int32_t kRoot = 0;   // synthetic node whose children are the top-level menu
+    static constexpr size_t kMaxNodes = INT16_MAX;
+
+    MenuTree();
+    // Use prebuilt tables in place; they must outlive the tree
+    void assign(const MenuNode* nodes, size_t node_count, const MenuIdIndex* ids, size_t id_count);
+    size_t size() const { return size_; }
+    const MenuNode& node(int32_t index) const { return nodes_[index]; }
+    static constexpr size_t kMaxStatusLength = 32;
+
+    bool has_status(int32_t index) const { return nodes_[index].status_slot >= 0; }
+    // Live value of a STATUS node; empty with version 0 for other nodes
+    StatusValue status(int32_t index) const;
+    // Store a value, truncated to kMaxStatusLength, in the node's fixed slot. Returns
+    // true and notifies listeners only if the value changed. Never allocates.
+    bool set_status(int32_t index, const char* value, size_t len);
+    bool set_status(int32_t index, const std::string& value) { return set_status(index, value.data(), value.size()); }
+    size_t status_count() const { return status_.size(); }
+    // Called with the node index after each status change
+    void add_status_listener(std::function<void(int32_t)> listener) { listeners_.push_back(std::move(listener)); }
+    static bool is_navigable(MenuEntry::Type type) {
+        return type == MenuEntry::Type::ACTION || type == MenuEntry::Type::SUBMENU || type == MenuEntry::Type::LOGS;
+    }
+    // Number of direct children, as compiled into the node
+    size_t child_count(int32_t index) const { return (size_t)nodes_[index].child_count; }
+    // Node carrying the given id, or kNoNode; binary search over the id table
+    int32_t find_id(const char* id) const;
+
+private:
+    const MenuNode* nodes_ = nullptr;
+    size_t size_ = 0;
+    const MenuIdIndex* ids_ = nullptr;
+    size_t id_count_ = 0;
+    struct StatusSlot {
+        char value[kMaxStatusLength + 1];
+        uint8_t len;
+        uint32_t version;
+    };
+    std::vector<StatusSlot> status_;
+    std::vector<std::function<void(int32_t)>> listeners_;
+};
@@ -0,0 +1,20 @@
+#include "mqtt_client_transport.h"
+#include "esphome/components/mqtt/mqtt_client.h"
+#include <string>
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        bool MqttClientTransport::is_connected()
+        {
+            return mqtt::global_mqtt_client != nullptr && mqtt::global_mqtt_client->is_connected();
+        }
+
+        bool MqttClientTransport::publish(const char *topic, const char *payload, uint8_t qos)
+        {
+            return mqtt::global_mqtt_client != nullptr &&
+                   mqtt::global_mqtt_client->publish(std::string(topic), std::string(payload), qos, false);
+        }
+    } // namespace robco_display
+} // namespace esphome
@@ -0,0 +1,19 @@
+#ifndef MQTT_CLIENT_TRANSPORT_H
+#define MQTT_CLIENT_TRANSPORT_H
+
+#include "mqtt_outbox.h"
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        // OutboxTransport on ESPHome's global MQTT client; disconnected if there is none
+        class MqttClientTransport : public OutboxTransport
+        {
+        public:
+            bool is_connected() override;
+            bool publish(const char *topic, const char *payload, uint8_t qos) override;
+        };
+    } // namespace robco_display
+} // namespace esphome
+#endif // MQTT_CLIENT_TRANSPORT_H
@@ -0,0 +1,121 @@
+#include "mqtt_outbox.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+constexpr int64_t kRetryBaseUs = 250000;
+constexpr int64_t kRetryMaxUs = 8000000;
+
+void copy_field(char* dst, const char* src) {
+    memcpy(dst, src, strlen(src) + 1);
+}
+} // namespace
+
+bool MqttOutbox::enqueue(const char* topic, const char* payload, const char* ack, int64_t now_us) {
+    if (strlen(topic) > OutboxCommand::kMaxTopic || strlen(payload) > OutboxCommand::kMaxPayload ||
+        strlen(ack) > OutboxCommand::kMaxAck) {
+        return false;
+    }
+    // Only a repeat of the newest command is dropped: matching an older one
+    // would reorder the user's presses, as in Open, Close, Open
+    if (count_ > 0) {
+        const OutboxCommand& newest = at(count_ - 1);
+        if (!newest.sent && strcmp(newest.topic, topic) == 0 && strcmp(newest.payload, payload) == 0) {
+            stats_.deduped++;
+            return true;
+        }
+    }
+    if (count_ == kCapacity) {
+        stats_.dropped++;
+        OutboxCommand oldest = at(0);
+        remove(0);
+        notify(oldest, OutboxEvent::DROPPED);
+    }
+    OutboxCommand& command = at(count_++);
+    copy_field(command.topic, topic);
+    copy_field(command.payload, payload);
+    copy_field(command.ack, ack);
+    command.queued_us = now_us;
+    command.sent_us = 0;
+    command.retry_us = now_us;
+    command.attempts = 0;
+    command.sent = false;
+    stats_.queued++;
+    notify(command, OutboxEvent::QUEUED);
+    return true;
+}
+
+void MqttOutbox::process(int64_t now_us) {
+    // The listener gets copies: it may queue commands, which moves the slots
+    for (size_t i = 0; i < count_;) {
+        OutboxCommand& command = at(i);
+        if (command.sent && now_us - command.sent_us >= ack_timeout_us_) {
+            stats_.unacked++;
+            OutboxCommand done = command;
+            remove(i);
+            notify(done, OutboxEvent::NO_ACK);
+        } else if (!command.sent && now_us - command.queued_us >= expire_us_) {
+            stats_.expired++;
+            OutboxCommand done = command;
+            remove(i);
+            notify(done, OutboxEvent::EXPIRED);
+        } else {
+            ++i;
+        }
+    }
+    if (transport_ == nullptr || !transport_->is_connected()) return;
+
+    // Only the oldest unsent command may go, so commands keep their order
+    size_t next = 0;
+    while (next < count_ && at(next).sent) next++;
+    if (next == count_ || at(next).retry_us > now_us) return;
+    OutboxCommand& command = at(next);
+    if (!transport_->publish(command.topic, command.payload, qos_)) {
+        stats_.retries++;
+        command.attempts = std::min<uint8_t>(command.attempts + 1, 16);
+        command.retry_us = now_us + std::min(kRetryBaseUs << (command.attempts - 1), kRetryMaxUs);
+        return;
+    }
+    stats_.published++;
+    command.sent = true;
+    command.sent_us = now_us;
+    OutboxCommand sent = command;
+    if (command.ack[0] == '\0') remove(next);
+    notify(sent, OutboxEvent::PUBLISHED);
+}
+
+bool MqttOutbox::acknowledge(const char* ack, int64_t now_us, uint32_t* latency_ms) {
+    for (size_t i = 0; i < count_; ++i) {
+        OutboxCommand& command = at(i);
+        if (!command.sent || strcmp(command.ack, ack) != 0) continue;
+        uint32_t ms = (uint32_t)((now_us - command.queued_us) / 1000);
+        stats_.acked++;
+        stats_.max_ack_ms = std::max(stats_.max_ack_ms, ms);
+        if (latency_ms != nullptr) *latency_ms = ms;
+        OutboxCommand done = command;
+        remove(i);
+        notify(done, OutboxEvent::ACKED, ms);
+        return true;
+    }
+    return false;
+}
+
+OutboxStats MqttOutbox::take_stats() {
+    OutboxStats stats = stats_;
+    stats_ = OutboxStats();
+    return stats;
+}
+
+void MqttOutbox::remove(size_t i) {
+    if (i == 0) {
+        first_ = (first_ + 1) % kCapacity;
+    } else {
+        // Shift the newer commands down; the outbox holds a handful at most
+        for (; i + 1 < count_; ++i) at(i) = at(i + 1);
+    }
+    count_--;
+}
+
+void MqttOutbox::notify(const OutboxCommand& command, OutboxEvent event, uint32_t ms) {
+    if (listener_) listener_(command, event, ms);
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+
+// Where an MqttOutbox sends its commands
+class OutboxTransport {
+public:
+    virtual ~OutboxTransport() = default;
+    virtual bool is_connected() = 0;
+    // False if the client did not take the message; the outbox retries later
+    virtual bool publish(const char* topic, const char* payload, uint8_t qos) = 0;
+};
+
+struct OutboxStats {
+    uint32_t queued = 0;
+    uint32_t deduped = 0;        // repeats of the newest command before it was sent
+    uint32_t published = 0;
+    uint32_t retries = 0;        // publishes the client refused
+    uint32_t acked = 0;
+    uint32_t unacked = 0;        // published, but no reply within the ack timeout
+    uint32_t expired = 0;        // never published before the expiry
+    uint32_t dropped = 0;        // oldest commands pushed out of a full outbox
+    uint32_t max_ack_ms = 0;
+};
+
+enum class OutboxEvent : uint8_t {
+    QUEUED,
+    PUBLISHED,
+    ACKED,
+    NO_ACK,
+    EXPIRED,
+    DROPPED,
+};
+
+struct OutboxCommand {
+    static constexpr size_t kMaxTopic = 63;
+    static constexpr size_t kMaxPayload = 63;
+    static constexpr size_t kMaxAck = 15;
+
+    char topic[kMaxTopic + 1];
+    char payload[kMaxPayload + 1];
+    // State update that confirms the command; empty if none is expected
+    char ack[kMaxAck + 1];
+    int64_t queued_us;
+    int64_t sent_us;
+    int64_t retry_us;
+    uint8_t attempts;
+    bool sent;
+};
+
+// Bounded queue of MQTT commands published from the main loop instead of the
+// input handler. Commands go out one per process() call and in the order they
+// were queued; while the client is disconnected or refuses a publish they wait,
+// with a growing retry delay, until they expire. Repeating the newest command
+// before it has gone out does not queue it twice. Delivery to the broker is left to the client's QoS; a
+// command is done once the state update named by its ack arrives, and the time
+// from queueing to that update is its ack latency.
+//
+// All storage is fixed; nothing is kept across a reboot.
+class MqttOutbox {
+public:
+    static constexpr size_t kCapacity = 8;
+
+    void set_transport(OutboxTransport* transport) { transport_ = transport; }
+    void set_qos(uint8_t qos) { qos_ = qos; }
+    void set_expire_us(int64_t us) { expire_us_ = us; }
+    void set_ack_timeout_us(int64_t us) { ack_timeout_us_ = us; }
+    // Called for every state change of a command; ms is the ack latency for ACKED
+    using Listener = std::function<void(const OutboxCommand& command, OutboxEvent event, uint32_t ms)>;
+    void set_listener(Listener listener) { listener_ = std::move(listener); }
+
+    // False if a field is too long; a full outbox drops its oldest command
+    bool enqueue(const char* topic, const char* payload, const char* ack, int64_t now_us);
+    // Expire stale commands and publish the next one that is due
+    void process(int64_t now_us);
+    // Complete the oldest published command waiting for this ack; false if none is
+    bool acknowledge(const char* ack, int64_t now_us, uint32_t* latency_ms = nullptr);
+
+    size_t size() const { return count_; }
+    // Return the counters gathered since the last call and reset them
+    OutboxStats take_stats();
+
+private:
+    OutboxCommand& at(size_t i) { return commands_[(first_ + i) % kCapacity]; }
+    void remove(size_t i);
+    void notify(const OutboxCommand& command, OutboxEvent event, uint32_t ms = 0);
+
+    OutboxTransport* transport_ = nullptr;
+    Listener listener_;
+    uint8_t qos_ = 1;
+    int64_t expire_us_ = 60 * 1000000LL;
+    int64_t ack_timeout_us_ = 10 * 1000000LL;
+    OutboxCommand commands_[kCapacity];
+    size_t first_ = 0;
+    size_t count_ = 0;
+    OutboxStats stats_;
+};
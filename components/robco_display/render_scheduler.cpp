@@ -0,0 +1,45 @@
+#include "render_scheduler.h"
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        void RenderScheduler::request()
+        {
+            stats_.requests++;
+            if (pending_)
+                stats_.coalesced++;
+            pending_ = true;
+        }
+
+        bool RenderScheduler::should_render(int64_t now_us) const
+        {
+            return pending_ && now_us - last_render_us_ >= frame_interval_us_;
+        }
+
+        void RenderScheduler::begin_render(int64_t now_us)
+        {
+            // Cleared before rendering so requests raised while drawing schedule the next frame
+            pending_ = false;
+            last_render_us_ = now_us;
+            render_start_us_ = now_us;
+        }
+
+        void RenderScheduler::end_render(int64_t now_us)
+        {
+            uint32_t elapsed = (uint32_t)(now_us - render_start_us_);
+            stats_.renders++;
+            if (elapsed > stats_.max_render_us)
+                stats_.max_render_us = elapsed;
+            if (elapsed > frame_interval_us_)
+                stats_.over_budget++;
+        }
+
+        RenderStats RenderScheduler::take_stats()
+        {
+            RenderStats stats = stats_;
+            stats_ = RenderStats();
+            return stats;
+        }
+    } // namespace robco_display
+} // namespace esphome
@@ -0,0 +1,46 @@
+#ifndef RENDER_SCHEDULER_H
+#define RENDER_SCHEDULER_H
+
+#include <cstdint>
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        struct RenderStats
+        {
+            uint32_t requests = 0;      // render requests made by input, MQTT, timers
+            uint32_t renders = 0;       // renders actually performed
+            uint32_t coalesced = 0;     // requests folded into an already pending render
+            uint32_t over_budget = 0;   // renders that took longer than one frame interval
+            uint32_t max_render_us = 0; // worst-case render time
+        };
+
+        // Collects render requests and releases at most one render per frame
+        // interval, so a burst of key presses or MQTT messages costs one render.
+        class RenderScheduler
+        {
+        public:
+            void set_frame_interval_us(uint32_t us) { frame_interval_us_ = us; }
+            uint32_t get_frame_interval_us() const { return frame_interval_us_; }
+
+            void request();
+            bool is_pending() const { return pending_; }
+            // True when a render is pending and the frame interval has elapsed
+            bool should_render(int64_t now_us) const;
+            void begin_render(int64_t now_us);
+            void end_render(int64_t now_us);
+
+            // Return the counters gathered since the last call and reset them
+            RenderStats take_stats();
+
+        private:
+            uint32_t frame_interval_us_ = 40000;
+            bool pending_ = false;
+            int64_t last_render_us_ = INT64_MIN / 2;
+            int64_t render_start_us_ = 0;
+            RenderStats stats_;
+        };
+    } // namespace robco_display
+} // namespace esphome
+#endif // RENDER_SCHEDULER_H
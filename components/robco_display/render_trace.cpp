@@ -0,0 +1,70 @@
+#include "render_trace.h"
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        uint32_t TraceSummary::percentile_us(uint8_t pct) const
+        {
+            if (count == 0)
+                return 0;
+            uint32_t target = (uint32_t)(((uint64_t)count * pct + 99) / 100);
+            uint32_t seen = 0;
+            for (size_t i = 0; i < NUM_BUCKETS; ++i)
+            {
+                seen += buckets[i];
+                if (seen >= target)
+                    return i == NUM_BUCKETS - 1 ? peak_us : 1u << i;
+            }
+            return peak_us;
+        }
+
+        void TraceHistogram::take(TraceHistogram &base, TraceSummary &summary) const
+        {
+            // Unsigned deltas stay correct across 32-bit wraparound between takes
+            for (size_t i = 0; i < NUM_BUCKETS; ++i)
+            {
+                uint32_t now = buckets_[i].load(std::memory_order_relaxed);
+                summary.buckets[i] += now - base.buckets_[i].load(std::memory_order_relaxed);
+                base.buckets_[i].store(now, std::memory_order_relaxed);
+            }
+            uint32_t count = count_.load(std::memory_order_relaxed);
+            summary.count += count - base.count_.load(std::memory_order_relaxed);
+            base.count_.store(count, std::memory_order_relaxed);
+            uint32_t total = total_cycles_.load(std::memory_order_relaxed);
+            summary.total_us += (total - base.total_cycles_.load(std::memory_order_relaxed)) / CPU_MHZ;
+            base.total_cycles_.store(total, std::memory_order_relaxed);
+            summary.peak_us = this->peak_us();
+        }
+
+        TraceSummary RenderTrace::take(TraceStage stage, RenderTrace &base) const
+        {
+            TraceSummary summary;
+            this->stages_[(size_t)stage].take(base.stages_[(size_t)stage], summary);
+            return summary;
+        }
+
+        const char *RenderTrace::stage_name(TraceStage stage)
+        {
+            switch (stage)
+            {
+            case TraceStage::KEY:
+                return "key";
+            case TraceStage::VIEW:
+                return "view";
+            case TraceStage::SNAPSHOT:
+                return "snapshot";
+            case TraceStage::LOCK_WAIT:
+                return "lock wait";
+            case TraceStage::DRAW:
+                return "draw";
+            case TraceStage::FLUSH:
+                return "flush";
+            case TraceStage::KEY_TO_DRAW:
+                return "key to draw";
+            default:
+                return "?";
+            }
+        }
+    } // namespace robco_display
+} // namespace esphome
@@ -0,0 +1,127 @@
+#ifndef RENDER_TRACE_H
+#define RENDER_TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        // Stages of the path from a key press to pixels on the panel
+        enum class TraceStage : uint8_t
+        {
+            KEY,         // on_key_press: input handling and the menu state update
+            VIEW,        // MenuState::update_view: composing the changed lines
+            SNAPSHOT,    // render_menu after the view: copying lines and queueing them
+            LOCK_WAIT,   // render task waiting for the LVGL lock
+            DRAW,        // render task: scrolling, writing lines and drawing cells
+            FLUSH,       // LVGL handing one area to the panel, or present() drawing the cell grid
+            KEY_TO_DRAW, // key press until the render task has drawn its result
+            COUNT,
+        };
+
+        // Counts, total and percentiles of one stage over a window
+        struct TraceSummary
+        {
+            static constexpr size_t NUM_BUCKETS = 16;
+            uint32_t count = 0;
+            uint64_t total_us = 0;
+            uint32_t peak_us = 0; // since boot, not just this window
+            uint32_t buckets[NUM_BUCKETS] = {};
+            // Upper bound of the bucket holding the given percentile (0-100)
+            uint32_t percentile_us(uint8_t pct) const;
+            uint32_t avg_us() const { return count > 0 ? (uint32_t)(total_us / count) : 0; }
+        };
+
+        // Log2 histogram of durations measured with the CPU cycle counter. Bucket 0
+        // holds durations under 1 us, bucket i those from 2^(i-1) us up to 2^i us.
+        // Counters only grow, so any number of readers can take deltas without
+        // resetting anything. Each histogram has a single writer task, which
+        // updates it with plain loads and stores.
+        class TraceHistogram
+        {
+        public:
+            static constexpr size_t NUM_BUCKETS = TraceSummary::NUM_BUCKETS;
+            static constexpr uint32_t CPU_MHZ = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+
+            void record(uint32_t cycles)
+            {
+                uint32_t us = cycles / CPU_MHZ;
+                size_t bucket = us == 0 ? 0 : 32 - __builtin_clz(us);
+                if (bucket >= NUM_BUCKETS)
+                    bucket = NUM_BUCKETS - 1;
+                bump(buckets_[bucket], 1);
+                bump(count_, 1);
+                bump(total_cycles_, cycles);
+                if (cycles > peak_cycles_.load(std::memory_order_relaxed))
+                    peak_cycles_.store(cycles, std::memory_order_relaxed);
+            }
+            // Add what was recorded since base to summary and move base forward
+            void take(TraceHistogram &base, TraceSummary &summary) const;
+            uint32_t peak_us() const { return peak_cycles_.load(std::memory_order_relaxed) / CPU_MHZ; }
+
+        private:
+            static void bump(std::atomic<uint32_t> &counter, uint32_t n)
+            {
+                counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+
+            std::atomic<uint32_t> buckets_[NUM_BUCKETS] = {};
+            std::atomic<uint32_t> count_{0};
+            // Wraps after 2^32 cycles (18 s at 240 MHz) of time in one stage between two takes
+            std::atomic<uint32_t> total_cycles_{0};
+            std::atomic<uint32_t> peak_cycles_{0};
+        };
+
+        // Always-on timing of the render pipeline: a pair of cycle counter reads
+        // and a handful of stores per measured stage, no heap and no locks.
+        class RenderTrace
+        {
+        public:
+            static constexpr size_t NUM_STAGES = (size_t)TraceStage::COUNT;
+
+            void set_enabled(bool enabled) { enabled_ = enabled; }
+            bool enabled() const { return enabled_; }
+            static uint32_t now() { return esp_cpu_get_cycle_count(); }
+            void record(TraceStage stage, uint32_t cycles) { stages_[(size_t)stage].record(cycles); }
+            void record_since(TraceStage stage, uint32_t start) { record(stage, now() - start); }
+            // Summary of what was recorded since base; base then holds the current counts
+            TraceSummary take(TraceStage stage, RenderTrace &base) const;
+            uint32_t peak_us(TraceStage stage) const { return stages_[(size_t)stage].peak_us(); }
+            static const char *stage_name(TraceStage stage);
+
+        private:
+            TraceHistogram stages_[NUM_STAGES];
+            bool enabled_ = true;
+        };
+
+        // Records the lifetime of the scope as one sample of a stage
+        class TraceScope
+        {
+        public:
+            TraceScope(RenderTrace &trace, TraceStage stage) : trace_(trace), stage_(stage), active_(trace.enabled())
+            {
+                if (active_)
+                    start_ = RenderTrace::now();
+            }
+            ~TraceScope()
+            {
+                if (active_)
+                    trace_.record_since(stage_, start_);
+            }
+            TraceScope(const TraceScope &) = delete;
+            TraceScope &operator=(const TraceScope &) = delete;
+
+        private:
+            RenderTrace &trace_;
+            TraceStage stage_;
+            bool active_;
+            uint32_t start_ = 0;
+        };
+    } // namespace robco_display
+} // namespace esphome
+#endif // RENDER_TRACE_H
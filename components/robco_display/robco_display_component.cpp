@@ -3,6 +3,9 @@
 #include "esphome/core/log.h"
 #include "esp_timer.h"
 #include "esphome/components/mqtt/mqtt_client.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 namespace esphome
 {
@@ -29,19 +32,27 @@ namespace esphome
 
         void RobcoDisplayComponent::on_key_press(uint8_t keycode, uint8_t modifiers)
         {
+            TraceScope trace(crt_renderer.get_trace(), TraceStage::KEY);
+            if (pending_input_us_ == 0)
+                pending_input_us_ = esp_timer_get_time();
             ESP_LOGI(TAG, "RobcoDisplay received key press: code=0x%02X, modifiers=0x%02X", keycode, modifiers);
-            // Save previous menu stack and selected index
-            int prev_selected = menu_state_.get_selected_index();
-            std::vector<MenuEntry> *current_menu = &menu_;
-            const auto &menu_stack = menu_state_.get_menu_stack();
-            for (size_t i = 0; i < menu_stack.size(); ++i)
-            {
-                int idx = menu_stack[i];
-                if (idx >= 0 && idx < current_menu->size())
-                {
-                    current_menu = &(*current_menu)[idx].subitems;
-                }
+            // The terminal is output only; Esc returns to the menu
+            if (crt_renderer.terminal_active())
+            {
+                pending_input_us_ = 0;
+                if (keycode == 0x29)
+                    exit_terminal();
+                return;
+            }
+            // The first key press during the boot typing finishes it; the next one leaves boot
+            if (boot_reveal_.active())
+            {
+                boot_reveal_.finish();
+                menu_state_.set_boot_visible_chars(SIZE_MAX);
+                request_render();
+                return;
             }
+            int32_t prev_selected = menu_state_.get_selected_node();
             // Password entry mode
             if (menu_state_.is_password_entry_mode())
             {
@@ -52,9 +63,13 @@ namespace esphome
                 else if (keycode == 0x28)
                 { // Enter
                     std::string password = menu_state_.get_password();
-                    // Send MQTT with password as payload
-                    ESP_LOGI(TAG, "Sending MQTT open with password: %s", password.c_str());
-                    esphome::mqtt::global_mqtt_client->publish("garage/door/open", password, 0, false);
+                    // Queued with the password as payload; loop() publishes it
+                    ESP_LOGI(TAG, "Queueing vault door open command");
+                    if (!outbox_.enqueue("garage/door/open", password.c_str(), "opened", esp_timer_get_time()))
+                    {
+                        ESP_LOGE(TAG, "Password too long for a door command");
+                        set_menu_status("door_status", "Not sent");
+                    }
                     blink_active_ = green_light_pin_;
                     blink_start_ms_ = get_millis();
                     last_blink_ms_ = get_millis();
@@ -72,30 +87,17 @@ namespace esphome
                     char c = (keycode == 0x27) ? '0' : '1' + (keycode - 0x1E);
                     menu_state_.append_password_char(c);
                 }
-                render_menu();
+                request_render();
                 return;
             }
-            // Check if action is triggered
-            if (keycode == 0x28 && prev_selected >= 0 && prev_selected < current_menu->size())
+            // Run the handler bound to the selected entry
+            if (keycode == 0x28 && prev_selected != MenuTree::kNoNode && (size_t)prev_selected < actions_.size() &&
+                actions_[prev_selected])
             {
-                const auto &entry = (*current_menu)[prev_selected];
-                if (entry.title == "Open Vault Door")
-                {
-                    menu_state_.start_password_entry("Enter password to open vault door:");
-                }
-                else if (entry.title == "Close Vault Door")
-                {
-                    ESP_LOGI(TAG, "Closing vault door");
-                    esphome::mqtt::global_mqtt_client->publish("garage/door/close", std::string(""), 0, false);
-                    blink_active_ = red_light_pin_;
-                    blink_start_ms_ = get_millis();
-                    last_blink_ms_ = get_millis();
-                    led_state_ = false;
-                    set_pin(blink_active_, 0);
-                }
+                actions_[prev_selected]();
             }
             menu_state_.on_key_press(keycode);
-            render_menu();
+            request_render();
         }
 
         void RobcoDisplayComponent::set_pin(uint8_t pin, bool state)
@@ -106,17 +108,9 @@ namespace esphome
 
         void RobcoDisplayComponent::setup()
         {
-            // Header lines to display across all menus
-            std::vector<std::string> header_lines = {
-                "        ROBCO INDUSTRIES UNIFIED OPERATING SYSTEM",
-                "           COPYRIGHT 2075-2077 ROBCO INDUSTRIES",
-                "",
-                "                        -Server 1-",
-                "Welcome, Overseer.",
-                "------------------"};
-            menu_state_.set_header(header_lines);
             ESP_LOGI(TAG, "Setting up RobcoDisplayComponent");
             crt_renderer.init();
+            crt_renderer.start_render_task(task_core_);
             const gpio_config_t bk_light = {
                 .pin_bit_mask = (1 << BSP_LCD_GPIO_BK_LIGHT),
                 .mode = GPIO_MODE_OUTPUT,
@@ -126,54 +120,217 @@ namespace esphome
             };
             ESP_ERROR_CHECK(gpio_config(&bk_light));
             gpio_set_level(BSP_LCD_GPIO_BK_LIGHT, BSP_LCD_BK_LIGHT_ON_LEVEL);
-            // Boot messages from robco_terminal.cpp
-            std::vector<std::string> boot_msgs = {
-                "RobCo Industries (TM) Termlink Protocol",
-                "Established 2075",
-                "",
-                "VAULT-TEC TERMINAL SYSTEM",
-                "Initializing...",
-                "",
-                "Boot Sequence Started",
-                "Loading System Drivers...",
-                "Checking Memory Banks...",
-                "Network Interface: ONLINE",
-                "Security Protocols: ACTIVE",
-                "",
-                "System Status: NOMINAL",
-                "Security Level: AUTHORIZED",
-                "Access Level: OVERSEER",
-                "",
-                "Welcome to RobCo Termlink",
-                "Have a Nice Day!",
-                "",
-                "> Press any key to continue..."};
-            menu_state_.set_boot_messages(boot_msgs);
-            // Menu structure
-            menu_ = {
-                {"", MenuEntry::Type::STATIC, {}, {}, ""},
-                {"Vault Door Control", MenuEntry::Type::SUBMENU, {
-                    {"Open Vault Door", MenuEntry::Type::ACTION, {}, {}, ""},
-                    {"", MenuEntry::Type::STATIC, {}, {}, ""},
-                    {"Close Vault Door", MenuEntry::Type::ACTION, {}, {}, ""}}, {}, ""},
-                {"", MenuEntry::Type::STATIC, {}, {}, ""},
-                {"System Status", MenuEntry::Type::SUBMENU, {{"Power: Stable", MenuEntry::Type::STATIC, {}, {}, ""}, {"", MenuEntry::Type::STATIC, {}, {}, ""}, {"Door", MenuEntry::Type::STATUS, {}, {}, vault_door_state_}, {"", MenuEntry::Type::STATIC, {}, {}, ""}, {"Security: Nominal", MenuEntry::Type::STATIC, {}, {}, ""}}, {}, ""},
-                {"", MenuEntry::Type::STATIC, {}, {}, ""},
-                {"Overseer Logs", MenuEntry::Type::SUBMENU, {
-                    {"CORRUPTED MEMORY BANK", MenuEntry::Type::STATIC, {}, {}, ""},
-                    {"##??DATA ERROR??##", MenuEntry::Type::STATIC, {}, {}, ""},
-                    {"@!X1Z!@#%$*", MenuEntry::Type::STATIC, {}, {}, ""},
-                    {"??ERROR??", MenuEntry::Type::STATIC, {}, {}, ""},
-                    {"DATA_CORRUPT A9!B7#C", MenuEntry::Type::STATIC, {}, {}, ""}
-                }, {}, ""},
-                {"", MenuEntry::Type::STATIC, {}, {}, ""},
-            };
-            menu_state_.set_menu(menu_);
-            render_menu();
+            if (menu_definition_ != nullptr)
+                menu_state_.set_definition(*menu_definition_);
+            else
+                ESP_LOGE(TAG, "No menu definition set");
+            menu_state_.set_screen_lines(crt_renderer.get_num_lines());
+            if (!log_partition_label_.empty())
+            {
+                if (log_partition_.open(log_partition_label_.c_str()) && log_store_.mount(&log_partition_))
+                {
+                    menu_state_.set_log_store(&log_store_);
+                    ESP_LOGI(TAG, "Log store: %u entries in partition '%s' (%u KB), %u damaged sectors skipped",
+                             (unsigned)log_store_.count(), log_partition_.label(),
+                             (unsigned)(log_partition_.size() / 1024), (unsigned)log_store_.stats().torn);
+                }
+                else
+                {
+                    ESP_LOGE(TAG, "Log partition '%s' is missing or too small, logs are disabled",
+                             log_partition_label_.c_str());
+                }
+            }
+            outbox_.set_transport(&mqtt_transport_);
+            outbox_.set_listener([this](const OutboxCommand &command, OutboxEvent event, uint32_t ms)
+                                 { on_command_event(command, event); });
+            boot_reveal_.start(menu_state_.get_boot_text_length(), esp_timer_get_time());
+            if (boot_reveal_.active())
+                menu_state_.set_boot_visible_chars(0);
+            add_menu_action("open_vault_door", [this]()
+                            { menu_state_.start_password_entry("Enter password to open vault door:"); });
+            add_menu_action("close_vault_door", [this]()
+                            { close_vault_door(); });
+            if (!terminal_menu_id_.empty())
+                add_menu_action(terminal_menu_id_, [this]()
+                                { enter_terminal(); });
+            bind_menu_actions();
+            subscribe_status_topics();
+            subscribe_terminal_topic();
+            request_render();
+        }
+
+        void RobcoDisplayComponent::subscribe_status_topics()
+        {
+            const StatusBindingTable *table = status_bindings_.table();
+            if (table == nullptr)
+                return;
+            if (mqtt::global_mqtt_client == nullptr)
+            {
+                ESP_LOGE(TAG, "Status bindings need the mqtt component");
+                return;
+            }
+            for (size_t i = 0; i < table->subscription_count; ++i)
+            {
+                mqtt::global_mqtt_client->subscribe(table->subscriptions[i],
+                                                    [this](const std::string &topic, const std::string &payload)
+                                                    { on_status_message(topic, payload); });
+            }
+            ESP_LOGI(TAG, "Status bindings: %u topics, %u subscriptions", (unsigned)table->binding_count,
+                     (unsigned)table->subscription_count);
+        }
+
+        bool RobcoDisplayComponent::on_status_message(const std::string &topic, const std::string &payload)
+        {
+            status_messages_++;
+            const StatusBinding *binding = status_bindings_.find(topic.data(), topic.size());
+            if (binding == nullptr)
+            {
+                // Expected with wildcard subscriptions that cover more than the bound topics
+                status_unbound_++;
+                return false;
+            }
+            char text[MenuTree::kMaxStatusLength + 1];
+            size_t len = status_bindings_.format(*binding, payload.data(), payload.size(), text, sizeof(text));
+            if (menu_state_.get_menu_tree().set_status(binding->node, text, len) && !status_render_pending_)
+            {
+                status_render_pending_ = true;
+                status_render_due_us_ = esp_timer_get_time() + status_batch_window_us_;
+            }
+            return true;
+        }
+
+        void RobcoDisplayComponent::subscribe_terminal_topic()
+        {
+            if (terminal_topic_.empty())
+                return;
+            if (mqtt::global_mqtt_client == nullptr)
+            {
+                ESP_LOGE(TAG, "Terminal topic needs the mqtt component");
+                return;
+            }
+            mqtt::global_mqtt_client->subscribe(terminal_topic_, [this](const std::string &topic, const std::string &payload)
+                                                { write_terminal(payload); });
+        }
+
+        void RobcoDisplayComponent::enter_terminal()
+        {
+            if (!crt_renderer.begin_terminal())
+            {
+                ESP_LOGW(TAG, "Terminal mode needs the cell grid renderer");
+                return;
+            }
+            ESP_LOGI(TAG, "Terminal opened");
+        }
+
+        // The grid still holds the terminal's cells; rewriting every menu line
+        // redraws only those that differ
+        void RobcoDisplayComponent::exit_terminal()
+        {
+            if (!crt_renderer.terminal_active())
+                return;
+            crt_renderer.end_terminal();
+            menu_state_.mark_lines_dirty((1u << ScreenSnapshot::MAX_LINES) - 1);
+            request_render();
+            ESP_LOGI(TAG, "Terminal closed");
+        }
+
+        void RobcoDisplayComponent::close_vault_door()
+        {
+            ESP_LOGI(TAG, "Queueing vault door close command");
+            outbox_.enqueue("garage/door/close", "", "closed", esp_timer_get_time());
+            blink_active_ = red_light_pin_;
+            blink_start_ms_ = get_millis();
+            last_blink_ms_ = get_millis();
+            led_state_ = false;
+            set_pin(blink_active_, 0);
+        }
+
+        // Door commands report their progress in the door status line until the state arrives
+        void RobcoDisplayComponent::on_command_event(const OutboxCommand &command, OutboxEvent event)
+        {
+            const char *status = nullptr;
+            switch (event)
+            {
+            case OutboxEvent::QUEUED:
+                status = mqtt_transport_.is_connected() ? "Sending" : "Queued (offline)";
+                break;
+            case OutboxEvent::PUBLISHED:
+                ESP_LOGD(TAG, "Published %s after %u attempts", command.topic, (unsigned)command.attempts + 1);
+                if (command.ack[0] != '\0')
+                    status = "Sent";
+                break;
+            case OutboxEvent::NO_ACK:
+                ESP_LOGW(TAG, "No '%s' state after publishing %s", command.ack, command.topic);
+                status = "No reply";
+                break;
+            case OutboxEvent::EXPIRED:
+                ESP_LOGW(TAG, "Gave up on %s, MQTT stayed disconnected", command.topic);
+                status = "Not sent";
+                break;
+            case OutboxEvent::DROPPED:
+                ESP_LOGW(TAG, "Command outbox full, dropped %s", command.topic);
+                break;
+            case OutboxEvent::ACKED:
+                // set_vault_door_state() shows the state with the latency
+                break;
+            }
+            if (status != nullptr)
+                set_menu_status("door_status", status);
+        }
+
+        void RobcoDisplayComponent::add_menu_action(const std::string &id, std::function<void()> handler)
+        {
+            action_bindings_.emplace_back(id, std::move(handler));
+        }
+
+        // Resolve action ids to node indices once, so activating an entry is a table load
+        void RobcoDisplayComponent::bind_menu_actions()
+        {
+            const MenuTree &tree = menu_state_.get_menu_tree();
+            actions_.assign(tree.size(), nullptr);
+            for (auto &binding : action_bindings_)
+            {
+                int32_t node = tree.find_id(binding.first.c_str());
+                if (node == MenuTree::kNoNode)
+                {
+                    ESP_LOGW(TAG, "No menu entry with id '%s' for action", binding.first.c_str());
+                    continue;
+                }
+                std::function<void()> &slot = actions_[node];
+                if (slot)
+                    slot = [first = std::move(slot), second = std::move(binding.second)]()
+                    {
+                        first();
+                        second();
+                    };
+                else
+                    slot = std::move(binding.second);
+            }
+            action_bindings_.clear();
+        }
+
+        bool RobcoDisplayComponent::set_menu_status(const std::string &id, const std::string &value)
+        {
+            MenuTree &tree = menu_state_.get_menu_tree();
+            int32_t node = tree.find_id(id.c_str());
+            if (node == MenuTree::kNoNode)
+                return false;
+            if (!tree.has_status(node))
+                return false;
+            if (tree.set_status(node, value))
+                request_render();
+            return true;
+        }
+        void RobcoDisplayComponent::add_log(const std::string &entry)
+        {
+            menu_state_.add_log(entry);
+            request_render();
         }
         void RobcoDisplayComponent::set_vault_door_state(const std::string &state)
         {
             ESP_LOGI(TAG, "MQTT update received: vault_door_state='%s'", state.c_str());
+            uint32_t ack_ms = 0;
+            bool acked = outbox_.acknowledge(state.c_str(), esp_timer_get_time(), &ack_ms);
             std::string formatted_state = state;
             if (state == "opened")
             {
@@ -183,39 +340,175 @@ namespace esphome
             {
                 formatted_state = "Closed";
             }
-            vault_door_state_ = formatted_state;
-            bool found = false;
-            for (auto &entry : menu_)
+            if (acked)
             {
-                if (entry.title == "System Status" && !entry.subitems.empty())
-                {
-                    for (auto &sub : entry.subitems)
-                    {
-                        if (sub.title.find("Door") != std::string::npos)
-                        {
-                            ESP_LOGI(TAG, "Updating menu entry '%s' with state '%s'", sub.title.c_str(), state.c_str());
-                            // Replace 'Unknown' with 'Closed' or 'Opened' in the title if present
-                            if (sub.title.find("Unknown") != std::string::npos)
-                            {
-                                sub.title = "Door";
-                            }
-                            sub.status_value = formatted_state;
-                            found = true;
-                        }
-                    }
-                }
+                ESP_LOGI(TAG, "Door command confirmed after %u ms", (unsigned)ack_ms);
+                formatted_state += " (" + std::to_string(ack_ms) + " ms)";
             }
-            if (!found)
+            if (!set_menu_status("door_status", formatted_state))
             {
-                ESP_LOGW(TAG, "Could not find 'Door' entry in System Status menu to update");
+                ESP_LOGW(TAG, "Could not find menu entry 'door_status' to update");
             }
-            menu_state_.set_menu(menu_);
-            render_menu();
+        }
+
+        void RobcoDisplayComponent::request_render()
+        {
+            render_scheduler_.request();
         }
 
         void RobcoDisplayComponent::loop()
         {
+            int64_t now_us = esp_timer_get_time();
+            if (boot_reveal_.is_due(now_us))
+                request_render();
+            // Before rendering, so a status change it makes shows this frame
+            outbox_.process(now_us);
+            if (status_render_pending_ && now_us >= status_render_due_us_)
+            {
+                status_render_pending_ = false;
+                status_renders_++;
+                request_render();
+            }
+            // While the terminal is open, requests wait and the menu is drawn once it closes
+            if (!crt_renderer.terminal_active() && render_scheduler_.should_render(now_us))
+            {
+                render_scheduler_.begin_render(now_us);
+                bool revealing = boot_reveal_.active();
+                if (revealing)
+                    menu_state_.set_boot_visible_chars(boot_reveal_.advance(now_us));
+                render_menu();
+                int64_t end_us = esp_timer_get_time();
+                render_scheduler_.end_render(end_us);
+                if (revealing)
+                {
+                    boot_reveal_.end_tick((uint32_t)(end_us - now_us));
+                    if (!boot_reveal_.active())
+                        log_reveal_stats();
+                }
+            }
             handle_blink();
+            log_flush_stats();
+            publish_trace();
+        }
+
+        void RobcoDisplayComponent::log_flush_stats()
+        {
+            uint32_t now = get_millis();
+            if (now - last_stats_log_ms_ < 10000)
+                return;
+            last_stats_log_ms_ = now;
+            RenderStats render = render_scheduler_.take_stats();
+            if (render.requests > 0)
+            {
+                ESP_LOGI(TAG, "Render: %u requests, %u renders, %u coalesced, %u over %u us budget, worst %u us",
+                         (unsigned)render.requests, (unsigned)render.renders, (unsigned)render.coalesced,
+                         (unsigned)render.over_budget, (unsigned)render_scheduler_.get_frame_interval_us(),
+                         (unsigned)render.max_render_us);
+            }
+            OutboxStats commands = outbox_.take_stats();
+            if (commands.queued > 0 || commands.acked > 0 || commands.unacked > 0 || commands.expired > 0)
+            {
+                ESP_LOGI(TAG, "Commands: %u queued, %u deduped, %u published, %u retries, %u acked (worst %u ms), %u unacked, %u expired, %u dropped, %u waiting",
+                         (unsigned)commands.queued, (unsigned)commands.deduped, (unsigned)commands.published,
+                         (unsigned)commands.retries, (unsigned)commands.acked, (unsigned)commands.max_ack_ms,
+                         (unsigned)commands.unacked, (unsigned)commands.expired, (unsigned)commands.dropped,
+                         (unsigned)outbox_.size());
+            }
+            if (status_messages_ > 0)
+            {
+                ESP_LOGI(TAG, "Status: %u MQTT messages, %u unbound, %u renders", (unsigned)status_messages_,
+                         (unsigned)status_unbound_, (unsigned)status_renders_);
+                status_messages_ = status_unbound_ = status_renders_ = 0;
+            }
+            TerminalStats terminal = crt_renderer.take_terminal_stats();
+            if (terminal.bytes > 0 || terminal.dropped > 0)
+            {
+                ESP_LOGI(TAG, "Terminal: %u bytes (%u B/s), %u dropped, parse %u us, %u cells drawn, %u unsupported sequences",
+                         (unsigned)terminal.bytes, (unsigned)(terminal.bytes / 10), (unsigned)terminal.dropped,
+                         (unsigned)terminal.parse_us, (unsigned)terminal.cells, (unsigned)terminal.unsupported);
+            }
+            RenderTaskStats task = crt_renderer.take_task_stats();
+            if (task.snapshots > 0 || task.dropped > 0)
+            {
+                ESP_LOGI(TAG, "Render task: %u snapshots, %u dropped, lock wait %u us (max %u us), queue high-water %u",
+                         (unsigned)task.snapshots, (unsigned)task.dropped, (unsigned)task.lock_wait_us,
+                         (unsigned)task.max_lock_wait_us, (unsigned)task.queue_high_water);
+            }
+            if (crt_renderer.scanout_active())
+            {
+                ScanoutStats scan = crt_renderer.take_scanout_stats();
+                ESP_LOGI(TAG, "Scanout: %u frames, %u fills, %u ns/line avg, %u ns/line worst, %u ns/line budget, %u overruns",
+                         (unsigned)scan.frames, (unsigned)scan.fills, (unsigned)scan.avg_line_ns,
+                         (unsigned)scan.max_line_ns, (unsigned)scan.budget_line_ns, (unsigned)scan.overruns);
+            }
+            FlushStats stats = crt_renderer.take_flush_stats();
+            if (stats.cursor_blinks > 0)
+                ESP_LOGI(TAG, "Cursor: %u blinks repainted %u cells", (unsigned)stats.cursor_blinks,
+                         (unsigned)stats.cursor_cells);
+            if (stats.scrolls > 0)
+                ESP_LOGI(TAG, "Scroll: %u scrolls moved %u lines", (unsigned)stats.scrolls, (unsigned)stats.scrolled_lines);
+            if (stats.frames == 0)
+                return;
+            constexpr uint32_t full_frame_bytes = BSP_LCD_H_RES * BSP_LCD_V_RES * sizeof(uint16_t);
+            ESP_LOGI(TAG, "Flush: %u frames, %u areas, %u rows, %u lines, %llu bytes (%.1f%% of full refresh), flush %u us, worst frame %u us, effects %u us",
+                     (unsigned)stats.frames, (unsigned)stats.areas, (unsigned)stats.rows, (unsigned)stats.text_lines,
+                     (unsigned long long)stats.bytes, 100.0f * stats.bytes / ((float)full_frame_bytes * stats.frames),
+                     (unsigned)stats.flush_us, (unsigned)stats.max_frame_us, (unsigned)stats.effects_us);
+        }
+
+        void RobcoDisplayComponent::publish_trace()
+        {
+            uint32_t now = get_millis();
+            if (now - last_trace_publish_ms_ < trace_interval_ms_ || !crt_renderer.get_trace().enabled())
+                return;
+            last_trace_publish_ms_ = now;
+            const RenderTrace &trace = crt_renderer.get_trace();
+            for (size_t i = 0; i < RenderTrace::NUM_STAGES; ++i)
+            {
+                TraceSummary window = trace.take((TraceStage)i, published_trace_);
+                if (trace_sensors_[i] != nullptr && window.count > 0)
+                    trace_sensors_[i]->publish_state(window.percentile_us(95) / 1000.0f);
+            }
+        }
+
+        void RobcoDisplayComponent::dump_trace()
+        {
+            const RenderTrace &trace = crt_renderer.get_trace();
+            if (!trace.enabled())
+            {
+                ESP_LOGI(TAG, "Trace: disabled");
+                return;
+            }
+            for (size_t i = 0; i < RenderTrace::NUM_STAGES; ++i)
+            {
+                TraceStage stage = (TraceStage)i;
+                TraceSummary s = trace.take(stage, dumped_trace_);
+                // Non-empty buckets as "<upper bound us>:count"; the last bucket is open-ended
+                char buckets[TraceSummary::NUM_BUCKETS * 16];
+                size_t pos = 0;
+                for (size_t b = 0; b < TraceSummary::NUM_BUCKETS && pos < sizeof(buckets); ++b)
+                {
+                    if (s.buckets[b] == 0)
+                        continue;
+                    pos += snprintf(buckets + pos, sizeof(buckets) - pos,
+                                    b == TraceSummary::NUM_BUCKETS - 1 ? " >=%u:%u" : " <%u:%u",
+                                    b == TraceSummary::NUM_BUCKETS - 1 ? 1u << (b - 1) : 1u << b, (unsigned)s.buckets[b]);
+                }
+                buckets[std::min(pos, sizeof(buckets) - 1)] = '\0';
+                ESP_LOGI(TAG, "Trace %-11s n=%u avg=%uus p50<=%uus p95<=%uus p99<=%uus peak=%uus |%s",
+                         RenderTrace::stage_name(stage), (unsigned)s.count, (unsigned)s.avg_us(),
+                         (unsigned)s.percentile_us(50), (unsigned)s.percentile_us(95), (unsigned)s.percentile_us(99),
+                         (unsigned)s.peak_us, buckets);
+            }
+        }
+
+        void RobcoDisplayComponent::log_reveal_stats()
+        {
+            const RevealStats &stats = boot_reveal_.stats();
+            ESP_LOGI(TAG, "Boot typing: %u chars in %u ms, %u chars/s (target %u), %u ticks, %u over budget, worst tick %u us",
+                     (unsigned)stats.chars, (unsigned)(stats.elapsed_us / 1000), (unsigned)stats.chars_per_second(),
+                     (unsigned)boot_reveal_.get_chars_per_second(), (unsigned)stats.ticks, (unsigned)stats.overruns,
+                     (unsigned)stats.max_tick_us);
         }
 
         void RobcoDisplayComponent::handle_blink()
@@ -238,51 +531,69 @@ namespace esphome
             }
         }
 
-        // Per-line cache for partial redraw
-        static std::vector<std::string> cached_lines;
+        // Copies the changed lines into a snapshot for the render task; never blocks
         void RobcoDisplayComponent::render_menu()
         {
-            size_t kNumLines = this->crt_renderer.get_num_lines();
-            std::string text = menu_state_.get_display_text();
-            std::vector<std::string> lines;
-            size_t pos = 0, prev = 0;
-            while ((pos = text.find('\n', prev)) != std::string::npos)
+            constexpr uint32_t screen_mask = (1u << ScreenSnapshot::MAX_LINES) - 1;
+            RenderTrace &trace = crt_renderer.get_trace();
             {
-                lines.push_back(text.substr(prev, pos - prev));
-                prev = pos + 1;
+                TraceScope view(trace, TraceStage::VIEW);
+                menu_state_.update_view();
             }
-            if (prev < text.size())
-                lines.push_back(text.substr(prev));
-
-            // Pad or trim lines to fixed length
-            if (lines.size() < kNumLines)
-                lines.resize(kNumLines, "");
-            else if (lines.size() > kNumLines)
-                lines.resize(kNumLines);
-
-            // Ensure cache is fixed length
-            if (cached_lines.size() != kNumLines)
-                cached_lines.resize(kNumLines, "");
-
-            this->crt_renderer.lock();
-
-            // Update or clear all lines
-            for (size_t i = 0; i < kNumLines; ++i)
+            ScrollShift scroll = menu_state_.take_scroll();
+            uint32_t dirty = menu_state_.take_dirty_lines() & screen_mask;
+            if (scroll.top + scroll.rows > ScreenSnapshot::MAX_LINES)
+                scroll.delta = 0;
+            // Lines that moved are already on screen; the render task shifts them, and
+            // the snapshot carries their text so labels mode can simply rewrite them
+            uint32_t moved = scroll.delta != 0 ? ((1u << scroll.rows) - 1) << scroll.top : 0;
+            int cursor_row = menu_state_.get_cursor_row();
+            size_t cursor_col = menu_state_.get_cursor_col();
+            if (cursor_row >= (int)ScreenSnapshot::MAX_LINES)
+                cursor_row = -1;
+            uint32_t copy_start = trace.enabled() ? RenderTrace::now() : 0;
+            ScreenSnapshot &snap = this->snapshot_;
+            bool cursor_moved = cursor_row != snap.cursor_row || (cursor_row >= 0 && cursor_col != snap.cursor_col);
+            if (dirty == 0 && moved == 0 && !cursor_moved)
             {
-                if (lines[i] != cached_lines[i])
-                {
-                    this->crt_renderer.render_line(lines[i], i, true);
-                    cached_lines[i] = lines[i];
-                }
-                else if (lines[i].empty() && !cached_lines[i].empty())
-                {
-                    // Clear line if it was previously non-empty
-                    this->crt_renderer.render_line("", i, true);
-                    cached_lines[i] = "";
-                }
+                // Nothing to draw: the key press had no visible effect
+                pending_input_us_ = 0;
+                return;
             }
 
-            this->crt_renderer.unlock();
+            int prev_cursor_row = snap.cursor_row;
+            uint8_t prev_cursor_col = snap.cursor_col;
+            snap.dirty = dirty;
+            snap.cursor_row = cursor_row;
+            snap.cursor_col = cursor_col;
+            snap.scroll_top = scroll.top;
+            snap.scroll_rows = scroll.rows;
+            snap.scroll_delta = scroll.delta;
+            snap.input_us = pending_input_us_;
+            for (size_t i = 0; i < ScreenSnapshot::MAX_LINES; ++i)
+            {
+                if (!((dirty | moved) & (1u << i)))
+                    continue;
+                LineSpan line = menu_state_.get_line(i);
+                size_t len = std::min(line.len, ScreenSnapshot::MAX_LINE_LENGTH);
+                memcpy(snap.text[i], line.data, len);
+                snap.text[i][len] = '\0';
+                snap.len[i] = len;
+            }
+            // Ends before submit(): the render task may preempt this one as soon as it is notified
+            if (trace.enabled())
+                trace.record_since(TraceStage::SNAPSHOT, copy_start);
+            if (this->crt_renderer.submit(snap))
+                pending_input_us_ = 0;
+            else
+            {
+                // Render task is behind; keep the lines dirty and retry next frame. A lost
+                // shift turns into redrawing every line it moved.
+                menu_state_.mark_lines_dirty(dirty | moved);
+                snap.cursor_row = prev_cursor_row;
+                snap.cursor_col = prev_cursor_col;
+                request_render();
+            }
         }
 
     } // namespace robco_display
@@ -1,9 +1,17 @@
 #include "esphome/core/automation.h"
 #pragma once
 #include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
 #include "../pico_io_extension/pico_io_extension.h"
 #include "menu_state.h"
 #include "crt_terminal_renderer.h"
+#include "flash_log_partition.h"
+#include "mqtt_client_transport.h"
+#include "mqtt_outbox.h"
+#include "render_scheduler.h"
+#include "render_trace.h"
+#include "status_bindings.h"
+#include "text_reveal.h"
 extern "C"
 {
 #include "esp_lvgl_port.h"
@@ -28,6 +36,86 @@ namespace esphome
                 void set_vault_door_state(const std::string &state);
                 void set_red_light_pin(int pin) { red_light_pin_ = pin; }
                 void set_green_light_pin(int pin) { green_light_pin_ = pin; }
+                void set_render_mode(RenderMode mode) { crt_renderer.set_render_mode(mode); }
+                void set_glyph_atlas_mode(GlyphAtlasMode mode) { crt_renderer.set_glyph_atlas_mode(mode); }
+                void set_glyph_benchmark(bool enabled) { crt_renderer.set_glyph_benchmark(enabled); }
+                void set_cursor_style(CursorStyle style) { crt_renderer.set_cursor_style(style); }
+                void set_cursor_blink_interval(uint32_t ms) { crt_renderer.set_cursor_blink_ms(ms); }
+                // Fractions in 0..1 of full brightness
+                void set_crt_effects(float scanline_brightness, float bloom)
+                {
+                    CrtEffectConfig config;
+                    config.scanline_level = (uint8_t)(scanline_brightness * 32.0f + 0.5f);
+                    config.bloom_level = (uint8_t)(bloom * 32.0f + 0.5f);
+                    crt_renderer.set_crt_effects(config);
+                }
+                void set_scanout_effects(float scanline_brightness, float roll_bar_brightness, uint16_t roll_bar_height,
+                                         uint8_t jitter_px, float flicker)
+                {
+                    ScanoutEffectConfig config;
+                    config.scanline_level = (uint8_t)(scanline_brightness * 32.0f + 0.5f);
+                    config.roll_bar_level = (uint8_t)(roll_bar_brightness * 32.0f + 0.5f);
+                    config.roll_bar_height = roll_bar_height;
+                    config.jitter_px = jitter_px;
+                    config.flicker_depth = (uint8_t)(flicker * 32.0f + 0.5f);
+                    crt_renderer.set_scanout_effects(config);
+                }
+                // Core for the LVGL and render tasks; -1 leaves them unpinned
+                void set_render_core(int core)
+                {
+                    task_core_ = core;
+                    crt_renderer.set_task_core(core);
+                }
+                void set_frame_interval(uint32_t ms) { render_scheduler_.set_frame_interval_us(ms * 1000); }
+                // Boot text typing rate; 0 shows it all at once
+                void set_boot_typing_speed(uint32_t chars_per_second) { boot_reveal_.set_chars_per_second(chars_per_second); }
+                // Loop time one typing tick may use before the reveal slows down
+                void set_boot_tick_budget(uint32_t us) { boot_reveal_.set_tick_budget_us(us); }
+                // Mark the screen stale; loop() renders at most once per frame interval
+                void request_render();
+                // Header, boot text and menu; the tables must stay valid for the component's lifetime
+                void set_menu_definition(const MenuDefinition *definition) { menu_definition_ = definition; }
+                // Run handler when the menu entry with this id is activated; bound in setup()
+                void add_menu_action(const std::string &id, std::function<void()> handler);
+                // Show value next to the status entry with this id; false if there is none
+                bool set_menu_status(const std::string &id, const std::string &value);
+                // MQTT topics shown in status entries; the table must stay valid for the component's lifetime
+                void set_status_bindings(const StatusBindingTable *table) { status_bindings_.set_table(table); }
+                void set_status_batch_window(uint32_t ms) { status_batch_window_us_ = ms * 1000; }
+                // Show a message in the status entry bound to its topic; false if the topic is unbound
+                bool on_status_message(const std::string &topic, const std::string &payload);
+                // Flash data partition that keeps the log shown by LOGS menu entries
+                void set_log_partition(const std::string &label) { log_partition_label_ = label; }
+                // Append an entry to the persistent log
+                void add_log(const std::string &entry);
+                // Door commands: QoS for the publish, how long an unsent command waits for
+                // the broker, and how long a sent one waits for the door state to follow
+                void set_command_qos(uint8_t qos) { outbox_.set_qos(qos); }
+                void set_command_expiry(uint32_t ms) { outbox_.set_expire_us(ms * 1000LL); }
+                void set_command_ack_timeout(uint32_t ms) { outbox_.set_ack_timeout_us(ms * 1000LL); }
+                // Terminal mode: the screen shows a VT100/ANSI stream until Esc is pressed.
+                // Opened by the menu entry with this id; bytes come from the MQTT topic and
+                // from write_terminal(), e.g. in a UART or TCP lambda.
+                void set_terminal_menu_id(const std::string &id) { terminal_menu_id_ = id; }
+                void set_terminal_topic(const std::string &topic) { terminal_topic_ = topic; }
+                // LF also returns the carriage, for sources that end lines with \n only
+                void set_terminal_newline_mode(bool enabled) { crt_renderer.set_terminal_newline_mode(enabled); }
+                void enter_terminal();
+                void exit_terminal();
+                bool terminal_active() const { return crt_renderer.terminal_active(); }
+                // Never blocks; bytes that do not fit, or arrive while the terminal is closed, are dropped
+                size_t write_terminal(const uint8_t *data, size_t len) { return crt_renderer.write_terminal(data, len); }
+                size_t write_terminal(const std::string &data)
+                {
+                    return crt_renderer.write_terminal((const uint8_t *)data.data(), data.size());
+                }
+                // Pipeline stage timing; off leaves only the existing counters
+                void set_trace_enabled(bool enabled) { crt_renderer.get_trace().set_enabled(enabled); }
+                void set_trace_interval(uint32_t ms) { trace_interval_ms_ = ms; }
+                // Publishes the stage's 95th percentile in ms every trace interval
+                void set_trace_sensor(TraceStage stage, sensor::Sensor *sensor) { trace_sensors_[(size_t)stage] = sensor; }
+                // Log every stage's histogram since the previous dump
+                void dump_trace();
 
     private:
             esphome::pico_io_extension::PicoIOExtension *pico_io_ext_ = nullptr;
@@ -40,11 +128,49 @@ namespace esphome
             esp_err_t app_lvgl_init(esp_lcd_panel_handle_t lp,
                                     lv_display_t **lv_disp);
             void render_menu();
-            std::string vault_door_state_ = "Unknown";
-            std::vector<MenuEntry> menu_;
+            void bind_menu_actions();
+            void close_vault_door();
+            void subscribe_status_topics();
+            void subscribe_terminal_topic();
+            void on_command_event(const OutboxCommand &command, OutboxEvent event);
+            RenderScheduler render_scheduler_;
+            TextReveal boot_reveal_;
+            const MenuDefinition *menu_definition_ = nullptr;
+            std::vector<std::pair<std::string, std::function<void()>>> action_bindings_;
+            // Action handler per menu node, indexed like MenuTree's node array
+            std::vector<std::function<void()>> actions_;
+            ScreenSnapshot snapshot_;
+            std::string log_partition_label_;
+            FlashLogPartition log_partition_;
+            LogStore log_store_;
+            MqttClientTransport mqtt_transport_;
+            MqttOutbox outbox_;
+            StatusBindings status_bindings_;
+            uint32_t status_batch_window_us_ = 100000;
+            // A bound status changed; render once the batch window has passed
+            bool status_render_pending_ = false;
+            int64_t status_render_due_us_ = 0;
+            uint32_t status_messages_ = 0;
+            uint32_t status_unbound_ = 0;
+            uint32_t status_renders_ = 0;
+            std::string terminal_menu_id_;
+            std::string terminal_topic_;
+            int task_core_ = 1;
             // LED blink state
             uint32_t get_millis();
             void handle_blink();
+            void log_flush_stats();
+            void log_reveal_stats();
+            void publish_trace();
+            uint32_t last_stats_log_ms_ = 0;
+            // Key press time not yet carried by a snapshot, 0 if none
+            int64_t pending_input_us_ = 0;
+            sensor::Sensor *trace_sensors_[RenderTrace::NUM_STAGES] = {};
+            uint32_t trace_interval_ms_ = 60000;
+            uint32_t last_trace_publish_ms_ = 0;
+            // Counts at the last publish and the last dump; each reader takes its own deltas
+            RenderTrace published_trace_;
+            RenderTrace dumped_trace_;
             int blink_active_ = 0; // 0 means inactive, otherwise pin number
             int red_light_pin_ = 17;
             int green_light_pin_ = 21;
@@ -52,5 +178,26 @@ namespace esphome
             uint32_t last_blink_ms_ = 0;
             bool led_state_ = false;
         };
+
+        class MenuActionTrigger : public Trigger<>
+        {
+        public:
+            MenuActionTrigger(RobcoDisplayComponent *parent, const std::string &id)
+            {
+                parent->add_menu_action(id, [this]()
+                                        { this->trigger(); });
+            }
+        };
+
+        template <typename... Ts>
+        class DumpTraceAction : public Action<Ts...>
+        {
+        public:
+            explicit DumpTraceAction(RobcoDisplayComponent *parent) : parent_(parent) {}
+            void play(Ts... x) override { this->parent_->dump_trace(); }
+
+        private:
+            RobcoDisplayComponent *parent_;
+        };
     } // namespace robco_display
 } // namespace esphome
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+
+
+// Window of up to rows() consecutive items over a list of count() items.
+// Only the offset is tracked, so every operation is O(1) in the list length
+// and callers materialise just the visible window.
+class ScrollViewport {
+public:
+    void reset(size_t count, size_t rows) {
+        count_ = count;
+        rows_ = rows;
+        offset_ = 0;
+    }
+    void set_count(size_t count) {
+        count_ = count;
+        clamp();
+    }
+    void set_rows(size_t rows) {
+        rows_ = rows;
+        clamp();
+    }
+    size_t count() const { return count_; }
+    size_t rows() const { return rows_; }
+    // Index of the first visible item
+    size_t offset() const { return offset_; }
+    // Items actually shown, fewer than rows() at the end of a short list
+    size_t visible() const { return count_ - offset_ < rows_ ? count_ - offset_ : rows_; }
+    size_t max_offset() const { return count_ > rows_ ? count_ - rows_ : 0; }
+    bool contains(size_t index) const { return index >= offset_ && index < offset_ + visible(); }
+
+    void scroll_to(size_t offset) { offset_ = offset < max_offset() ? offset : max_offset(); }
+    void scroll_by(long delta) {
+        if (delta < 0 && (size_t)-delta > offset_) offset_ = 0;
+        else scroll_to(offset_ + delta);
+    }
+    // A page keeps one line of the previous window for context
+    size_t page() const { return rows_ > 1 ? rows_ - 1 : 1; }
+    void page_up() { scroll_by(-(long)page()); }
+    void page_down() { scroll_by((long)page()); }
+    // Scroll the least distance that brings index into view
+    void follow(size_t index) {
+        if (index < offset_) scroll_to(index);
+        else if (rows_ > 0 && index >= offset_ + rows_) scroll_to(index - rows_ + 1);
+    }
+
+private:
+    void clamp() { scroll_to(offset_); }
+
+    size_t count_ = 0;
+    size_t rows_ = 0;
+    size_t offset_ = 0;
+};
@@ -0,0 +1,46 @@
+#include "status_bindings.h"
+#include <algorithm>
+#include <cstring>
+
+uint32_t status_topic_hash(uint32_t seed, const char* data, size_t len) {
+    uint32_t h = 2166136261u ^ (seed * 0x9E3779B1u);
+    for (size_t i = 0; i < len; ++i) {
+        h ^= (uint8_t)data[i];
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+const StatusBinding* StatusBindings::find(const char* topic, size_t len) const {
+    if (table_ == nullptr || table_->binding_count == 0) return nullptr;
+    uint32_t bucket = status_topic_hash(0, topic, len) & table_->bucket_mask;
+    uint32_t slot = status_topic_hash(table_->seeds[bucket], topic, len) & table_->slot_mask;
+    const StatusBinding& binding = table_->slots[slot];
+    // Unbound topics land on some slot too; only the compare tells them apart
+    if (binding.topic == nullptr || strncmp(binding.topic, topic, len) != 0 || binding.topic[len] != '\0')
+        return nullptr;
+    return &binding;
+}
+
+size_t StatusBindings::format(const StatusBinding& binding, const char* value, size_t len, char* out,
+                              size_t size) const {
+    for (size_t i = 0; i < binding.map_count; ++i) {
+        const StatusValueMap& map = table_->maps[binding.map_first + i];
+        if (strncmp(map.from, value, len) == 0 && map.from[len] == '\0') {
+            value = map.to;
+            len = strlen(map.to);
+            break;
+        }
+    }
+    size_t pos = 0;
+    auto append = [&](const char* text, size_t n) {
+        n = std::min(n, size - 1 - pos);
+        memcpy(out + pos, text, n);
+        pos += n;
+    };
+    append(binding.prefix, strlen(binding.prefix));
+    append(value, len);
+    append(binding.suffix, strlen(binding.suffix));
+    out[pos] = '\0';
+    return pos;
+}
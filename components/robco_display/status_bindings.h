@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+
+// Replacement for one exact status value, e.g. "opened" -> "Opened"
+struct StatusValueMap {
+    const char* from;
+    const char* to;
+};
+
+// An MQTT topic shown in a STATUS node as prefix + value + suffix. The value
+// is the payload, or its replacement from maps[map_first .. map_first + map_count).
+struct StatusBinding {
+    const char* topic;     // nullptr marks an empty slot of the hash table
+    int16_t node;
+    const char* prefix;
+    const char* suffix;
+    uint16_t map_first;
+    uint16_t map_count;
+};
+
+// Topic index generated by robco_display/status_bindings.py. Slots form a
+// perfect hash table: the topic's bucket picks a seed, and the seeded hash
+// lands on the slot of that topic and no other, so a lookup is two hashes and
+// one string compare whatever the number of topics.
+struct StatusBindingTable {
+    const StatusBinding* slots;
+    uint32_t slot_mask;
+    const uint16_t* seeds;
+    uint32_t bucket_mask;
+    const StatusValueMap* maps;
+    size_t binding_count;
+    // Topic filters to subscribe to; may use + and # to cover many bindings
+    const char* const* subscriptions;
+    size_t subscription_count;
+};
+
+// FNV-1a with a seeded offset and a final shift so the low bits mix; must
+// match topic_hash() in status_bindings.py
+uint32_t status_topic_hash(uint32_t seed, const char* data, size_t len);
+
+class StatusBindings {
+public:
+    void set_table(const StatusBindingTable* table) { table_ = table; }
+    const StatusBindingTable* table() const { return table_; }
+    // The binding for this topic, nullptr if it is not bound
+    const StatusBinding* find(const char* topic, size_t len) const;
+    // Text to show for a payload; truncated to size - 1 and NUL-terminated
+    size_t format(const StatusBinding& binding, const char* value, size_t len, char* out, size_t size) const;
+
+private:
+    const StatusBindingTable* table_ = nullptr;
+};
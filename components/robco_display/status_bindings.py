@@ -0,0 +1,156 @@
+"""Compile MQTT status bindings into a constexpr perfect hash table.
+
+Each binding shows one MQTT topic in a status menu entry. The topic index
+mirrors StatusBindings::find() in status_bindings.cpp: a topic's bucket is
+its hash with seed 0, the bucket's seed gives its slot, and the seeds are
+searched here so that no two topics share a slot.
+"""
+import logging
+
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.helpers import cpp_string_escape
+
+_LOGGER = logging.getLogger(__name__)
+
+VALUE_PLACEHOLDER = "{value}"
+MAX_SEED = 0xFFFF
+
+
+def _exact_topic(value):
+    value = cv.string(value)
+    if not value or "+" in value or "#" in value:
+        raise cv.Invalid("binding topics must be exact; put wildcards in status_subscriptions")
+    return value
+
+
+def _format(value):
+    value = cv.string(value)
+    if value.count(VALUE_PLACEHOLDER) != 1:
+        raise cv.Invalid(f"format must contain {VALUE_PLACEHOLDER} exactly once")
+    return value
+
+
+def _value_map(value):
+    if not isinstance(value, dict):
+        raise cv.Invalid("map must be a mapping of payloads to text")
+    return {cv.string(k): cv.string(v) for k, v in value.items()}
+
+
+BINDING_SCHEMA = cv.Schema({
+    cv.Required("topic"): _exact_topic,
+    cv.Required("menu_id"): cv.string,
+    # Text shown for a payload, e.g. "{value} kW"; applied after map
+    cv.Optional("format", default=VALUE_PLACEHOLDER): _format,
+    # Payloads shown as other text, e.g. opened: Opened
+    cv.Optional("map", default={}): _value_map,
+})
+
+
+def topic_matches(topic_filter, topic):
+    """MQTT filter matching with + and #."""
+    parts, levels = topic_filter.split("/"), topic.split("/")
+    for i, part in enumerate(parts):
+        if part == "#":
+            return True
+        if i >= len(levels) or (part != "+" and part != levels[i]):
+            return False
+    return len(parts) == len(levels)
+
+
+def validate_bindings(bindings, subscriptions, nodes):
+    """Check bindings against the flattened menu and the subscription filters."""
+    status_ids = {n["menu_id"] for n in nodes if n["type"] == "status" and n["menu_id"]}
+    seen = set()
+    for binding in bindings:
+        if binding["menu_id"] not in status_ids:
+            raise cv.Invalid(f"status binding for '{binding['topic']}': no status entry with "
+                             f"menu_id '{binding['menu_id']}'")
+        if binding["topic"] in seen:
+            raise cv.Invalid(f"topic '{binding['topic']}' is bound twice")
+        seen.add(binding["topic"])
+        if subscriptions and not any(topic_matches(f, binding["topic"]) for f in subscriptions):
+            raise cv.Invalid(f"topic '{binding['topic']}' is not covered by status_subscriptions")
+
+
+def topic_hash(seed, data):
+    """status_topic_hash() in status_bindings.cpp."""
+    h = 2166136261 ^ ((seed * 0x9E3779B1) & 0xFFFFFFFF)
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h ^ (h >> 15)
+
+
+def _next_pow2(n):
+    return 1 << max(0, (n - 1).bit_length())
+
+
+def build_perfect_hash(topics):
+    """Return (slot per topic, seed per bucket, slot count), largest buckets placed first."""
+    keys = [t.encode() for t in topics]
+    slot_count = _next_pow2(len(keys))
+    bucket_count = _next_pow2(max(1, len(keys) // 2))
+    while True:
+        buckets = [[] for _ in range(bucket_count)]
+        for i, key in enumerate(keys):
+            buckets[topic_hash(0, key) & (bucket_count - 1)].append(i)
+        seeds = [0] * bucket_count
+        slots = [None] * len(keys)
+        taken = set()
+        for b in sorted(range(bucket_count), key=lambda b: -len(buckets[b])):
+            if not buckets[b]:
+                continue
+            for seed in range(1, MAX_SEED + 1):
+                placed = {topic_hash(seed, keys[i]) & (slot_count - 1) for i in buckets[b]}
+                if len(placed) == len(buckets[b]) and not placed & taken:
+                    break
+            else:
+                break
+            seeds[b] = seed
+            for i in buckets[b]:
+                slots[i] = topic_hash(seed, keys[i]) & (slot_count - 1)
+            taken |= placed
+        else:
+            return slots, seeds, slot_count
+        # A full table left some bucket without a seed; give it more room
+        slot_count *= 2
+
+
+def generate_status_bindings(var, prefix, bindings, subscriptions, nodes):
+    """Emit the binding table as globals and hand it to the component."""
+    if not bindings:
+        return
+    node_of = {n["menu_id"]: i for i, n in enumerate(nodes) if n["menu_id"]}
+    slots, seeds, slot_count = build_perfect_hash([b["topic"] for b in bindings])
+
+    maps, rows = [], ["{nullptr, -1, \"\", \"\", 0, 0}"] * slot_count
+    for binding, slot in zip(bindings, slots):
+        before, after = binding["format"].split(VALUE_PLACEHOLDER)
+        rows[slot] = (f"{{{cpp_string_escape(binding['topic'])}, {node_of[binding['menu_id']]}, "
+                      f"{cpp_string_escape(before)}, {cpp_string_escape(after)}, {len(maps)}, "
+                      f"{len(binding['map'])}}}")
+        maps.extend(binding["map"].items())
+    slots_name = f"{prefix}_status_slots"
+    cg.add_global(cg.RawStatement(
+        f"static constexpr StatusBinding {slots_name}[] = {{\n  " + ",\n  ".join(rows) + "};"))
+    seeds_name = f"{prefix}_status_seeds"
+    cg.add_global(cg.RawStatement(
+        f"static constexpr uint16_t {seeds_name}[] = {{{', '.join(str(s) for s in seeds)}}};"))
+    maps_name = "nullptr"
+    if maps:
+        maps_name = f"{prefix}_status_maps"
+        body = ", ".join(f"{{{cpp_string_escape(k)}, {cpp_string_escape(v)}}}" for k, v in maps)
+        cg.add_global(cg.RawStatement(f"static constexpr StatusValueMap {maps_name}[] = {{{body}}};"))
+    # Without explicit filters every bound topic is its own subscription
+    filters = subscriptions or [b["topic"] for b in bindings]
+    subs_name = f"{prefix}_status_subscriptions"
+    body = ", ".join(cpp_string_escape(f) for f in filters)
+    cg.add_global(cg.RawStatement(f"static constexpr const char *{subs_name}[] = {{{body}}};"))
+
+    table = f"{prefix}_status_bindings"
+    cg.add_global(cg.RawStatement(
+        f"static constexpr StatusBindingTable {table} = {{{slots_name}, {slot_count - 1}, {seeds_name}, "
+        f"{len(seeds) - 1}, {maps_name}, {len(bindings)}, {subs_name}, {len(filters)}}};"))
+    cg.add(var.set_status_bindings(cg.RawExpression(f"&{table}")))
+    _LOGGER.info("Status bindings: %d topics in %d slots, %d buckets, %d subscriptions",
+                 len(bindings), slot_count, len(seeds), len(filters))
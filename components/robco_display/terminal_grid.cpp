@@ -0,0 +1,90 @@
+#include "terminal_grid.h"
+#include <cstring>
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        void TerminalGrid::resize(size_t rows, size_t cols)
+        {
+            rows_ = rows;
+            cols_ = cols;
+            cells_.assign(rows * cols, TerminalCell{});
+            dirty_.assign(rows * cols, 0);
+            dirty_rows_.assign(rows, 0);
+            dirty_count_ = 0;
+            mark_all_dirty();
+        }
+
+        void TerminalGrid::mark_dirty(size_t row, size_t col)
+        {
+            uint8_t &flag = dirty_[row * cols_ + col];
+            if (!flag)
+            {
+                flag = 1;
+                dirty_rows_[row] = 1;
+                ++dirty_count_;
+            }
+        }
+
+        void TerminalGrid::set_cell(size_t row, size_t col, char ch, uint8_t attr)
+        {
+            if (row >= rows_ || col >= cols_)
+                return;
+            TerminalCell &c = cells_[row * cols_ + col];
+            if (c.ch == ch && c.attr == attr)
+                return;
+            c.ch = ch;
+            c.attr = attr;
+            mark_dirty(row, col);
+        }
+
+        void TerminalGrid::write_line(size_t row, const char *text, size_t len, uint8_t attr)
+        {
+            if (row >= rows_)
+                return;
+            size_t n = len < cols_ ? len : cols_;
+            for (size_t c = 0; c < n; ++c)
+                set_cell(row, c, text[c], attr);
+            for (size_t c = n; c < cols_; ++c)
+                set_cell(row, c, ' ', CELL_ATTR_NONE);
+        }
+
+        void TerminalGrid::scroll_rows(size_t top, size_t count, int delta)
+        {
+            if (top >= rows_)
+                return;
+            if (count > rows_ - top)
+                count = rows_ - top;
+            size_t distance = delta < 0 ? -delta : delta;
+            if (distance == 0 || distance >= count)
+                return;
+            size_t kept = count - distance;
+            size_t from = delta > 0 ? top + distance : top;
+            size_t to = delta > 0 ? top : top + distance;
+            // Dirty cells still count once each, wherever they end up
+            for (size_t r = to; r < to + kept; ++r)
+                for (size_t c = 0; c < cols_; ++c)
+                    dirty_count_ -= dirty_[r * cols_ + c];
+            memmove(&cells_[to * cols_], &cells_[from * cols_], kept * cols_ * sizeof(TerminalCell));
+            memmove(&dirty_[to * cols_], &dirty_[from * cols_], kept * cols_);
+            memmove(&dirty_rows_[to], &dirty_rows_[from], kept);
+            for (size_t r = to; r < to + kept; ++r)
+                for (size_t c = 0; c < cols_; ++c)
+                    dirty_count_ += dirty_[r * cols_ + c];
+        }
+
+        void TerminalGrid::clear()
+        {
+            for (size_t r = 0; r < rows_; ++r)
+                write_line(r, "", 0);
+        }
+
+        void TerminalGrid::mark_all_dirty()
+        {
+            for (size_t r = 0; r < rows_; ++r)
+                for (size_t c = 0; c < cols_; ++c)
+                    mark_dirty(r, c);
+        }
+    } // namespace robco_display
+} // namespace esphome
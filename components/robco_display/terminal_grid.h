@@ -0,0 +1,84 @@
+#ifndef TERMINAL_GRID_H
+#define TERMINAL_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        // Per-cell attribute bits
+        enum CellAttr : uint8_t
+        {
+            CELL_ATTR_NONE = 0,
+            CELL_ATTR_INVERSE = 1 << 0,
+            CELL_ATTR_UNDERLINE = 1 << 1,
+        };
+
+        struct TerminalCell
+        {
+            char ch = ' ';
+            uint8_t attr = CELL_ATTR_NONE;
+        };
+
+        // Fixed rows x cols character buffer. Writes that change a cell mark it
+        // dirty; the renderer drains dirty cells and repaints only those tiles.
+        class TerminalGrid
+        {
+        public:
+            void resize(size_t rows, size_t cols);
+            size_t rows() const { return rows_; }
+            size_t cols() const { return cols_; }
+
+            const TerminalCell &cell(size_t row, size_t col) const { return cells_[row * cols_ + col]; }
+            void set_cell(size_t row, size_t col, char ch, uint8_t attr = CELL_ATTR_NONE);
+            // Write text at the start of a row and blank the remainder
+            void write_line(size_t row, const char *text, size_t len, uint8_t attr = CELL_ATTR_NONE);
+            // Move rows top..top+count-1 up by delta rows (down if negative), carrying
+            // their dirty flags along. Rows the move uncovers keep their old contents.
+            void scroll_rows(size_t top, size_t count, int delta);
+            void clear();
+            void mark_all_dirty();
+            // Force one cell to be repainted, e.g. when an overlay such as the cursor changes
+            void mark_dirty(size_t row, size_t col);
+
+            bool has_dirty() const { return dirty_count_ > 0; }
+            size_t dirty_count() const { return dirty_count_; }
+
+            // Calls fn(row, col, cell) for every dirty cell and clears the dirty state
+            template <typename F>
+            void consume_dirty(F &&fn)
+            {
+                if (dirty_count_ == 0)
+                    return;
+                for (size_t r = 0; r < rows_; ++r)
+                {
+                    if (!dirty_rows_[r])
+                        continue;
+                    uint8_t *row_dirty = &dirty_[r * cols_];
+                    for (size_t c = 0; c < cols_; ++c)
+                    {
+                        if (row_dirty[c])
+                        {
+                            row_dirty[c] = 0;
+                            fn(r, c, cells_[r * cols_ + c]);
+                        }
+                    }
+                    dirty_rows_[r] = 0;
+                }
+                dirty_count_ = 0;
+            }
+
+        private:
+            size_t rows_ = 0;
+            size_t cols_ = 0;
+            size_t dirty_count_ = 0;
+            std::vector<TerminalCell> cells_;
+            std::vector<uint8_t> dirty_;
+            std::vector<uint8_t> dirty_rows_;
+        };
+    } // namespace robco_display
+} // namespace esphome
+#endif // TERMINAL_GRID_H
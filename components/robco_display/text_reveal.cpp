@@ -0,0 +1,79 @@
+#include "text_reveal.h"
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        void TextReveal::start(size_t total_chars, int64_t now_us)
+        {
+            total_ = total_chars;
+            visible_ = 0;
+            allowance_ = MAX_ALLOWANCE;
+            start_us_ = now_us;
+            paused_us_ = 0;
+            stats_ = RevealStats();
+            active_ = total_chars > 0;
+        }
+
+        void TextReveal::finish()
+        {
+            visible_ = total_;
+            active_ = false;
+        }
+
+        size_t TextReveal::due(int64_t now_us) const
+        {
+            if (chars_per_second_ == 0)
+                return total_;
+            int64_t elapsed = now_us - start_us_ - paused_us_;
+            if (elapsed <= 0)
+                return 0;
+            uint64_t n = (uint64_t)elapsed * chars_per_second_ / 1000000;
+            return n < total_ ? (size_t)n : total_;
+        }
+
+        bool TextReveal::is_due(int64_t now_us) const
+        {
+            return active_ && due(now_us) > visible_;
+        }
+
+        size_t TextReveal::advance(int64_t now_us)
+        {
+            if (!active_)
+                return ALL;
+            size_t target = due(now_us);
+            if (target > visible_ + allowance_)
+            {
+                // Throttled: shift the schedule so the backlog is not dumped in one burst later
+                if (chars_per_second_ > 0)
+                    paused_us_ += (int64_t)(target - visible_ - allowance_) * 1000000 / chars_per_second_;
+                target = visible_ + allowance_;
+            }
+            if (target > visible_)
+            {
+                stats_.chars += target - visible_;
+                stats_.ticks++;
+                visible_ = target;
+            }
+            stats_.elapsed_us = (uint32_t)(now_us - start_us_);
+            if (visible_ >= total_)
+                active_ = false;
+            return visible();
+        }
+
+        void TextReveal::end_tick(uint32_t elapsed_us)
+        {
+            if (elapsed_us > stats_.max_tick_us)
+                stats_.max_tick_us = elapsed_us;
+            if (elapsed_us > tick_budget_us_)
+            {
+                stats_.overruns++;
+                allowance_ = allowance_ > 1 ? allowance_ / 2 : 1;
+            }
+            else if (allowance_ < MAX_ALLOWANCE)
+            {
+                allowance_++;
+            }
+        }
+    } // namespace robco_display
+} // namespace esphome
@@ -0,0 +1,67 @@
+#ifndef TEXT_REVEAL_H
+#define TEXT_REVEAL_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        struct RevealStats
+        {
+            uint32_t chars = 0;       // characters revealed
+            uint32_t elapsed_us = 0;  // from start() to the last character
+            uint32_t ticks = 0;       // ticks that revealed at least one character
+            uint32_t overruns = 0;    // ticks that took longer than the tick budget
+            uint32_t max_tick_us = 0;
+
+            uint32_t chars_per_second() const { return elapsed_us ? (uint64_t)chars * 1000000 / elapsed_us : 0; }
+        };
+
+        // Paces a typewriter reveal of a fixed amount of text. Characters become due
+        // at a fixed rate; each tick reveals the due ones, but never more than the
+        // tick allowance, which halves after a tick overruns its time budget and
+        // grows back while ticks stay inside it. Falling behind slows the reveal
+        // instead of stalling the loop that drives it.
+        class TextReveal
+        {
+        public:
+            static constexpr size_t ALL = SIZE_MAX;
+
+            // 0 reveals everything on the first tick
+            void set_chars_per_second(uint32_t cps) { chars_per_second_ = cps; }
+            uint32_t get_chars_per_second() const { return chars_per_second_; }
+            void set_tick_budget_us(uint32_t us) { tick_budget_us_ = us; }
+
+            void start(size_t total_chars, int64_t now_us);
+            // Reveal everything immediately
+            void finish();
+            bool active() const { return active_; }
+            // True when characters are due that have not been revealed yet
+            bool is_due(int64_t now_us) const;
+            // Reveal due characters; returns the number now visible (ALL once done)
+            size_t advance(int64_t now_us);
+            // Report how long the work triggered by advance() took
+            void end_tick(uint32_t elapsed_us);
+            size_t visible() const { return active_ ? visible_ : ALL; }
+            const RevealStats &stats() const { return stats_; }
+
+        private:
+            static constexpr uint32_t MAX_ALLOWANCE = 256;
+
+            size_t due(int64_t now_us) const;
+
+            uint32_t chars_per_second_ = 0;
+            uint32_t tick_budget_us_ = 2000;
+            bool active_ = false;
+            size_t total_ = 0;
+            size_t visible_ = 0;
+            uint32_t allowance_ = MAX_ALLOWANCE;
+            int64_t start_us_ = 0;
+            int64_t paused_us_ = 0; // time lost to throttled ticks, pushed onto the schedule
+            RevealStats stats_;
+        };
+    } // namespace robco_display
+} // namespace esphome
+#endif // TEXT_REVEAL_H
@@ -0,0 +1,605 @@
+#include "vt_parser.h"
+#include <algorithm>
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        // DEC special graphics for 0x5F..0x7E, drawn with the closest ASCII the font has
+        static const char DEC_GRAPHICS[] = " +#    '## +++++----_++++|<>*!fo";
+        static_assert(sizeof(DEC_GRAPHICS) == 0x7F - 0x5F + 1, "one replacement per DEC graphics character");
+
+        void VtParser::attach(TerminalGrid *grid, ScrollFn scroll)
+        {
+            this->grid_ = grid;
+            this->scroll_ = std::move(scroll);
+            this->reset();
+        }
+
+        void VtParser::reset()
+        {
+            this->state_ = State::GROUND;
+            this->row_ = this->col_ = 0;
+            this->top_ = 0;
+            this->bottom_ = this->grid_ != nullptr ? this->rows() - 1 : 0;
+            this->attr_ = CELL_ATTR_NONE;
+            this->wrap_pending_ = false;
+            this->autowrap_ = true;
+            this->origin_ = false;
+            this->newline_mode_ = this->newline_mode_default_;
+            this->cursor_visible_ = true;
+            this->charset_[0] = this->charset_[1] = 'B';
+            this->active_charset_ = 0;
+            this->saved_ = SavedCursor();
+            for (size_t c = 0; c < MAX_COLS; ++c)
+                this->tab_stops_[c] = c % 8 == 0;
+            if (this->grid_ != nullptr)
+                this->grid_->clear();
+        }
+
+        // Printable ASCII in the ground state is by far the most common input and
+        // takes the first branch; everything else goes through the state machine
+        void VtParser::feed(const uint8_t *data, size_t len)
+        {
+            if (this->grid_ == nullptr || this->grid_->rows() == 0)
+                return;
+            const uint8_t *end = data + len;
+            while (data < end)
+            {
+                uint8_t ch = *data++;
+                if (this->state_ == State::GROUND && ch >= 0x20 && ch < 0x7F)
+                {
+                    this->print(ch);
+                    continue;
+                }
+                if (ch == 0x1B)
+                {
+                    // Also ends a string; the ST that may follow is a no-op escape
+                    this->state_ = State::ESCAPE;
+                    this->intermediate_ = 0;
+                    continue;
+                }
+                if (this->state_ == State::STRING)
+                {
+                    if (ch == 0x07)
+                        this->state_ = State::GROUND;
+                    continue;
+                }
+                if (ch < 0x20)
+                {
+                    // Controls run in the middle of a sequence too; CAN and SUB abort it
+                    if (ch == 0x18 || ch == 0x1A || this->state_ == State::UTF8)
+                        this->state_ = State::GROUND;
+                    this->control(ch);
+                    continue;
+                }
+                switch (this->state_)
+                {
+                case State::GROUND:
+                    // DEL, C1 controls and stray continuation bytes are dropped
+                    if (ch >= 0xC0 && ch < 0xF8)
+                    {
+                        this->print('?');
+                        this->utf8_remaining_ = ch >= 0xF0 ? 3 : ch >= 0xE0 ? 2 : 1;
+                        this->state_ = State::UTF8;
+                    }
+                    break;
+                case State::UTF8:
+                    if ((ch & 0xC0) == 0x80)
+                    {
+                        if (--this->utf8_remaining_ == 0)
+                            this->state_ = State::GROUND;
+                    }
+                    else
+                    {
+                        // Truncated sequence: the byte starts something new
+                        this->state_ = State::GROUND;
+                        --data;
+                    }
+                    break;
+                case State::ESCAPE:
+                    if (ch == '[')
+                    {
+                        this->state_ = State::CSI_PARAM;
+                        this->param_count_ = 0;
+                        this->params_[0] = 0;
+                        this->prefix_ = 0;
+                    }
+                    else if (ch == ']' || ch == 'P' || ch == '_' || ch == '^' || ch == 'X')
+                        this->state_ = State::STRING;
+                    else if (ch < 0x30)
+                    {
+                        this->intermediate_ = ch;
+                        this->state_ = State::ESCAPE_INTERMEDIATE;
+                    }
+                    else
+                    {
+                        this->state_ = State::GROUND;
+                        this->esc_dispatch(ch);
+                    }
+                    break;
+                case State::ESCAPE_INTERMEDIATE:
+                    // Only the first intermediate byte matters for what is supported
+                    if (ch >= 0x30)
+                    {
+                        this->state_ = State::GROUND;
+                        this->esc_dispatch(ch);
+                    }
+                    break;
+                case State::CSI_PARAM:
+                    if (ch >= '0' && ch <= '9')
+                    {
+                        if (this->param_count_ == 0)
+                            this->param_count_ = 1;
+                        uint16_t &p = this->params_[this->param_count_ - 1];
+                        p = std::min(p * 10 + (ch - '0'), 9999);
+                    }
+                    else if (ch == ';' || ch == ':')
+                    {
+                        if (this->param_count_ == 0)
+                            this->param_count_ = 1;
+                        if (this->param_count_ < MAX_PARAMS)
+                            this->params_[this->param_count_++] = 0;
+                    }
+                    else if (ch >= 0x3C && ch <= 0x3F)
+                    {
+                        if (this->param_count_ == 0 && this->prefix_ == 0)
+                            this->prefix_ = ch;
+                        else
+                            this->state_ = State::CSI_IGNORE;
+                    }
+                    else if (ch < 0x30)
+                        this->intermediate_ = ch;
+                    else if (ch >= 0x40 && ch < 0x7F)
+                    {
+                        this->state_ = State::GROUND;
+                        this->csi_dispatch(ch);
+                    }
+                    break;
+                case State::CSI_IGNORE:
+                    if (ch >= 0x40 && ch < 0x7F)
+                    {
+                        this->state_ = State::GROUND;
+                        this->unsupported_++;
+                    }
+                    break;
+                case State::STRING:
+                    break;
+                }
+            }
+        }
+
+        void VtParser::print(uint8_t ch)
+        {
+            if (this->charset_[this->active_charset_] == '0' && ch >= 0x5F && ch < 0x7F)
+                ch = DEC_GRAPHICS[ch - 0x5F];
+            if (this->wrap_pending_)
+            {
+                this->wrap_pending_ = false;
+                this->col_ = 0;
+                this->index();
+            }
+            this->grid_->set_cell(this->row_, this->col_, (char)ch, this->attr_);
+            if (this->col_ + 1 < this->cols())
+                this->col_++;
+            else
+                this->wrap_pending_ = this->autowrap_;
+        }
+
+        void VtParser::control(uint8_t ch)
+        {
+            switch (ch)
+            {
+            case 0x08: // BS
+                this->col_ = std::max(this->col_ - 1, 0);
+                this->wrap_pending_ = false;
+                break;
+            case 0x09: // HT
+            {
+                int last = std::min(this->cols(), (int)MAX_COLS) - 1;
+                int c = this->col_ + 1;
+                while (c < last && !this->tab_stops_[c])
+                    c++;
+                this->col_ = std::max(this->col_, std::min(c, this->cols() - 1));
+                break;
+            }
+            case 0x0A: // LF, VT, FF
+            case 0x0B:
+            case 0x0C:
+                this->index();
+                if (this->newline_mode_)
+                    this->col_ = 0;
+                break;
+            case 0x0D: // CR
+                this->col_ = 0;
+                this->wrap_pending_ = false;
+                break;
+            case 0x0E: // SO
+                this->active_charset_ = 1;
+                break;
+            case 0x0F: // SI
+                this->active_charset_ = 0;
+                break;
+            default: // BEL and the rest have nothing to show
+                break;
+            }
+        }
+
+        void VtParser::esc_dispatch(uint8_t final)
+        {
+            if (this->intermediate_ == '(' || this->intermediate_ == ')')
+            {
+                this->charset_[this->intermediate_ == ')'] = final;
+                return;
+            }
+            if (this->intermediate_ == '#' && final == '8')
+            {
+                this->decaln();
+                return;
+            }
+            if (this->intermediate_ != 0)
+            {
+                this->unsupported_++;
+                return;
+            }
+            switch (final)
+            {
+            case '7': // DECSC
+                this->save_cursor();
+                break;
+            case '8': // DECRC
+                this->restore_cursor();
+                break;
+            case 'D': // IND
+                this->index();
+                break;
+            case 'E': // NEL
+                this->index();
+                this->col_ = 0;
+                break;
+            case 'M': // RI
+                this->reverse_index();
+                break;
+            case 'H': // HTS
+                if (this->col_ < (int)MAX_COLS)
+                    this->tab_stops_[this->col_] = 1;
+                break;
+            case 'c': // RIS
+                this->reset();
+                break;
+            case '=': // keypad modes only affect what keys send
+            case '>':
+            case '\\': // ST closing a skipped string
+                break;
+            default:
+                this->unsupported_++;
+                break;
+            }
+        }
+
+        void VtParser::csi_dispatch(uint8_t final)
+        {
+            if (final != 'm')
+                this->wrap_pending_ = false;
+            if (this->prefix_ == '?' && this->intermediate_ == 0 && (final == 'h' || final == 'l'))
+            {
+                this->set_mode(final == 'h');
+                return;
+            }
+            if (this->prefix_ != 0 || this->intermediate_ != 0)
+            {
+                this->unsupported_++;
+                return;
+            }
+            int n = this->param(0, 1);
+            switch (final)
+            {
+            case 'A': // CUU, stops at the top margin when starting below it
+                this->row_ = std::max(this->row_ - n, this->row_ >= this->top_ ? this->top_ : 0);
+                break;
+            case 'B': // CUD
+                this->row_ = std::min(this->row_ + n, this->row_ <= this->bottom_ ? this->bottom_ : this->rows() - 1);
+                break;
+            case 'C': // CUF
+            case 'a':
+                this->col_ = std::min(this->col_ + n, this->cols() - 1);
+                break;
+            case 'D': // CUB
+                this->col_ = std::max(this->col_ - n, 0);
+                break;
+            case 'E': // CNL
+                this->row_ = std::min(this->row_ + n, this->row_ <= this->bottom_ ? this->bottom_ : this->rows() - 1);
+                this->col_ = 0;
+                break;
+            case 'F': // CPL
+                this->row_ = std::max(this->row_ - n, this->row_ >= this->top_ ? this->top_ : 0);
+                this->col_ = 0;
+                break;
+            case 'G': // CHA
+            case '`':
+                this->col_ = std::min(n, this->cols()) - 1;
+                break;
+            case 'H': // CUP
+            case 'f':
+                this->move_to(n - 1, this->param(1, 1) - 1);
+                break;
+            case 'd': // VPA
+                this->move_to(n - 1, this->col_);
+                break;
+            case 'J': // ED
+            {
+                int mode = this->param(0, 0);
+                int first = mode == 0 ? this->row_ + 1 : 0;
+                int last = mode == 1 ? this->row_ - 1 : this->rows() - 1;
+                if (mode == 0)
+                    this->clear_row(this->row_, this->col_, this->cols() - 1);
+                else if (mode == 1)
+                    this->clear_row(this->row_, 0, this->col_);
+                else
+                    first = 0, last = this->rows() - 1;
+                for (int r = first; r <= last; ++r)
+                    this->clear_row(r, 0, this->cols() - 1);
+                break;
+            }
+            case 'K': // EL
+            {
+                int mode = this->param(0, 0);
+                this->clear_row(this->row_, mode == 0 ? this->col_ : 0, mode == 1 ? this->col_ : this->cols() - 1);
+                break;
+            }
+            case 'L': // IL
+            case 'M': // DL
+                if (this->row_ >= this->top_ && this->row_ <= this->bottom_)
+                {
+                    this->scroll_region(this->row_, this->bottom_, final == 'L' ? -n : n);
+                    this->col_ = 0;
+                }
+                break;
+            case '@': // ICH
+                this->insert_chars(n);
+                break;
+            case 'P': // DCH
+                this->delete_chars(n);
+                break;
+            case 'X': // ECH
+                this->clear_row(this->row_, this->col_, std::min(this->col_ + n, this->cols()) - 1);
+                break;
+            case 'S': // SU
+                this->scroll_region(this->top_, this->bottom_, n);
+                break;
+            case 'T': // SD
+                this->scroll_region(this->top_, this->bottom_, -n);
+                break;
+            case 'r': // DECSTBM
+            {
+                int top = this->param(0, 1) - 1;
+                int bottom = std::min(this->param(1, this->rows()), this->rows()) - 1;
+                if (top < bottom)
+                {
+                    this->top_ = top;
+                    this->bottom_ = bottom;
+                    this->move_to(0, 0);
+                }
+                break;
+            }
+            case 'm':
+                this->sgr();
+                break;
+            case 's':
+                this->save_cursor();
+                break;
+            case 'u':
+                this->restore_cursor();
+                break;
+            case 'g': // TBC
+                if (this->param(0, 0) == 3)
+                    std::fill(this->tab_stops_, this->tab_stops_ + MAX_COLS, 0);
+                else if (this->param(0, 0) == 0 && this->col_ < (int)MAX_COLS)
+                    this->tab_stops_[this->col_] = 0;
+                break;
+            case 'h': // SM, RM: only LNM
+            case 'l':
+                if (this->param(0, 0) == 20)
+                    this->newline_mode_ = final == 'h';
+                else
+                    this->unsupported_++;
+                break;
+            case 'c': // DA, DSR and friends want a reply; there is no channel back
+            case 'n':
+                break;
+            default:
+                this->unsupported_++;
+                break;
+            }
+        }
+
+        void VtParser::set_mode(bool on)
+        {
+            for (size_t i = 0; i < std::max(this->param_count_, (size_t)1); ++i)
+            {
+                switch (this->params_[i])
+                {
+                case 1: // DECCKM: cursor keys, input only
+                case 12: // blinking cursor
+                case 2004: // bracketed paste
+                    break;
+                case 3: // DECCOLM: the width is fixed, but the switch clears the screen
+                    this->top_ = 0;
+                    this->bottom_ = this->rows() - 1;
+                    this->grid_->clear();
+                    this->move_to(0, 0);
+                    break;
+                case 6: // DECOM
+                    this->origin_ = on;
+                    this->move_to(0, 0);
+                    break;
+                case 7: // DECAWM
+                    this->autowrap_ = on;
+                    break;
+                case 25: // DECTCEM
+                    this->cursor_visible_ = on;
+                    break;
+                case 47: // alternate screen: no second buffer, so it is cleared instead
+                case 1047:
+                case 1049:
+                    if (on)
+                        this->save_cursor();
+                    this->grid_->clear();
+                    if (!on)
+                        this->restore_cursor();
+                    break;
+                default:
+                    this->unsupported_++;
+                    break;
+                }
+            }
+        }
+
+        // Colours and intensity have no place on the monochrome panel; only inverse
+        // and underline are kept. Extended colours skip their sub-parameters.
+        void VtParser::sgr()
+        {
+            if (this->param_count_ == 0)
+                this->attr_ = CELL_ATTR_NONE;
+            for (size_t i = 0; i < this->param_count_; ++i)
+            {
+                switch (this->params_[i])
+                {
+                case 0:
+                    this->attr_ = CELL_ATTR_NONE;
+                    break;
+                case 4:
+                    this->attr_ |= CELL_ATTR_UNDERLINE;
+                    break;
+                case 7:
+                    this->attr_ |= CELL_ATTR_INVERSE;
+                    break;
+                case 24:
+                    this->attr_ &= ~CELL_ATTR_UNDERLINE;
+                    break;
+                case 27:
+                    this->attr_ &= ~CELL_ATTR_INVERSE;
+                    break;
+                case 38:
+                case 48:
+                case 58:
+                    if (i + 1 < this->param_count_)
+                        i += this->params_[i + 1] == 5 ? 2 : this->params_[i + 1] == 2 ? 4 : 1;
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+
+        void VtParser::decaln()
+        {
+            for (int r = 0; r < this->rows(); ++r)
+                for (int c = 0; c < this->cols(); ++c)
+                    this->grid_->set_cell(r, c, 'E');
+            this->top_ = 0;
+            this->bottom_ = this->rows() - 1;
+            this->row_ = this->col_ = 0;
+        }
+
+        void VtParser::save_cursor()
+        {
+            this->saved_.row = this->row_;
+            this->saved_.col = this->col_;
+            this->saved_.attr = this->attr_;
+            this->saved_.origin = this->origin_;
+            this->saved_.wrap_pending = this->wrap_pending_;
+            this->saved_.charset[0] = this->charset_[0];
+            this->saved_.charset[1] = this->charset_[1];
+            this->saved_.active_charset = this->active_charset_;
+        }
+
+        void VtParser::restore_cursor()
+        {
+            this->row_ = std::min(this->saved_.row, this->rows() - 1);
+            this->col_ = std::min(this->saved_.col, this->cols() - 1);
+            this->attr_ = this->saved_.attr;
+            this->origin_ = this->saved_.origin;
+            this->wrap_pending_ = this->saved_.wrap_pending;
+            this->charset_[0] = this->saved_.charset[0];
+            this->charset_[1] = this->saved_.charset[1];
+            this->active_charset_ = this->saved_.active_charset;
+        }
+
+        void VtParser::index()
+        {
+            this->wrap_pending_ = false;
+            if (this->row_ == this->bottom_)
+                this->scroll_region(this->top_, this->bottom_, 1);
+            else if (this->row_ < this->rows() - 1)
+                this->row_++;
+        }
+
+        void VtParser::reverse_index()
+        {
+            this->wrap_pending_ = false;
+            if (this->row_ == this->top_)
+                this->scroll_region(this->top_, this->bottom_, -1);
+            else if (this->row_ > 0)
+                this->row_--;
+        }
+
+        void VtParser::scroll_region(size_t top, size_t bottom, int delta)
+        {
+            size_t count = bottom - top + 1;
+            size_t n = std::min((size_t)(delta < 0 ? -delta : delta), count);
+            if (n < count)
+            {
+                if (this->scroll_)
+                    this->scroll_(top, count, delta);
+                else
+                    this->grid_->scroll_rows(top, count, delta);
+            }
+            // The move leaves the uncovered rows as they were; they come up blank
+            size_t first = delta > 0 ? bottom + 1 - n : top;
+            for (size_t r = first; r < first + n; ++r)
+                this->clear_row(r, 0, this->cols() - 1);
+        }
+
+        // Row and column from CUP and friends, relative to the scroll region in origin mode
+        void VtParser::move_to(int row, int col)
+        {
+            if (this->origin_)
+                this->row_ = std::min(std::max(row + this->top_, this->top_), this->bottom_);
+            else
+                this->row_ = std::min(std::max(row, 0), this->rows() - 1);
+            this->col_ = std::min(std::max(col, 0), this->cols() - 1);
+            this->wrap_pending_ = false;
+        }
+
+        void VtParser::clear_row(size_t row, size_t from, size_t to)
+        {
+            for (size_t c = from; c <= to; ++c)
+                this->grid_->set_cell(row, c, ' ');
+        }
+
+        void VtParser::insert_chars(size_t n)
+        {
+            size_t cols = this->cols();
+            n = std::min(n, cols - this->col_);
+            for (size_t c = cols - 1; c >= this->col_ + n; --c)
+            {
+                TerminalCell cell = this->grid_->cell(this->row_, c - n);
+                this->grid_->set_cell(this->row_, c, cell.ch, cell.attr);
+            }
+            this->clear_row(this->row_, this->col_, this->col_ + n - 1);
+        }
+
+        void VtParser::delete_chars(size_t n)
+        {
+            size_t cols = this->cols();
+            n = std::min(n, cols - this->col_);
+            for (size_t c = this->col_; c + n < cols; ++c)
+            {
+                TerminalCell cell = this->grid_->cell(this->row_, c + n);
+                this->grid_->set_cell(this->row_, c, cell.ch, cell.attr);
+            }
+            this->clear_row(this->row_, cols - n, cols - 1);
+        }
+    } // namespace robco_display
+} // namespace esphome
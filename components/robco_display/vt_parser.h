@@ -0,0 +1,119 @@
+#ifndef VT_PARSER_H
+#define VT_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "terminal_grid.h"
+
+namespace esphome
+{
+    namespace robco_display
+    {
+        // VT100/ANSI escape sequence interpreter writing into a TerminalGrid.
+        // Covers what full-screen programs and vttest's basic screens use: C0
+        // controls, cursor movement and save/restore, erase in line and display,
+        // insert/delete of lines and characters, scroll regions, origin and
+        // autowrap modes, tab stops, SGR inverse and underline, and the DEC line
+        // drawing set. Colours and other attributes the panel cannot show are
+        // parsed and ignored. UTF-8 characters outside ASCII are shown as '?'.
+        //
+        // Cells change only through TerminalGrid::set_cell, so the renderer
+        // redraws just the cells whose contents differ.
+        class VtParser
+        {
+        public:
+            static constexpr size_t MAX_PARAMS = 16;
+            static constexpr size_t MAX_COLS = 256;
+            // Moves rows top..top+rows-1 up by delta (down if negative), like
+            // TerminalGrid::scroll_rows; the renderer moves the drawn pixels too
+            using ScrollFn = std::function<void(size_t top, size_t rows, int delta)>;
+
+            void attach(TerminalGrid *grid, ScrollFn scroll);
+            // LF also returns the carriage (LNM), for streams that end lines with \n only
+            void set_newline_mode(bool enabled) { newline_mode_default_ = enabled; }
+            // Full reset (RIS): blank screen, cursor home, default modes
+            void reset();
+            void feed(const uint8_t *data, size_t len);
+
+            int cursor_row() const { return cursor_visible_ ? row_ : -1; }
+            int cursor_col() const { return col_; }
+            // Sequences parsed but not implemented, since boot
+            uint32_t unsupported() const { return unsupported_; }
+
+        private:
+            enum class State : uint8_t
+            {
+                GROUND,
+                ESCAPE,
+                ESCAPE_INTERMEDIATE,
+                CSI_PARAM,
+                CSI_IGNORE,
+                STRING, // OSC, DCS, APC, PM, SOS: skipped up to ST or BEL
+                UTF8,
+            };
+
+            struct SavedCursor
+            {
+                int row = 0;
+                int col = 0;
+                uint8_t attr = CELL_ATTR_NONE;
+                bool origin = false;
+                bool wrap_pending = false;
+                uint8_t charset[2] = {'B', 'B'};
+                uint8_t active_charset = 0;
+            };
+
+            void print(uint8_t ch);
+            void control(uint8_t ch);
+            void esc_dispatch(uint8_t final);
+            void csi_dispatch(uint8_t final);
+            void sgr();
+            void decaln();
+            void save_cursor();
+            void restore_cursor();
+            void set_mode(bool on);
+            int param(size_t i, int def) const { return i < param_count_ && params_[i] > 0 ? params_[i] : def; }
+
+            void index();
+            void reverse_index();
+            void scroll_region(size_t top, size_t bottom, int delta);
+            void move_to(int row, int col);
+            void clear_row(size_t row, size_t from, size_t to);
+            void insert_chars(size_t n);
+            void delete_chars(size_t n);
+            int rows() const { return (int)grid_->rows(); }
+            int cols() const { return (int)grid_->cols(); }
+
+            TerminalGrid *grid_ = nullptr;
+            ScrollFn scroll_;
+            State state_ = State::GROUND;
+            uint8_t utf8_remaining_ = 0;
+            uint16_t params_[MAX_PARAMS] = {};
+            size_t param_count_ = 0;
+            // Private parameter prefix such as '?', 0 if none
+            uint8_t prefix_ = 0;
+            uint8_t intermediate_ = 0;
+
+            int row_ = 0;
+            int col_ = 0;
+            int top_ = 0;
+            int bottom_ = 0;
+            uint8_t attr_ = CELL_ATTR_NONE;
+            // Set after printing in the last column; the next printable wraps first
+            bool wrap_pending_ = false;
+            bool autowrap_ = true;
+            bool origin_ = false;
+            bool newline_mode_ = false;
+            bool newline_mode_default_ = false;
+            bool cursor_visible_ = true;
+            // G0/G1 designations: 'B' is ASCII, '0' DEC line drawing
+            uint8_t charset_[2] = {'B', 'B'};
+            uint8_t active_charset_ = 0;
+            SavedCursor saved_;
+            uint8_t tab_stops_[MAX_COLS] = {};
+            uint32_t unsupported_ = 0;
+        };
+    } // namespace robco_display
+} // namespace esphome
+#endif // VT_PARSER_H
@@ -0,0 +1,297 @@
+#include "bench.h"
+#include "../components/robco_display/glyph_atlas.h"
+#include "../components/robco_display/glyph_blitter.h"
+#include "../components/robco_display/menu_state.h"
+#include "bsp.h"
+#include "sim_platform.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Compiled in the same way crt_terminal_renderer.cpp does
+#include "../components/robco_display/FSEX302.c"
+
+using esphome::robco_display::GlyphAtlas;
+using esphome::robco_display::GlyphAtlasMode;
+using esphome::robco_display::GlyphBlitter;
+
+namespace
+{
+    const uint8_t KEY_ENTER = 0x28, KEY_ESC = 0x29, KEY_PAGE_UP = 0x4B, KEY_PAGE_DOWN = 0x4E, KEY_DOWN = 0x51,
+                  KEY_UP = 0x52;
+    const size_t SCREEN_LINES = 20;
+    const char *const BENCH_HEADER[] = {"BENCH", "-----"};
+    const char *const BENCH_BOOT[] = {"boot"};
+
+    class Timer
+    {
+    public:
+        Timer() : start_(std::chrono::steady_clock::now()), allocs_(sim_alloc_count()) {}
+        double ns() const
+        {
+            return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                                 start_)
+                .count();
+        }
+        uint64_t allocs() const { return sim_alloc_count() - allocs_; }
+
+    private:
+        std::chrono::steady_clock::time_point start_;
+        uint64_t allocs_;
+    };
+
+    // What render_menu() takes from the view after each change: the shift and
+    // the dirty lines. Returns the number of lines to redraw.
+    size_t consume(MenuState &menu, size_t &shifted)
+    {
+        menu.update_view();
+        shifted += menu.take_scroll().delta != 0;
+        return __builtin_popcount(menu.take_dirty_lines());
+    }
+
+    // A menu laid out as menu_tables.py lays it out: the root, then sqrt(nodes)
+    // submenus with the same number of actions each, every action with an id
+    struct GeneratedMenu
+    {
+        std::vector<std::string> titles, ids;
+        std::vector<MenuNode> nodes;
+        std::vector<MenuIdIndex> index;
+        MenuDefinition definition = {};
+
+        explicit GeneratedMenu(size_t count)
+        {
+            size_t menus = (size_t)std::sqrt((double)count);
+            size_t items = (count - 1 - menus) / menus;
+            count = 1 + menus + menus * items;
+            titles.reserve(count);
+            ids.reserve(count);
+            nodes.resize(count);
+            nodes[0] = {"", nullptr, "", MenuEntry::Type::SUBMENU, -1, 1, (int16_t)menus, -1, 1, 0, 0, -1};
+            for (size_t m = 0; m < menus; ++m)
+            {
+                int16_t self = (int16_t)(1 + m), first = (int16_t)(1 + menus + m * items);
+                titles.push_back("Menu " + std::to_string(m));
+                nodes[self] = {titles.back().c_str(), nullptr, "", MenuEntry::Type::SUBMENU, 0, items ? first : (int16_t)-1, (int16_t)items,
+                               m + 1 < menus ? (int16_t)(self + 1) : (int16_t)-1, items ? first : (int16_t)-1,
+                               m + 1 < menus ? (int16_t)(self + 1) : (int16_t)1,
+                               m > 0 ? (int16_t)(self - 1) : (int16_t)menus, -1};
+                for (size_t i = 0; i < items; ++i)
+                {
+                    int16_t node = (int16_t)(first + i);
+                    titles.push_back("Action " + std::to_string(m) + "." + std::to_string(i));
+                    ids.push_back("action_" + std::to_string(node));
+                    nodes[node] = {titles.back().c_str(), ids.back().c_str(), "", MenuEntry::Type::ACTION, self,
+                                   -1, 0, i + 1 < items ? (int16_t)(node + 1) : (int16_t)-1, -1,
+                                   i + 1 < items ? (int16_t)(node + 1) : first,
+                                   i > 0 ? (int16_t)(node - 1) : (int16_t)(first + items - 1), -1};
+                }
+            }
+            for (const std::string &id : ids)
+                index.push_back({id.c_str(), (int16_t)atoi(id.c_str() + 7)});
+            std::sort(index.begin(), index.end(), [](const MenuIdIndex &a, const MenuIdIndex &b)
+                      { return strcmp(a.id, b.id) < 0; });
+            definition = {BENCH_HEADER, 2, BENCH_BOOT, 1, nodes.data(), nodes.size(), index.data(), index.size()};
+        }
+    };
+
+    // RAM-backed partition, as large as the benchmark needs
+    class RamPartition : public LogPartition
+    {
+    public:
+        explicit RamPartition(size_t sectors) : bytes_(sectors * 4096, 0xFF) {}
+        size_t size() const override { return bytes_.size(); }
+        size_t sector_size() const override { return 4096; }
+        bool read(size_t offset, void *dst, size_t len) override
+        {
+            memcpy(dst, bytes_.data() + offset, len);
+            return true;
+        }
+        bool write(size_t offset, const void *src, size_t len) override
+        {
+            for (size_t i = 0; i < len; ++i)
+                bytes_[offset + i] &= ((const uint8_t *)src)[i];
+            return true;
+        }
+        bool erase_sector(size_t sector) override
+        {
+            memset(bytes_.data() + sector * 4096, 0xFF, 4096);
+            return true;
+        }
+
+    private:
+        std::vector<uint8_t> bytes_;
+    };
+} // namespace
+
+bool bench_glyphs(size_t glyphs)
+{
+    GlyphBlitter blitter;
+    if (!blitter.init(&fixedsys))
+        return false;
+    const int cols = BSP_LCD_H_RES / GlyphBlitter::CELL_W, rows = BSP_LCD_V_RES / GlyphBlitter::CELL_H;
+    std::vector<uint16_t> frame(BSP_LCD_H_RES * BSP_LCD_V_RES);
+    const uint16_t fg = 0x07E0, bg = 0x0000;
+    for (GlyphAtlasMode mode : {GlyphAtlasMode::NONE, GlyphAtlasMode::MASK, GlyphAtlasMode::RGB565})
+    {
+        GlyphAtlas atlas;
+        if (mode != GlyphAtlasMode::NONE && !atlas.build(blitter, mode, fg, bg))
+            return false;
+        Timer timer;
+        for (size_t i = 0; i < glyphs; ++i)
+        {
+            size_t cell = i % (cols * rows);
+            uint16_t *dst = frame.data() + cell / cols * GlyphBlitter::CELL_H * BSP_LCD_H_RES +
+                            cell % cols * GlyphBlitter::CELL_W;
+            char ch = (char)(GlyphBlitter::FIRST_CHAR + i % GlyphBlitter::NUM_CHARS);
+            if (mode == GlyphAtlasMode::NONE)
+                blitter.blit(dst, BSP_LCD_H_RES, ch, 0, fg, bg);
+            else
+                atlas.blit(dst, BSP_LCD_H_RES, ch, 0, fg, bg);
+        }
+        double ns = timer.ns();
+        printf("glyphs %-6s %zu in %.1f ms, %.2f M glyphs/s, %.0f ns/glyph, atlas %zu bytes\n",
+               mode == GlyphAtlasMode::NONE ? "font" : mode == GlyphAtlasMode::MASK ? "mask" : "rgb565", glyphs,
+               ns / 1e6, glyphs / ns * 1e3, ns / glyphs, atlas.size_bytes());
+    }
+    return true;
+}
+
+bool bench_menu(size_t nodes)
+{
+    if (nodes < 4 || nodes > MenuTree::kMaxNodes)
+        return false;
+    // Smaller menus first, for scale
+    const size_t sizes[] = {100, 1000, nodes};
+    for (size_t s = 0; s < 3; ++s)
+    {
+        size_t size = sizes[s];
+        if (s < 2 && size >= nodes)
+            continue;
+        GeneratedMenu generated(size);
+        MenuState menu;
+        menu.set_definition(generated.definition);
+        menu.set_screen_lines(SCREEN_LINES);
+        menu.on_key_press(KEY_ENTER); // ends the boot text
+        size_t shifted = 0;
+        consume(menu, shifted);
+
+        // Into every submenu, down its whole list and back out
+        const MenuNode &root = menu.get_menu_tree().node(MenuTree::kRoot);
+        size_t menus = 0;
+        for (int32_t n = root.first_child; n != MenuTree::kNoNode; n = menu.get_menu_tree().node(n).next_sibling)
+            menus++;
+        size_t per_menu = menu.get_menu_tree().child_count(root.first_child);
+        size_t presses = 0, lines = 0;
+        Timer timer;
+        for (size_t m = 0; m < menus; ++m)
+        {
+            menu.on_key_press(KEY_ENTER);
+            lines += consume(menu, shifted);
+            for (size_t i = 0; i < per_menu; ++i)
+            {
+                menu.on_key_press(KEY_DOWN);
+                lines += consume(menu, shifted);
+            }
+            menu.on_key_press(KEY_ESC);
+            lines += consume(menu, shifted);
+            menu.on_key_press(KEY_DOWN);
+            lines += consume(menu, shifted);
+            presses += per_menu + 3;
+        }
+        double key_ns = timer.ns();
+        uint64_t key_allocs = timer.allocs();
+
+        const MenuTree &tree = menu.get_menu_tree();
+        size_t found = 0;
+        Timer lookup;
+        for (const MenuIdIndex &id : generated.index)
+            found += tree.find_id(id.id) == id.node;
+        double find_ns = lookup.ns();
+        printf("menu %zu nodes: %zu key presses, %.0f ns per press with update_view, %.1f lines redrawn, "
+               "%llu allocations; find_id %.0f ns over %zu ids%s\n",
+               generated.nodes.size(), presses, key_ns / presses, (double)lines / presses,
+               (unsigned long long)key_allocs, generated.index.empty() ? 0.0 : find_ns / generated.index.size(),
+               generated.index.size(), found == generated.index.size() ? "" : " (lookups FAILED)");
+        if (found != generated.index.size())
+            return false;
+    }
+    return true;
+}
+
+bool bench_scroll(size_t entries)
+{
+    // A log view is the only list that gets this long; menus stop at 32k nodes
+    static const MenuNode nodes[] = {
+        {"", nullptr, "", MenuEntry::Type::SUBMENU, -1, 1, 1, -1, 1, 0, 0, -1},
+        {"Event Log", nullptr, "", MenuEntry::Type::LOGS, 0, -1, 0, -1, -1, 1, 1, -1}};
+    const MenuDefinition definition = {BENCH_HEADER, 2, BENCH_BOOT, 1, nodes, 2, nullptr, 0};
+    char text[LogStore::kMaxEntryLength + 1];
+    size_t len = (size_t)snprintf(text, sizeof(text), "%08zu vault door cycled", entries);
+
+    // Grow the partition until the ring holds every entry
+    std::unique_ptr<RamPartition> flash;
+    LogStore store;
+    for (size_t sectors = entries * (len + 8) / 4096 + 2;; sectors += sectors / 8 + 1)
+    {
+        flash = std::make_unique<RamPartition>(sectors);
+        LogStore probe;
+        if (probe.mount(flash.get()) && probe.capacity(len) >= entries)
+            break;
+    }
+    if (!store.mount(flash.get()))
+        return false;
+    for (size_t i = 0; i < entries; ++i)
+    {
+        len = (size_t)snprintf(text, sizeof(text), "%08zu vault door %s", i, i % 2 ? "opened" : "closed");
+        store.append(text, len);
+    }
+
+    MenuState menu;
+    menu.set_definition(definition);
+    menu.set_log_store(&store);
+    menu.set_screen_lines(SCREEN_LINES);
+    menu.on_key_press(KEY_ENTER); // ends the boot text
+    menu.on_key_press(KEY_ENTER); // opens the log at its newest entry
+    size_t shifted = 0;
+    consume(menu, shifted);
+    // Page to the oldest entry, line-scroll a stretch, page back to the
+    // newest and line-scroll again; pages and lines are counted apart
+    struct Scrolls
+    {
+        size_t updates = 0, lines = 0, shifted = 0;
+        double ns = 0;
+        uint64_t allocs = 0;
+    } pages, steps;
+    auto press = [&](Scrolls &s, uint8_t key)
+    {
+        Timer timer;
+        menu.on_key_press(key);
+        s.lines += consume(menu, s.shifted);
+        s.ns += timer.ns();
+        s.allocs += timer.allocs();
+        s.updates++;
+    };
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        size_t last = SIZE_MAX;
+        while (menu.get_viewport().offset() != last)
+        {
+            last = menu.get_viewport().offset();
+            press(pages, pass == 0 ? KEY_PAGE_UP : KEY_PAGE_DOWN);
+        }
+        for (int i = 0; i < 1000; ++i)
+            press(steps, pass == 0 ? KEY_DOWN : KEY_UP);
+    }
+    for (const Scrolls *s : {&pages, &steps})
+        printf("scroll %zu entries, %s: %zu updates, %.0f ns per update, %.2f lines redrawn per update, "
+               "%zu shifted, %llu allocations\n",
+               store.count(), s == &pages ? "page" : "line", s->updates, s->ns / s->updates,
+               (double)s->lines / s->updates, s->shifted, (unsigned long long)s->allocs);
+    return store.count() == entries;
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include <stddef.h>
+
+// Component benchmarks behind the bench script command. Each builds its own
+// objects instead of using the running display, so the numbers are the code
+// under test alone, and prints one line per variant. Times are host CPU time.
+
+// Draw glyphs cells into an 800x480 buffer decoding the font, then through
+// the mask and RGB565 atlases; prints glyphs per second for each
+bool bench_glyphs(size_t glyphs);
+// Key presses and id lookups on generated menus of 100, 1000 and nodes nodes
+bool bench_menu(size_t nodes);
+// Line and page scrolls through a log view of entries entries
+bool bench_scroll(size_t entries);
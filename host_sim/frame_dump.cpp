@@ -0,0 +1,142 @@
+#include "frame_dump.h"
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Expand to 8 bits per channel by replicating the high bits, so full green stays 255
+static void to_rgb888(uint16_t c, uint8_t *rgb)
+{
+    uint8_t r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+bool write_ppm(const char *path, const uint16_t *pixels, size_t width, size_t height)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == nullptr)
+        return false;
+    fprintf(f, "P6\n%u %u\n255\n", (unsigned)width, (unsigned)height);
+    std::vector<uint8_t> row(width * 3);
+    bool ok = true;
+    for (size_t y = 0; y < height && ok; ++y)
+    {
+        for (size_t x = 0; x < width; ++x)
+            to_rgb888(pixels[y * width + x], &row[x * 3]);
+        ok = fwrite(row.data(), 1, row.size(), f) == row.size();
+    }
+    return fclose(f) == 0 && ok;
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t len)
+{
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *data++;
+        for (int k = 0; k < 8; ++k)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+static void put_be32(std::vector<uint8_t> &out, uint32_t v)
+{
+    uint8_t b[4] = {(uint8_t)(v >> 24), (uint8_t)(v >> 16), (uint8_t)(v >> 8), (uint8_t)v};
+    out.insert(out.end(), b, b + 4);
+}
+
+static void put_chunk(std::vector<uint8_t> &out, const char *type, const std::vector<uint8_t> &data)
+{
+    put_be32(out, data.size());
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    put_be32(out, crc32(0, &out[start], out.size() - start));
+}
+
+// Stored (uncompressed) deflate blocks keep the writer tiny; frames are ~1.1 MB
+bool write_png(const char *path, const uint16_t *pixels, size_t width, size_t height)
+{
+    std::vector<uint8_t> raw;
+    raw.reserve(height * (width * 3 + 1));
+    for (size_t y = 0; y < height; ++y)
+    {
+        raw.push_back(0); // filter: none
+        for (size_t x = 0; x < width; ++x)
+        {
+            uint8_t rgb[3];
+            to_rgb888(pixels[y * width + x], rgb);
+            raw.insert(raw.end(), rgb, rgb + 3);
+        }
+    }
+    std::vector<uint8_t> z = {0x78, 0x01};
+    for (size_t pos = 0; pos < raw.size() || pos == 0;)
+    {
+        size_t len = std::min<size_t>(raw.size() - pos, 65535);
+        bool last = pos + len == raw.size();
+        uint8_t header[5] = {(uint8_t)last, (uint8_t)len, (uint8_t)(len >> 8), (uint8_t)~len, (uint8_t)(~len >> 8)};
+        z.insert(z.end(), header, header + 5);
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+        if (last)
+            break;
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : raw)
+    {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_be32(z, (b << 16) | a);
+
+    std::vector<uint8_t> ihdr;
+    put_be32(ihdr, width);
+    put_be32(ihdr, height);
+    const uint8_t format[5] = {8, 2, 0, 0, 0}; // 8-bit RGB, deflate, no interlace
+    ihdr.insert(ihdr.end(), format, format + 5);
+    std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    put_chunk(png, "IHDR", ihdr);
+    put_chunk(png, "IDAT", z);
+    put_chunk(png, "IEND", {});
+
+    FILE *f = fopen(path, "wb");
+    if (f == nullptr)
+        return false;
+    bool ok = fwrite(png.data(), 1, png.size(), f) == png.size();
+    return fclose(f) == 0 && ok;
+}
+
+long compare_ppm(const char *path, const uint16_t *pixels, size_t width, size_t height)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr)
+        return -1;
+    unsigned w = 0, h = 0, max = 0;
+    if (fscanf(f, "P6 %u %u %u", &w, &h, &max) != 3 || fgetc(f) == EOF || w != width || h != height || max != 255)
+    {
+        fclose(f);
+        return -1;
+    }
+    std::vector<uint8_t> row(width * 3);
+    long diffs = 0;
+    for (size_t y = 0; y < height; ++y)
+    {
+        if (fread(row.data(), 1, row.size(), f) != row.size())
+        {
+            fclose(f);
+            return -1;
+        }
+        for (size_t x = 0; x < width; ++x)
+        {
+            uint8_t rgb[3];
+            to_rgb888(pixels[y * width + x], rgb);
+            if (memcmp(rgb, &row[x * 3], 3) != 0)
+                diffs++;
+        }
+    }
+    fclose(f);
+    return diffs;
+}
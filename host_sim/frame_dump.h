@@ -0,0 +1,10 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Write an RGB565 image as binary PPM (P6) or as an uncompressed PNG
+bool write_ppm(const char *path, const uint16_t *pixels, size_t width, size_t height);
+bool write_png(const char *path, const uint16_t *pixels, size_t width, size_t height);
+// Load a P6 PPM written by write_ppm and count pixels that differ from pixels;
+// returns -1 if the file is missing or has another size
+long compare_ppm(const char *path, const uint16_t *pixels, size_t width, size_t height);
@@ -0,0 +1,37 @@
+/* LVGL settings for the host simulator: the options robco_display relies on
+ * from the device's sdkconfig (16-bit colour, canvas, labels), no OS layer
+ * since every LVGL call happens under the simulated port lock */
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH 16
+
+#define LV_USE_STDLIB_MALLOC LV_STDLIB_CLIB
+#define LV_USE_STDLIB_STRING LV_STDLIB_CLIB
+#define LV_USE_STDLIB_SPRINTF LV_STDLIB_CLIB
+
+#define LV_USE_OS LV_OS_NONE
+#define LV_DEF_REFR_PERIOD 33
+#define LV_DPI_DEF 130
+
+#define LV_DRAW_BUF_STRIDE_ALIGN 1
+#define LV_DRAW_BUF_ALIGN 4
+#define LV_USE_DRAW_SW 1
+#define LV_DRAW_SW_SUPPORT_RGB565 1
+#define LV_DRAW_SW_COMPLEX 1
+
+#define LV_USE_LOG 0
+#define LV_USE_ASSERT_NULL 1
+#define LV_USE_ASSERT_MALLOC 1
+
+#define LV_FONT_MONTSERRAT_14 1
+#define LV_FONT_DEFAULT &lv_font_montserrat_14
+
+#define LV_USE_LABEL 1
+#define LV_USE_CANVAS 1
+#define LV_USE_IMAGE 1
+
+#define LV_BUILD_EXAMPLES 0
+#define LV_USE_DEMO_WIDGETS 0
+
+#endif /* LV_CONF_H */
@@ -0,0 +1,512 @@
+// Headless robco_display: runs the component, the render task and LVGL against
+// the simulated panel, driven by a script of key presses and MQTT-style updates.
+// Time is virtual, so a script produces the same frames on every run; the
+// reported loop times are real host CPU time.
+#include "../components/pico_io_extension/pico_io_extension.h"
+#include "../components/robco_display/robco_display_component.h"
+#include "bench.h"
+#include "esp_timer.h"
+#include "frame_dump.h"
+#include "sim_menu.h"
+#include "sim_platform.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using esphome::pico_io_extension::PicoIOExtension;
+using esphome::robco_display::GlyphAtlasMode;
+using esphome::robco_display::RenderMode;
+using esphome::robco_display::RobcoDisplayComponent;
+
+static const char *USAGE =
+    "usage: robco_sim [options] [script]\n"
+    "  -e COMMANDS     run ';'-separated commands after the script\n"
+    "  -o DIR          where dump writes frames (default .)\n"
+    "  -g DIR          reference frames for check (default: the -o directory)\n"
+    "  --ppm           dump PPM instead of PNG\n"
+    "  --flash FILE    keep the log partition in FILE across runs\n"
+    "  --mode MODE     cell_grid (default) or labels\n"
+    "  --atlas MODE    none, mask (default) or rgb565\n"
+    "  --crt-effects   enable crt_effects with their default settings\n"
+    "  --scanout       enable scanout_effects with their default settings\n"
+    "  --step MS       loop interval in virtual time (default 16)\n"
+    "  --no-trace      turn render pipeline timing off\n"
+    "  -q, -v          fewer / more log output\n"
+    "script commands, one per line, '#' starts a comment:\n"
+    "  wait MS                  run the loop for MS of virtual time\n"
+    "  key NAME [REPEAT]        up down left right enter esc backspace pgup pgdn space, a-z, 0-9 or 0xNN\n"
+    "  type TEXT                one key press per character, a step apart\n"
+    "  status ID VALUE          set_menu_status(ID, VALUE)\n"
+    "  door STATE               set_vault_door_state(STATE)\n"
+    "  mqtt up|down             connect or disconnect the stand-in broker\n"
+    "  mqtt reply MS|off        answer door commands with the door state after MS (default 300)\n"
+    "  mqtt pub TOPIC PAYLOAD   deliver a message to the subscriptions matching TOPIC\n"
+    "  log TEXT                 add_log(TEXT)\n"
+    "  logs COUNT [PREFIX]      add COUNT numbered log entries\n"
+    "  dump NAME                write the current frame to DIR/NAME.png (or .ppm)\n"
+    "  check NAME               compare the current frame with the reference NAME.ppm\n"
+    "  stats                    print loop timing and allocations since the last stats\n"
+    "  trace                    log the render pipeline timing since the last trace\n"
+    "  terminal open|close      enter or leave terminal mode (Esc also leaves)\n"
+    "  terminal feed FILE [N]   write FILE to the terminal N times in 1 KB chunks, print bytes/s\n"
+    "  bench glyphs [N]         draw N glyphs (default 1000000) from the font and both atlases\n"
+    "  bench menu [NODES]       key presses and id lookups on generated menus up to NODES (default 10000)\n"
+    "  bench scroll [ENTRIES]   page and line scrolls through a log view of ENTRIES (default 100000)\n";
+
+struct LoopStats
+{
+    uint64_t loops = 0;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    uint64_t allocs = 0;
+};
+
+class Simulator
+{
+public:
+    std::string frames_dir = ".";
+    std::string golden_dir;
+    bool ppm = false;
+    int64_t step_us = 16000;
+
+    Simulator(PicoIOExtension &pico, RobcoDisplayComponent &display) : pico_(pico), display_(display) {}
+
+    // Returns false on an unknown command or a failed check
+    bool run(const std::string &line, const char *where)
+    {
+        std::istringstream in(line);
+        std::string cmd;
+        if (!(in >> cmd) || cmd[0] == '#')
+            return true;
+        std::string rest;
+        std::getline(in >> std::ws, rest);
+        if (cmd == "wait")
+        {
+            long ms = atol(rest.c_str());
+            for (int64_t end = esp_timer_get_time() + ms * 1000; esp_timer_get_time() < end;)
+                this->step();
+            return true;
+        }
+        if (cmd == "key")
+        {
+            std::istringstream args(rest);
+            std::string name;
+            int repeat = 1;
+            args >> name >> repeat;
+            int code = keycode(name);
+            if (code < 0)
+                return fail(where, "unknown key '" + name + "'");
+            for (int i = 0; i < repeat; ++i)
+                this->press((uint8_t)code);
+            return true;
+        }
+        if (cmd == "type")
+        {
+            for (char c : rest)
+            {
+                int code = keycode(std::string(1, c == ' ' ? '_' : c));
+                if (code < 0)
+                    return fail(where, std::string("cannot type '") + c + "'");
+                this->press((uint8_t)code);
+            }
+            return true;
+        }
+        if (cmd == "status")
+        {
+            size_t split = rest.find(' ');
+            std::string id = rest.substr(0, split);
+            std::string value = split == std::string::npos ? "" : rest.substr(split + 1);
+            if (!display_.set_menu_status(id, value))
+                return fail(where, "no status entry '" + id + "'");
+            return true;
+        }
+        if (cmd == "door")
+        {
+            display_.set_vault_door_state(rest);
+            return true;
+        }
+        if (cmd == "mqtt")
+        {
+            if (rest == "up" || rest == "down")
+                sim_mqtt_set_connected(rest == "up");
+            else if (rest == "reply off")
+                reply_ms_ = -1;
+            else if (rest.compare(0, 6, "reply ") == 0)
+                reply_ms_ = atol(rest.c_str() + 6);
+            else if (rest.compare(0, 4, "pub ") == 0)
+            {
+                size_t split = rest.find(' ', 4);
+                std::string topic = rest.substr(4, split - 4);
+                std::string payload = split == std::string::npos ? "" : rest.substr(split + 1);
+                if (sim_mqtt_deliver(topic, payload) == 0)
+                    return fail(where, "no subscription matches " + topic);
+            }
+            else
+                return fail(where, "usage: mqtt up|down|reply MS|reply off|pub TOPIC PAYLOAD");
+            return true;
+        }
+        if (cmd == "log")
+        {
+            display_.add_log(rest);
+            return true;
+        }
+        if (cmd == "logs")
+        {
+            std::istringstream args(rest);
+            long count = 0;
+            std::string prefix = "Entry";
+            args >> count >> prefix;
+            for (long i = 0; i < count; ++i)
+                display_.add_log(prefix + " " + std::to_string(i));
+            return true;
+        }
+        if (cmd == "dump")
+            return this->dump(rest, where);
+        if (cmd == "check")
+            return this->check(rest, where);
+        if (cmd == "stats")
+        {
+            this->print_stats();
+            return true;
+        }
+        if (cmd == "trace")
+        {
+            display_.dump_trace();
+            return true;
+        }
+        if (cmd == "terminal")
+        {
+            std::istringstream args(rest);
+            std::string sub, path;
+            int repeat = 1;
+            args >> sub >> path >> repeat;
+            if (sub == "open")
+                display_.enter_terminal();
+            else if (sub == "close")
+                display_.exit_terminal();
+            else if (sub == "feed" && !path.empty())
+                return this->feed_terminal(path, repeat, where);
+            else
+                return fail(where, "usage: terminal open|close|feed FILE [REPEAT]");
+            this->step();
+            return true;
+        }
+        if (cmd == "bench")
+        {
+            std::istringstream args(rest);
+            std::string what;
+            long n = 0;
+            args >> what >> n;
+            bool ok;
+            if (what == "glyphs")
+                ok = bench_glyphs(n > 0 ? n : 1000000);
+            else if (what == "menu")
+                ok = bench_menu(n > 0 ? n : 10000);
+            else if (what == "scroll")
+                ok = bench_scroll(n > 0 ? n : 100000);
+            else
+                return fail(where, "usage: bench glyphs|menu|scroll [N]");
+            return ok || fail(where, "bench " + what + " failed");
+        }
+        return fail(where, "unknown command '" + cmd + "'");
+    }
+
+    void print_stats()
+    {
+        const LoopStats &s = stats_;
+        printf("t=%lld ms: %llu loops, %.1f us avg, %.1f us worst, %llu allocations\n",
+               (long long)(esp_timer_get_time() / 1000), (unsigned long long)s.loops,
+               s.loops ? s.total_ns / 1000.0 / s.loops : 0.0, s.max_ns / 1000.0, (unsigned long long)s.allocs);
+        stats_ = LoopStats();
+    }
+
+    // Loops run since stats were last printed
+    uint64_t pending_loops() const { return stats_.loops; }
+
+private:
+    static bool fail(const char *where, const std::string &message)
+    {
+        fprintf(stderr, "%s: %s\n", where, message.c_str());
+        return false;
+    }
+
+    // USB HID usage ids, as the Pico forwards them
+    static int keycode(const std::string &name)
+    {
+        static const struct
+        {
+            const char *name;
+            uint8_t code;
+        } named[] = {{"enter", 0x28}, {"esc", 0x29},  {"backspace", 0x2A}, {"space", 0x2C}, {"_", 0x2C},
+                     {"pgup", 0x4B},  {"pgdn", 0x4E}, {"right", 0x4F},     {"left", 0x50},  {"down", 0x51},
+                     {"up", 0x52}};
+        for (const auto &key : named)
+        {
+            if (name == key.name)
+                return key.code;
+        }
+        if (name.size() == 1 && name[0] >= 'a' && name[0] <= 'z')
+            return 0x04 + (name[0] - 'a');
+        if (name.size() == 1 && name[0] >= '1' && name[0] <= '9')
+            return 0x1E + (name[0] - '1');
+        if (name == "0")
+            return 0x27;
+        if (name.size() > 2 && name.compare(0, 2, "0x") == 0)
+            return (int)strtol(name.c_str(), nullptr, 16) & 0xFF;
+        return -1;
+    }
+
+    void press(uint8_t code)
+    {
+        sim_pico_press(code, 0);
+        this->step();
+    }
+
+    // One ESPHome loop iteration, then LVGL's timers and the panel, then time moves on
+    void step()
+    {
+        uint64_t allocs = sim_alloc_count();
+        auto start = std::chrono::steady_clock::now();
+        pico_.loop();
+        display_.loop();
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                          .count();
+        stats_.loops++;
+        stats_.total_ns += ns;
+        stats_.max_ns = std::max(stats_.max_ns, ns);
+        stats_.allocs += sim_alloc_count() - allocs;
+        this->broker_step();
+        sim_lvgl_step();
+        sim_panel_scan(sim_panel(), esp_timer_get_time());
+        sim_advance_time_us(step_us);
+    }
+
+    // Plays the Home Assistant automations from the README: a door command is
+    // answered with the new door state on garage/state
+    void broker_step()
+    {
+        std::string topic, payload;
+        while (sim_mqtt_take_publish(topic, payload))
+        {
+            const char *state = topic == "garage/door/open" ? "opened" : topic == "garage/door/close" ? "closed" : nullptr;
+            if (state != nullptr && reply_ms_ >= 0)
+                replies_.emplace_back(esp_timer_get_time() + reply_ms_ * 1000, state);
+        }
+        while (!replies_.empty() && replies_.front().first <= esp_timer_get_time())
+        {
+            display_.set_vault_door_state(replies_.front().second);
+            replies_.pop_front();
+        }
+    }
+
+    // Notifications are synchronous here, so each write returns once the render
+    // task has parsed and drawn it: the time is parse plus cell drawing, without
+    // the panel flush. A loop step every 16 KB lets LVGL refresh in between.
+    bool feed_terminal(const std::string &path, int repeat, const char *where)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return fail(where, "cannot read " + path);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (!display_.terminal_active())
+            return fail(where, "terminal is not open");
+        constexpr size_t chunk = 1024;
+        size_t bytes = 0, dropped = 0, since_step = 0;
+        uint64_t ns = 0;
+        for (int i = 0; i < repeat; ++i)
+        {
+            for (size_t at = 0; at < data.size(); at += chunk)
+            {
+                size_t len = std::min(chunk, data.size() - at);
+                auto start = std::chrono::steady_clock::now();
+                size_t taken = display_.write_terminal((const uint8_t *)data.data() + at, len);
+                ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                          .count();
+                bytes += taken;
+                dropped += len - taken;
+                since_step += len;
+                if (since_step >= 16 * 1024)
+                {
+                    since_step = 0;
+                    this->step();
+                }
+            }
+        }
+        this->step();
+        printf("terminal: %zu bytes in %.1f ms, %.0f KB/s, %zu dropped\n", bytes, ns / 1e6,
+               ns ? bytes / 1024.0 / (ns / 1e9) : 0.0, dropped);
+        return true;
+    }
+
+    // The frame as the panel would show it after pending redraws complete
+    const uint16_t *frame()
+    {
+        sim_lvgl_refresh_now();
+        sim_panel_scan_now(sim_panel());
+        return sim_panel_pixels(sim_panel());
+    }
+
+    bool dump(const std::string &name, const char *where)
+    {
+        std::string path = frames_dir + "/" + name + (ppm ? ".ppm" : ".png");
+        const uint16_t *pixels = this->frame();
+        bool ok = ppm ? write_ppm(path.c_str(), pixels, BSP_LCD_H_RES, BSP_LCD_V_RES)
+                      : write_png(path.c_str(), pixels, BSP_LCD_H_RES, BSP_LCD_V_RES);
+        if (!ok)
+            return fail(where, "cannot write " + path);
+        printf("wrote %s\n", path.c_str());
+        return true;
+    }
+
+    bool check(const std::string &name, const char *where)
+    {
+        std::string path = (golden_dir.empty() ? frames_dir : golden_dir) + "/" + name + ".ppm";
+        long diffs = compare_ppm(path.c_str(), this->frame(), BSP_LCD_H_RES, BSP_LCD_V_RES);
+        if (diffs < 0)
+            return fail(where, "no usable reference frame " + path);
+        if (diffs > 0)
+            return fail(where, name + ": " + std::to_string(diffs) + " pixels differ from " + path);
+        printf("%s matches\n", name.c_str());
+        return true;
+    }
+
+    PicoIOExtension &pico_;
+    RobcoDisplayComponent &display_;
+    LoopStats stats_;
+    long reply_ms_ = 300;
+    // Door states due from the stand-in broker, in time order
+    std::deque<std::pair<int64_t, std::string>> replies_;
+};
+
+int main(int argc, char **argv)
+{
+    std::vector<std::pair<std::string, std::string>> scripts; // (where, text)
+    std::string frames_dir = ".", golden_dir, flash_path;
+    RenderMode mode = RenderMode::CELL_GRID;
+    GlyphAtlasMode atlas = GlyphAtlasMode::MASK;
+    bool crt_effects = false, scanout = false, ppm = false, trace = true;
+    long step_ms = 16;
+    int log_level = 3;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "-e" && has_value)
+        {
+            std::string commands = argv[++i];
+            for (char &c : commands)
+                c = c == ';' ? '\n' : c;
+            scripts.emplace_back("-e", commands);
+        }
+        else if (arg == "-o" && has_value)
+            frames_dir = argv[++i];
+        else if (arg == "-g" && has_value)
+            golden_dir = argv[++i];
+        else if (arg == "--ppm")
+            ppm = true;
+        else if (arg == "--flash" && has_value)
+            flash_path = argv[++i];
+        else if (arg == "--mode" && has_value)
+        {
+            std::string value = argv[++i];
+            mode = value == "labels" ? RenderMode::LABELS : RenderMode::CELL_GRID;
+        }
+        else if (arg == "--atlas" && has_value)
+        {
+            std::string value = argv[++i];
+            atlas = value == "none" ? GlyphAtlasMode::NONE
+                    : value == "rgb565" ? GlyphAtlasMode::RGB565
+                                        : GlyphAtlasMode::MASK;
+        }
+        else if (arg == "--crt-effects")
+            crt_effects = true;
+        else if (arg == "--scanout")
+            scanout = true;
+        else if (arg == "--step" && has_value)
+            step_ms = std::max(1L, atol(argv[++i]));
+        else if (arg == "--no-trace")
+            trace = false;
+        else if (arg == "-q")
+            log_level--;
+        else if (arg == "-v")
+            log_level++;
+        else if (arg[0] != '-')
+        {
+            std::ifstream file(arg);
+            if (!file)
+            {
+                fprintf(stderr, "cannot read %s\n", arg.c_str());
+                return 2;
+            }
+            std::stringstream text;
+            text << file.rdbuf();
+            scripts.insert(scripts.begin(), {arg, text.str()});
+        }
+        else
+        {
+            fputs(USAGE, stderr);
+            return 2;
+        }
+    }
+    sim_set_log_level(log_level);
+    if (!flash_path.empty() && !sim_flash_open(flash_path.c_str()))
+        return 2;
+
+    // Settings match the defaults robco_display's to_code() emits
+    PicoIOExtension pico;
+    RobcoDisplayComponent display;
+    pico.setup();
+    display.set_pico_io_extension(&pico);
+    display.set_menu_definition(&sim_menu);
+    display.set_status_bindings(&sim_status_bindings);
+    display.set_status_batch_window(100);
+    display.set_render_mode(mode);
+    display.set_glyph_atlas_mode(atlas);
+    if (crt_effects)
+        display.set_crt_effects(0.75f, 0.30f);
+    if (scanout)
+        display.set_scanout_effects(0.80f, 0.85f, 40, 2, 0.05f);
+    display.set_frame_interval(40);
+    display.set_boot_typing_speed(120);
+    display.set_boot_tick_budget(2000);
+    display.set_log_partition("spiffs");
+    display.set_trace_enabled(trace);
+    // Not on by default; here so scripts can open it and mqtt pub to it
+    display.set_terminal_topic("robco/terminal");
+    display.setup();
+
+    Simulator sim(pico, display);
+    sim.frames_dir = frames_dir;
+    sim.golden_dir = golden_dir;
+    sim.ppm = ppm;
+    sim.step_us = step_ms * 1000;
+    int status = 0;
+    for (const auto &script : scripts)
+    {
+        std::istringstream lines(script.second);
+        std::string line;
+        for (int n = 1; status == 0 && std::getline(lines, line); ++n)
+        {
+            std::string where = script.first + ":" + std::to_string(n);
+            if (!sim.run(line, where.c_str()))
+                status = 1;
+        }
+    }
+    if (sim.pending_loops() > 0)
+        sim.print_stats();
+    if (!sim_flash_save())
+    {
+        fprintf(stderr, "cannot write %s\n", flash_path.c_str());
+        status = 2;
+    }
+    fflush(stdout);
+    // The render task never returns; skip static destructors it could still be using
+    _Exit(status);
+}
@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""Write a deterministic VT100 test stream for robco_sim's terminal feed.
+
+The stream replays what vttest's basic screens and a busy shell session send:
+cursor addressing, erase in line and display, scroll regions scrolled both
+ways, insert/delete of lines and characters, autowrap, tab stops, SGR inverse
+and underline, DEC line drawing, and long runs of scrolling log text with
+colour sequences the panel ignores. The same arguments always give the same
+bytes, so throughput numbers from different builds can be compared.
+
+    python3 scripts/vt_stream.py > vt_stream.bin
+    robco_sim -e "wait 4000; terminal open; terminal feed vt_stream.bin 10; dump terminal"
+"""
+import argparse
+import random
+import sys
+
+COLS, ROWS = 65, 20
+ESC = "\x1b"
+CSI = ESC + "["
+
+
+def cup(row, col):
+    return f"{CSI}{row};{col}H"
+
+
+def box(top, left, height, width):
+    """DEC line drawing frame, as vttest draws its borders."""
+    out = [ESC + "(0", cup(top, left), "l" + "q" * (width - 2) + "k"]
+    for r in range(top + 1, top + height - 1):
+        out += [cup(r, left), "x", cup(r, left + width - 1), "x"]
+    out += [cup(top + height - 1, left), "m" + "q" * (width - 2) + "j", ESC + "(B"]
+    return "".join(out)
+
+
+def cursor_screen(rng):
+    """vttest 1: a frame of E's and *'s drawn with every cursor motion."""
+    out = [CSI + "2J", ESC + "#8", cup(9, 10), CSI + "1J", cup(18, 60), CSI + "0J", CSI + "1K"]
+    for row in range(9, 19):
+        out.append(cup(row, 11) + CSI + "0K")
+    out.append(box(2, 2, ROWS - 2, COLS - 2))
+    for _ in range(200):
+        motion = rng.choice("ABCD")
+        out.append(f"{CSI}{rng.randint(1, 6)}{motion}*")
+    out.append(cup(ROWS // 2, 10) + "The screen should be cleared, and have a frame of *'s")
+    return "".join(out)
+
+
+def scroll_region_screen(rng):
+    """vttest 2: text scrolled up and down inside a margin, origin mode on and off."""
+    out = [CSI + "2J", cup(1, 1), "Scroll region test: lines 5-15 scroll, the rest stay put"]
+    out.append(cup(ROWS, 1) + CSI + "7mstatus line outside the region" + CSI + "m")
+    out.append(CSI + "5;15r")
+    for i in range(120):
+        out.append(cup(15, 1) + f"\r\nline {i:03d} " + "".join(rng.choice("abcdefgh ") for _ in range(40)))
+    out.append(cup(5, 1))
+    for i in range(40):
+        out.append(ESC + "M" + f"reverse {i:03d}")
+    out.append(CSI + "?6h" + cup(1, 1) + "origin mode row 1 is screen row 5" + CSI + "?6l")
+    out.append(CSI + "1;20r" + CSI + "1S" + CSI + "2T")
+    out.append(CSI + "r")
+    return "".join(out)
+
+
+def edit_screen(rng):
+    """vttest 8: insert and delete characters and lines on an accordion of text."""
+    out = [CSI + "2J", cup(1, 1)]
+    for row in range(1, ROWS + 1):
+        out.append(cup(row, 1) + chr(ord("A") + row - 1) * COLS)
+    for _ in range(60):
+        out.append(cup(rng.randint(2, ROWS - 1), 1) + (CSI + "L" if rng.random() < 0.5 else CSI + "M"))
+    for _ in range(120):
+        row, col = rng.randint(1, ROWS), rng.randint(1, COLS)
+        op = rng.choice(["@", "P", "X"])
+        out.append(cup(row, col) + f"{CSI}{rng.randint(1, 8)}{op}" + ("ins" if op == "@" else ""))
+    return "".join(out)
+
+
+def attribute_screen(rng):
+    """vttest 3/4: tab stops, wrap at the right margin, SGR, and sequences with no effect here."""
+    out = [CSI + "2J", cup(1, 1), CSI + "3g"]
+    for col in range(1, COLS, 7):
+        out.append(cup(1, col) + ESC + "H")
+    out.append(cup(2, 1) + "\t".join(f"t{i}" for i in range(9)))
+    out.append(cup(4, COLS - 4) + "wraps to the next line and keeps going")
+    out.append(CSI + "?7l" + cup(6, COLS - 4) + "clipped at the margin" + CSI + "?7h")
+    for i, sgr in enumerate(["1", "4", "5", "7", "4;7", "0", "1;31;42", "38;5;208", "38;2;10;20;30"]):
+        out.append(cup(8 + i, 1) + f"{CSI}{sgr}mSGR {sgr}{CSI}m")
+    out.append(ESC + "]0;window title\x07" + ESC + "P1$r0m" + ESC + "\\")
+    out.append(cup(18, 1) + "utf-8: café │ — \U0001f600".encode().decode("latin-1"))
+    out.append(CSI + "6n" + CSI + "c" + CSI + "?25l" + CSI + "?25h")
+    return "".join(out)
+
+
+def log_burst(rng, lines):
+    """A busy `tail -f`: coloured lines scrolling the whole screen, the bulk of real traffic."""
+    levels = [("32", "I"), ("33", "W"), ("31", "E"), ("0", "D")]
+    words = ["mqtt", "door", "vault", "sensor", "relay", "timeout", "connected", "state", "reactor", "water"]
+    out = [CSI + "r", cup(ROWS, 1)]
+    for i in range(lines):
+        colour, level = rng.choice(levels)
+        text = " ".join(rng.choice(words) for _ in range(rng.randint(3, 10)))
+        out.append(f"{CSI}{colour}m[{level}][{i * 37 % 100000:05d}] {text}{CSI}0m\r\n")
+    return "".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--log-lines", type=int, default=1500)
+    args = parser.parse_args()
+    rng = random.Random(args.seed)
+    stream = "".join([
+        ESC + "c",
+        cursor_screen(rng),
+        scroll_region_screen(rng),
+        edit_screen(rng),
+        attribute_screen(rng),
+        log_burst(rng, args.log_lines),
+        CSI + "2J" + box(1, 1, ROWS, COLS) + cup(ROWS // 2, 20) + CSI + "7m VT100 STREAM COMPLETE " + CSI + "m",
+    ])
+    sys.stdout.buffer.write(stream.encode("latin-1"))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,12 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct i2c_master_bus_t *i2c_master_bus_handle_t;
+
+#ifdef __cplusplus
+}
+#endif
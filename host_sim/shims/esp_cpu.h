@@ -0,0 +1,14 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Host cycle counter scaled to CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, from the wall clock
+uint32_t esp_cpu_get_cycle_count();
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,2 @@
+#pragma once
+#include "esp_lcd_types.h"
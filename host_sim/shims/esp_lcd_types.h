@@ -0,0 +1,23 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct esp_lcd_panel_t *esp_lcd_panel_handle_t;
+typedef struct esp_lcd_panel_io_t *esp_lcd_panel_io_handle_t;
+
+typedef enum
+{
+    LCD_CLK_SRC_DEFAULT,
+    LCD_CLK_SRC_PLL160M,
+    LCD_CLK_SRC_XTAL,
+} lcd_clock_source_t;
+
+#ifdef __cplusplus
+}
+#endif
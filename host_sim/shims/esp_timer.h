@@ -0,0 +1,14 @@
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// Virtual time, advanced by the simulator's main loop
+int64_t esp_timer_get_time();
+
+#ifdef __cplusplus
+}
+#endif
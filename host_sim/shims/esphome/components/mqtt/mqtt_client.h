@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace esphome
+{
+    namespace mqtt
+    {
+        using mqtt_callback_t = std::function<void(const std::string &, const std::string &)>;
+
+        // Stand-in broker: publishes are logged and kept for the simulator, and fail
+        // while sim_mqtt_set_connected(false) is in effect; sim_mqtt_deliver() feeds
+        // subscriptions
+        class MQTTClientComponent
+        {
+        public:
+            bool publish(const std::string &topic, const std::string &payload, uint8_t qos = 0, bool retain = false);
+            // Declared like ESPHome's, so calls that would be ambiguous there fail here too
+            bool publish(const std::string &topic, const char *payload, size_t payload_length, uint8_t qos = 0,
+                         bool retain = false);
+            void subscribe(const std::string &topic, mqtt_callback_t callback, uint8_t qos = 0);
+            bool is_connected() const;
+        };
+
+        extern MQTTClientComponent *global_mqtt_client;
+    } // namespace mqtt
+} // namespace esphome
@@ -0,0 +1,15 @@
+#pragma once
+#include <string>
+
+namespace esphome
+{
+    namespace sensor
+    {
+        class Sensor
+        {
+        public:
+            void publish_state(float state) { this->state = state; }
+            float state = 0.0f;
+        };
+    } // namespace sensor
+} // namespace esphome
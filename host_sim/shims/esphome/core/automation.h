@@ -0,0 +1,30 @@
+#pragma once
+#include <functional>
+#include <vector>
+
+namespace esphome
+{
+    // Automations are not simulated; a trigger runs the callbacks attached to it
+    template <typename... Ts>
+    class Trigger
+    {
+    public:
+        void trigger(Ts... x)
+        {
+            for (auto &cb : this->callbacks_)
+                cb(x...);
+        }
+        void add_callback(std::function<void(Ts...)> cb) { this->callbacks_.push_back(std::move(cb)); }
+
+    private:
+        std::vector<std::function<void(Ts...)>> callbacks_;
+    };
+
+    template <typename... Ts>
+    class Action
+    {
+    public:
+        virtual ~Action() = default;
+        virtual void play(Ts... x) = 0;
+    };
+} // namespace esphome
@@ -0,0 +1,25 @@
+#pragma once
+#include <string>
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome
+{
+    namespace setup_priority
+    {
+        const float HARDWARE = 800.0f;
+        const float DATA = 600.0f;
+        const float PROCESSOR = 400.0f;
+        const float AFTER_WIFI = 200.0f;
+    } // namespace setup_priority
+
+    class Component
+    {
+    public:
+        virtual ~Component() = default;
+        virtual void setup() {}
+        virtual void loop() {}
+        virtual void dump_config() {}
+        virtual float get_setup_priority() const { return setup_priority::DATA; }
+    };
+} // namespace esphome
@@ -0,0 +1,5 @@
+#pragma once
+
+#define CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ 240
+#define CONFIG_IDF_TARGET_ESP32S3 1
+#define CONFIG_SPIRAM 1
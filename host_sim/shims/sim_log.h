@@ -0,0 +1,28 @@
+// Host simulator: ESP-IDF and ESPHome log macros print to stderr
+#pragma once
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+int sim_log_level();
+void sim_log(char level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+#define SIM_LOG(level, num, tag, format, ...)                        \
+    do                                                              \
+    {                                                               \
+        if (sim_log_level() >= (num))                               \
+            sim_log(level, tag, format, ##__VA_ARGS__);             \
+    } while (0)
+
+#define ESP_LOGE(tag, format, ...) SIM_LOG('E', 1, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) SIM_LOG('W', 2, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) SIM_LOG('I', 3, tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) SIM_LOG('D', 4, tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) SIM_LOG('V', 5, tag, format, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+}
+#endif
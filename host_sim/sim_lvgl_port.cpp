@@ -0,0 +1,95 @@
+// esp_lvgl_port on the host: no LVGL task, the simulator calls sim_lvgl_step()
+// from its main loop. The display renders straight into the simulated panel's
+// image, the way direct mode renders into the RGB driver's framebuffer.
+#include "esp_lvgl_port.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sim_platform.h"
+#include <mutex>
+
+static const char *TAG = "sim_lvgl_port";
+
+static std::recursive_mutex lvgl_mutex;
+
+static uint32_t tick_ms()
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+esp_err_t lvgl_port_init(const lvgl_port_cfg_t *cfg)
+{
+    lv_init();
+    lv_tick_set_cb(tick_ms);
+    return ESP_OK;
+}
+
+bool lvgl_port_lock(uint32_t timeout_ms)
+{
+    lvgl_mutex.lock();
+    return true;
+}
+
+void lvgl_port_unlock()
+{
+    lvgl_mutex.unlock();
+}
+
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    // Partial mode draws into a separate buffer that is copied to the panel;
+    // direct mode has already drawn into the panel image
+    if (lv_display_get_user_data(disp) != nullptr)
+    {
+        esp_lcd_panel_handle_t panel = (esp_lcd_panel_handle_t)lv_display_get_user_data(disp);
+        esp_lcd_panel_draw_bitmap(panel, area->x1, area->y1, area->x2 + 1, area->y2 + 1, px_map);
+    }
+    lv_display_flush_ready(disp);
+}
+
+lv_display_t *lvgl_port_add_disp_rgb(const lvgl_port_display_cfg_t *disp_cfg,
+                                     const lvgl_port_display_rgb_cfg_t *rgb_cfg)
+{
+    std::lock_guard<std::recursive_mutex> lock(lvgl_mutex);
+    lv_display_t *disp = lv_display_create(disp_cfg->hres, disp_cfg->vres);
+    if (disp == nullptr)
+        return nullptr;
+    lv_display_set_color_format(disp, disp_cfg->color_format);
+    lv_display_set_flush_cb(disp, flush_cb);
+    uint32_t frame_bytes = disp_cfg->hres * disp_cfg->vres * sizeof(uint16_t);
+    if (disp_cfg->flags.direct_mode || disp_cfg->flags.full_refresh)
+    {
+        // One framebuffer: the panel shows exactly what LVGL last finished drawing,
+        // without the tearing the double-buffered port works around on hardware
+        void *fb = (void *)sim_panel_pixels(disp_cfg->panel_handle);
+        lv_display_set_buffers(disp, fb, nullptr, frame_bytes,
+                               disp_cfg->flags.direct_mode ? LV_DISPLAY_RENDER_MODE_DIRECT
+                                                           : LV_DISPLAY_RENDER_MODE_FULL);
+    }
+    else
+    {
+        uint32_t buf_bytes = disp_cfg->buffer_size * sizeof(uint16_t);
+        void *buf = lv_malloc(buf_bytes);
+        if (buf == nullptr)
+        {
+            ESP_LOGE(TAG, "Draw buffer allocation failed");
+            lv_display_delete(disp);
+            return nullptr;
+        }
+        lv_display_set_buffers(disp, buf, nullptr, buf_bytes, LV_DISPLAY_RENDER_MODE_PARTIAL);
+        lv_display_set_user_data(disp, disp_cfg->panel_handle);
+    }
+    return disp;
+}
+
+void sim_lvgl_step()
+{
+    std::lock_guard<std::recursive_mutex> lock(lvgl_mutex);
+    lv_timer_handler();
+}
+
+void sim_lvgl_refresh_now()
+{
+    std::lock_guard<std::recursive_mutex> lock(lvgl_mutex);
+    lv_refr_now(nullptr);
+}
@@ -0,0 +1,41 @@
+// Checked-in snapshot of the tables robco_display/menu_tables.py and
+// status_bindings.py generate for the stock menu plus a log view, with the
+// door status bound to vault/door/state under a vault/# subscription.
+// Regenerate with tests/make_sim_menu.py; the sim_menu_current test fails
+// when this copy is out of date.
+#include "sim_menu.h"
+
+static constexpr const char *sim_menu_header[] = {"        ROBCO INDUSTRIES UNIFIED OPERATING SYSTEM", "           COPYRIGHT 2075-2077 ROBCO INDUSTRIES", "", "                        -Server 1-", "Welcome, Overseer.", "------------------"};
+static constexpr const char *sim_menu_boot[] = {"RobCo Industries (TM) Termlink Protocol", "Established 2075", "", "VAULT-TEC TERMINAL SYSTEM", "Initializing...", "", "Boot Sequence Started", "Loading System Drivers...", "Checking Memory Banks...", "Network Interface: ONLINE", "Security Protocols: ACTIVE", "", "System Status: NOMINAL", "Security Level: AUTHORIZED", "Access Level: OVERSEER", "", "Welcome to RobCo Termlink", "Have a Nice Day!", "", "> Press any key to continue..."};
+static constexpr MenuNode sim_menu_nodes[] = {
+  {"", nullptr, "", MenuEntry::Type::SUBMENU, -1, 1, 8, -1, 2, 0, 0, -1},
+  {"", nullptr, "", MenuEntry::Type::STATIC, 0, -1, 0, 2, -1, 2, 7, -1},
+  {"Vault Door Control", nullptr, "", MenuEntry::Type::SUBMENU, 0, 9, 3, 3, 9, 4, 7, -1},
+  {"", nullptr, "", MenuEntry::Type::STATIC, 0, -1, 0, 4, -1, 4, 2, -1},
+  {"System Status", nullptr, "", MenuEntry::Type::SUBMENU, 0, 12, 5, 5, -1, 6, 2, -1},
+  {"", nullptr, "", MenuEntry::Type::STATIC, 0, -1, 0, 6, -1, 6, 4, -1},
+  {"Overseer Logs", nullptr, "", MenuEntry::Type::SUBMENU, 0, 17, 5, 7, -1, 7, 4, -1},
+  {"Event Log", nullptr, "", MenuEntry::Type::LOGS, 0, -1, 0, 8, -1, 2, 6, -1},
+  {"", nullptr, "", MenuEntry::Type::STATIC, 0, -1, 0, -1, -1, 2, 7, -1},
+  {"Open Vault Door", "open_vault_door", "", MenuEntry::Type::ACTION, 2, -1, 0, 10, -1, 11, 11, -1},
+  {"", nullptr, "", MenuEntry::Type::STATIC, 2, -1, 0, 11, -1, 11, 9, -1},
+  {"Close Vault Door", "close_vault_door", "", MenuEntry::Type::ACTION, 2, -1, 0, -1, -1, 9, 9, -1},
+  {"Power: Stable", nullptr, "", MenuEntry::Type::STATIC, 4, -1, 0, 13, -1, -1, -1, -1},
+  {"", nullptr, "", MenuEntry::Type::STATIC, 4, -1, 0, 14, -1, -1, -1, -1},
+  {"Door", "door_status", "Unknown", MenuEntry::Type::STATUS, 4, -1, 0, 15, -1, -1, -1, 0},
+  {"", nullptr, "", MenuEntry::Type::STATIC, 4, -1, 0, 16, -1, -1, -1, -1},
+  {"Security: Nominal", nullptr, "", MenuEntry::Type::STATIC, 4, -1, 0, -1, -1, -1, -1, -1},
+  {"CORRUPTED MEMORY BANK", nullptr, "", MenuEntry::Type::STATIC, 6, -1, 0, 18, -1, -1, -1, -1},
+  {"##??DATA ERROR??##", nullptr, "", MenuEntry::Type::STATIC, 6, -1, 0, 19, -1, -1, -1, -1},
+  {"@!X1Z!@#%$*", nullptr, "", MenuEntry::Type::STATIC, 6, -1, 0, 20, -1, -1, -1, -1},
+  {"??ERROR??", nullptr, "", MenuEntry::Type::STATIC, 6, -1, 0, 21, -1, -1, -1, -1},
+  {"DATA_CORRUPT A9!B7#C", nullptr, "", MenuEntry::Type::STATIC, 6, -1, 0, -1, -1, -1, -1, -1}};
+static constexpr MenuIdIndex sim_menu_ids[] = {{"close_vault_door", 11}, {"door_status", 14}, {"open_vault_door", 9}};
+const MenuDefinition sim_menu = {sim_menu_header, 6, sim_menu_boot, 20, sim_menu_nodes, 22, sim_menu_ids, 3};
+
+static constexpr StatusBinding sim_status_slots[] = {
+  {"vault/door/state", 14, "", "", 0, 2}};
+static constexpr uint16_t sim_status_seeds[] = {1};
+static constexpr StatusValueMap sim_status_maps[] = {{"opened", "Opened"}, {"closed", "Closed"}};
+static constexpr const char *sim_status_subscriptions[] = {"vault/#"};
+const StatusBindingTable sim_status_bindings = {sim_status_slots, 0, sim_status_seeds, 0, sim_status_maps, 1, sim_status_subscriptions, 1};
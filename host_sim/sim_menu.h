@@ -0,0 +1,6 @@
+#pragma once
+#include "menu_tree.h"
+#include "status_bindings.h"
+
+extern const MenuDefinition sim_menu;
+extern const StatusBindingTable sim_status_bindings;
@@ -0,0 +1,56 @@
+// Stands in for pico_io_extension.cpp: there is no UART link, key presses come
+// from the simulator's script and pin changes are only recorded
+#include "../components/pico_io_extension/pico_io_extension.h"
+#include "esphome/core/log.h"
+#include "sim_platform.h"
+#include <deque>
+#include <utility>
+
+namespace esphome {
+namespace pico_io_extension {
+
+static const char *TAG = "pico_io_extension";
+
+static std::deque<std::pair<uint8_t, uint8_t>> pending_keys;
+static int pin_levels[256];
+
+void PicoIOExtension::set_uart_pins(int rx, int tx) {
+  rx_pin_ = rx;
+  tx_pin_ = tx;
+}
+
+void PicoIOExtension::set_key_press_callback(std::function<void(uint8_t keycode, uint8_t modifiers)> cb) {
+  key_press_cb_ = cb;
+}
+
+void PicoIOExtension::setPin(uint8_t pin, bool state) {
+  if (pin_levels[pin] != (state ? 1 : 0))
+    ESP_LOGD(TAG, "Pin %u = %u", pin, state ? 1 : 0);
+  pin_levels[pin] = state ? 1 : 0;
+}
+
+void PicoIOExtension::setup() {
+  for (int &level : pin_levels)
+    level = -1;
+  link_state_ = LinkState::READY;
+}
+
+void PicoIOExtension::loop() {
+  while (!pending_keys.empty()) {
+    auto key = pending_keys.front();
+    pending_keys.pop_front();
+    if (key_press_cb_)
+      key_press_cb_(key.first, key.second);
+  }
+}
+
+}  // namespace pico_io_extension
+}  // namespace esphome
+
+void sim_pico_press(uint8_t keycode, uint8_t modifiers) {
+  esphome::pico_io_extension::pending_keys.emplace_back(keycode, modifiers);
+}
+
+int sim_pico_pin(uint8_t pin) {
+  return esphome::pico_io_extension::pin_levels[pin];
+}
@@ -0,0 +1,559 @@
+// ESP-IDF, FreeRTOS and ESPHome runtime pieces the component links against,
+// reduced to what a single-process, deterministic simulation needs
+#include "sim_platform.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_rgb.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esphome/components/mqtt/mqtt_client.h"
+#include "esphome/core/hal.h"
+#include "sdkconfig.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char *TAG = "sim";
+
+// ---- Time and logging ----
+
+static std::atomic<int64_t> now_us{0};
+static int log_level = 3;
+
+void sim_advance_time_us(int64_t us)
+{
+    now_us.fetch_add(us, std::memory_order_relaxed);
+}
+
+int64_t esp_timer_get_time()
+{
+    return now_us.load(std::memory_order_relaxed);
+}
+
+// Bounce buffer fills are timed against real CPU time, scaled to the target clock
+uint32_t esp_cpu_get_cycle_count()
+{
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now().time_since_epoch())
+                  .count();
+    return (uint32_t)((uint64_t)ns * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ / 1000);
+}
+
+namespace esphome
+{
+    uint32_t millis() { return (uint32_t)(esp_timer_get_time() / 1000); }
+    uint32_t micros() { return (uint32_t)esp_timer_get_time(); }
+    void delay(uint32_t ms) { sim_advance_time_us((int64_t)ms * 1000); }
+} // namespace esphome
+
+void sim_set_log_level(int level)
+{
+    log_level = level;
+}
+
+int sim_log_level()
+{
+    return log_level;
+}
+
+void sim_log(char level, const char *tag, const char *format, ...)
+{
+    int64_t t = esp_timer_get_time();
+    fprintf(stderr, "%c (%lld.%03lld) %s: ", level, (long long)(t / 1000000), (long long)(t / 1000 % 1000), tag);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+// ---- Heap ----
+
+static std::atomic<uint64_t> allocs{0};
+
+uint64_t sim_alloc_count()
+{
+    return allocs.load(std::memory_order_relaxed);
+}
+
+void *operator new(size_t size)
+{
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    return calloc(n, size);
+}
+
+void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps)
+{
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return caps & MALLOC_CAP_SPIRAM ? 8 * 1024 * 1024 : 320 * 1024;
+}
+
+// ---- Tasks ----
+
+// A notification is handed over synchronously: the giver waits until the task
+// has taken it, run, and blocked in ulTaskNotifyTake() again. The task never
+// runs concurrently with the main loop, so runs are repeatable.
+struct sim_task
+{
+    TaskFunction_t fn;
+    void *arg;
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t notifications = 0;
+    bool waiting = false;
+};
+
+static thread_local sim_task *current_task = nullptr;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *created_task, BaseType_t core_id)
+{
+    // Tasks run until the process exits, so the handle is never freed
+    sim_task *task = new sim_task;
+    task->fn = fn;
+    task->arg = arg;
+    if (created_task != nullptr)
+        *created_task = task;
+    std::thread([task]()
+                {
+                    current_task = task;
+                    task->fn(task->arg); })
+        .detach();
+    ESP_LOGD(TAG, "Task '%s' started", name);
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg, UBaseType_t priority,
+                       TaskHandle_t *created_task)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack_depth, arg, priority, created_task, tskNO_AFFINITY);
+}
+
+void xTaskNotifyGive(TaskHandle_t task)
+{
+    std::unique_lock<std::mutex> lock(task->mutex);
+    task->notifications++;
+    task->cv.notify_all();
+    task->cv.wait(lock, [task]()
+                  { return task->waiting && task->notifications == 0; });
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+    sim_task *task = current_task;
+    std::unique_lock<std::mutex> lock(task->mutex);
+    task->waiting = true;
+    task->cv.notify_all();
+    task->cv.wait(lock, [task]()
+                  { return task->notifications > 0; });
+    task->waiting = false;
+    uint32_t value = task->notifications;
+    task->notifications = clear_on_exit ? 0 : value - 1;
+    return value;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    std::this_thread::yield();
+}
+
+struct sim_semaphore
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool given = false;
+};
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return new sim_semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks_to_wait)
+{
+    std::unique_lock<std::mutex> lock(sem->mutex);
+    if (!sem->cv.wait_for(lock, std::chrono::milliseconds(ticks_to_wait == portMAX_DELAY ? INT32_MAX : ticks_to_wait),
+                          [sem]()
+                          { return sem->given; }))
+        return pdFALSE;
+    sem->given = false;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *higher_priority_task_woken)
+{
+    std::lock_guard<std::mutex> lock(sem->mutex);
+    sem->given = true;
+    sem->cv.notify_all();
+    if (higher_priority_task_woken != nullptr)
+        *higher_priority_task_woken = pdFALSE;
+    return pdTRUE;
+}
+
+// ---- GPIO and MQTT ----
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    ESP_LOGD(TAG, "GPIO%d = %u", (int)gpio_num, (unsigned)level);
+    return ESP_OK;
+}
+
+namespace esphome
+{
+    namespace mqtt
+    {
+        static bool mqtt_connected = true;
+        static std::deque<std::pair<std::string, std::string>> mqtt_published;
+
+        bool MQTTClientComponent::publish(const std::string &topic, const std::string &payload, uint8_t qos, bool retain)
+        {
+            if (!mqtt_connected)
+                return false;
+            ESP_LOGI(TAG, "MQTT publish %s (QoS %u): '%s'", topic.c_str(), (unsigned)qos, payload.c_str());
+            mqtt_published.emplace_back(topic, payload);
+            return true;
+        }
+
+        bool MQTTClientComponent::publish(const std::string &topic, const char *payload, size_t payload_length,
+                                          uint8_t qos, bool retain)
+        {
+            return publish(topic, std::string(payload, payload_length), qos, retain);
+        }
+
+        bool MQTTClientComponent::is_connected() const { return mqtt_connected; }
+
+        static std::vector<std::pair<std::string, mqtt_callback_t>> mqtt_subscriptions;
+
+        void MQTTClientComponent::subscribe(const std::string &topic, mqtt_callback_t callback, uint8_t qos)
+        {
+            ESP_LOGD(TAG, "MQTT subscribe %s", topic.c_str());
+            mqtt_subscriptions.emplace_back(topic, std::move(callback));
+        }
+
+        // MQTT filter matching with + and #
+        static bool topic_matches(const std::string &filter, const std::string &topic)
+        {
+            for (size_t f = 0, t = 0;;)
+            {
+                size_t f_end = std::min(filter.find('/', f), filter.size());
+                std::string level = filter.substr(f, f_end - f);
+                if (level == "#")
+                    return true;
+                if (t > topic.size())
+                    return false;
+                size_t t_end = std::min(topic.find('/', t), topic.size());
+                if (level != "+" && topic.compare(t, t_end - t, level) != 0)
+                    return false;
+                if (f_end == filter.size())
+                    return t_end == topic.size();
+                f = f_end + 1;
+                t = t_end + 1;
+            }
+        }
+
+        static MQTTClientComponent sim_mqtt_client;
+        MQTTClientComponent *global_mqtt_client = &sim_mqtt_client;
+    } // namespace mqtt
+} // namespace esphome
+
+void sim_mqtt_set_connected(bool connected)
+{
+    ESP_LOGI(TAG, "MQTT %s", connected ? "connected" : "disconnected");
+    esphome::mqtt::mqtt_connected = connected;
+}
+
+size_t sim_mqtt_deliver(const std::string &topic, const std::string &payload)
+{
+    size_t delivered = 0;
+    for (auto &subscription : esphome::mqtt::mqtt_subscriptions)
+    {
+        if (esphome::mqtt::topic_matches(subscription.first, topic))
+        {
+            subscription.second(topic, payload);
+            delivered++;
+        }
+    }
+    return delivered;
+}
+
+bool sim_mqtt_take_publish(std::string &topic, std::string &payload)
+{
+    auto &published = esphome::mqtt::mqtt_published;
+    if (published.empty())
+        return false;
+    topic = std::move(published.front().first);
+    payload = std::move(published.front().second);
+    published.pop_front();
+    return true;
+}
+
+// ---- Flash ----
+
+// Same size and erase granularity as the spiffs partition in the default 4 MB layout
+static constexpr size_t FLASH_SIZE = 0xF0000;
+static constexpr size_t FLASH_SECTOR_SIZE = 4096;
+static std::vector<uint8_t> flash(FLASH_SIZE, 0xFF);
+static std::string flash_path;
+static const esp_partition_t spiffs_partition = {
+    ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, 0x310000, FLASH_SIZE, FLASH_SECTOR_SIZE, "spiffs", false};
+
+bool sim_flash_open(const char *path)
+{
+    flash_path = path;
+    FILE *f = fopen(path, "rb");
+    if (f == nullptr)
+        return true;
+    size_t n = fread(flash.data(), 1, flash.size(), f);
+    fclose(f);
+    if (n != flash.size())
+    {
+        ESP_LOGE(TAG, "%s holds %u bytes, expected %u", path, (unsigned)n, (unsigned)flash.size());
+        return false;
+    }
+    return true;
+}
+
+bool sim_flash_save()
+{
+    if (flash_path.empty())
+        return true;
+    FILE *f = fopen(flash_path.c_str(), "wb");
+    if (f == nullptr)
+        return false;
+    bool ok = fwrite(flash.data(), 1, flash.size(), f) == flash.size();
+    return fclose(f) == 0 && ok;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    if (type != ESP_PARTITION_TYPE_DATA && type != ESP_PARTITION_TYPE_ANY)
+        return nullptr;
+    if (label != nullptr && strcmp(label, spiffs_partition.label) != 0)
+        return nullptr;
+    return &spiffs_partition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size)
+{
+    if (src_offset > flash.size() || size > flash.size() - src_offset)
+        return ESP_ERR_INVALID_SIZE;
+    memcpy(dst, flash.data() + src_offset, size);
+    return ESP_OK;
+}
+
+// NOR semantics: programming can only clear bits
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size)
+{
+    if (dst_offset > flash.size() || size > flash.size() - dst_offset)
+        return ESP_ERR_INVALID_SIZE;
+    const uint8_t *bytes = (const uint8_t *)src;
+    for (size_t i = 0; i < size; ++i)
+        flash[dst_offset + i] &= bytes[i];
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size)
+{
+    if (offset % FLASH_SECTOR_SIZE != 0 || size % FLASH_SECTOR_SIZE != 0 || offset > flash.size() ||
+        size > flash.size() - offset)
+        return ESP_ERR_INVALID_ARG;
+    memset(flash.data() + offset, 0xFF, size);
+    return ESP_OK;
+}
+
+// ---- RGB panel ----
+
+struct esp_lcd_panel_t
+{
+    esp_lcd_rgb_panel_config_t config;
+    esp_lcd_rgb_panel_event_callbacks_t callbacks;
+    void *user_ctx;
+    std::vector<uint16_t> pixels;
+    std::vector<std::vector<uint16_t>> fbs;
+    std::vector<uint16_t> bounce;
+    int64_t frame_us;
+    int64_t next_frame_us;
+};
+
+static esp_lcd_panel_handle_t last_panel = nullptr;
+
+esp_err_t esp_lcd_new_rgb_panel(const esp_lcd_rgb_panel_config_t *rgb_panel_config, esp_lcd_panel_handle_t *ret_panel)
+{
+    const esp_lcd_rgb_timing_t &t = rgb_panel_config->timings;
+    if (t.h_res == 0 || t.v_res == 0 || t.pclk_hz == 0)
+        return ESP_ERR_INVALID_ARG;
+    esp_lcd_panel_t *panel = new esp_lcd_panel_t();
+    panel->config = *rgb_panel_config;
+    panel->pixels.assign((size_t)t.h_res * t.v_res, 0);
+    if (!rgb_panel_config->flags.no_fb)
+        panel->fbs.assign(std::max<size_t>(rgb_panel_config->num_fbs, 1), panel->pixels);
+    panel->bounce.resize(rgb_panel_config->bounce_buffer_size_px);
+    uint64_t frame_clocks = (uint64_t)(t.h_res + t.hsync_pulse_width + t.hsync_back_porch + t.hsync_front_porch) *
+                            (t.v_res + t.vsync_pulse_width + t.vsync_back_porch + t.vsync_front_porch);
+    panel->frame_us = (int64_t)(frame_clocks * 1000000 / t.pclk_hz);
+    *ret_panel = panel;
+    last_panel = panel;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_rgb_panel_register_event_callbacks(esp_lcd_panel_handle_t panel,
+                                                     const esp_lcd_rgb_panel_event_callbacks_t *callbacks,
+                                                     void *user_ctx)
+{
+    panel->callbacks = *callbacks;
+    panel->user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_rgb_panel_get_frame_buffer(esp_lcd_panel_handle_t panel, uint32_t fb_num, void **fb0, ...)
+{
+    if (fb_num == 0 || fb_num > panel->fbs.size())
+        return ESP_ERR_INVALID_ARG;
+    va_list args;
+    va_start(args, fb0);
+    *fb0 = panel->fbs[0].data();
+    for (uint32_t i = 1; i < fb_num; ++i)
+        *va_arg(args, void **) = panel->fbs[i].data();
+    va_end(args);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_init(esp_lcd_panel_handle_t panel)
+{
+    if (panel->config.flags.no_fb && (panel->bounce.empty() || panel->callbacks.on_bounce_empty == nullptr))
+        return ESP_ERR_INVALID_ARG;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_del(esp_lcd_panel_handle_t panel)
+{
+    if (panel == last_panel)
+        last_panel = nullptr;
+    delete panel;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                    const void *color_data)
+{
+    const int h_res = panel->config.timings.h_res;
+    const uint16_t *src = (const uint16_t *)color_data;
+    for (const std::vector<uint16_t> &fb : panel->fbs)
+    {
+        if (src != fb.data())
+            continue;
+        panel->pixels = fb;
+        if (panel->callbacks.on_vsync != nullptr)
+            panel->callbacks.on_vsync(panel, nullptr, panel->user_ctx);
+        return ESP_OK;
+    }
+    for (int y = y_start; y < y_end; ++y, src += x_end - x_start)
+        memcpy(&panel->pixels[(size_t)y * h_res + x_start], src, (x_end - x_start) * sizeof(uint16_t));
+    return ESP_OK;
+}
+
+esp_lcd_panel_handle_t sim_panel()
+{
+    return last_panel;
+}
+
+const uint16_t *sim_panel_pixels(esp_lcd_panel_handle_t panel)
+{
+    return panel->pixels.data();
+}
+
+bool sim_panel_scan(esp_lcd_panel_handle_t panel, int64_t now)
+{
+    if (!panel->config.flags.no_fb || panel->callbacks.on_bounce_empty == nullptr || now < panel->next_frame_us)
+        return false;
+    panel->next_frame_us = now + panel->frame_us;
+    sim_panel_scan_now(panel);
+    return true;
+}
+
+void sim_panel_scan_now(esp_lcd_panel_handle_t panel)
+{
+    if (!panel->config.flags.no_fb || panel->callbacks.on_bounce_empty == nullptr)
+        return;
+    const size_t total = panel->pixels.size();
+    const size_t chunk = panel->bounce.size();
+    for (size_t pos = 0; pos < total; pos += chunk)
+    {
+        size_t len = std::min(chunk, total - pos);
+        panel->callbacks.on_bounce_empty(panel, panel->bounce.data(), (int)pos, (int)(len * sizeof(uint16_t)),
+                                         panel->user_ctx);
+        memcpy(&panel->pixels[pos], panel->bounce.data(), len * sizeof(uint16_t));
+    }
+    if (panel->callbacks.on_bounce_frame_finish != nullptr)
+        panel->callbacks.on_bounce_frame_finish(panel, nullptr, panel->user_ctx);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "esp_lcd_types.h"
+
+// Host side of the simulator: the pieces main.cpp drives that have no
+// ESP-IDF counterpart. Everything runs on the main thread except the render
+// task, which is handed each notification synchronously.
+
+// Virtual time; esp_timer_get_time() and millis() only move when this is called
+void sim_advance_time_us(int64_t us);
+
+// 0 = silent ... 5 = verbose, like ESP-IDF's log levels
+void sim_set_log_level(int level);
+
+// operator new and heap_caps_* calls since start
+uint64_t sim_alloc_count();
+
+// Back the "spiffs" partition with a file: loaded if it exists, written by sim_flash_save()
+bool sim_flash_open(const char *path);
+bool sim_flash_save();
+
+// The most recently created RGB panel and its 800x480 RGB565 image
+esp_lcd_panel_handle_t sim_panel();
+const uint16_t *sim_panel_pixels(esp_lcd_panel_handle_t panel);
+// In bounce buffer mode (no_fb), scan one frame out through on_bounce_empty if one
+// is due at the panel's refresh rate; returns true if a frame was produced
+bool sim_panel_scan(esp_lcd_panel_handle_t panel, int64_t now_us);
+void sim_panel_scan_now(esp_lcd_panel_handle_t panel);
+
+// Run LVGL's timers and display refresh once, under the port lock
+void sim_lvgl_step();
+// Redraw every invalidated area now, as if the refresh timer had fired
+void sim_lvgl_refresh_now();
+
+// Stand-in MQTT broker: publishes fail while disconnected; each one that got
+// through can be taken, oldest first
+void sim_mqtt_set_connected(bool connected);
+bool sim_mqtt_take_publish(std::string &topic, std::string &payload);
+// Hand a message to every matching subscription; returns how many matched
+size_t sim_mqtt_deliver(const std::string &topic, const std::string &payload);
+
+// Scripted keyboard: queued presses reach the component from PicoIOExtension::loop()
+void sim_pico_press(uint8_t keycode, uint8_t modifiers);
+// Last level written to each Pico pin, -1 if never set
+int sim_pico_pin(uint8_t pin);
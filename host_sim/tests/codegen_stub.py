@@ -0,0 +1,123 @@
+"""Just enough of esphome to run the robco_display code generators on the host.
+
+menu_tables.py and status_bindings.py only need config validation helpers,
+cpp_string_escape and the codegen calls that add globals. load() installs
+stand-ins for those in sys.modules and imports the generator; the globals it
+adds collect in GLOBALS in the order it adds them.
+"""
+import importlib.util
+import pathlib
+import sys
+import types
+
+COMPONENT = pathlib.Path(__file__).resolve().parents[2] / "components" / "robco_display"
+GLOBALS = []
+
+
+class Invalid(Exception):
+    pass
+
+
+class _Key(str):
+    def __new__(cls, key, default=None):
+        value = super().__new__(cls, key)
+        value.default = default
+        return value
+
+
+class Required(_Key):
+    pass
+
+
+class Optional(_Key):
+    pass
+
+
+class Schema:
+    def __init__(self, schema):
+        self.schema = schema
+
+    def __call__(self, value):
+        out = {}
+        for key, validator in self.schema.items():
+            if key in value:
+                out[str(key)] = validator(value[key])
+            elif isinstance(key, Required):
+                raise Invalid(f"'{key}' is required")
+            elif key.default is not None:
+                out[str(key)] = validator(key.default)
+        unknown = set(value) - set(self.schema)
+        if unknown:
+            raise Invalid(f"unknown keys {sorted(unknown)}")
+        return out
+
+
+def string(value):
+    return str(value)
+
+
+def one_of(*values, lower=False):
+    def validate(value):
+        value = value.lower() if lower else value
+        if value not in values:
+            raise Invalid(f"unknown value '{value}'")
+        return value
+    return validate
+
+
+def ensure_list(validator):
+    def validate(value):
+        return [validator(v) for v in (value if isinstance(value, list) else [value])]
+    return validate
+
+
+def cpp_string_escape(string, encoding="utf-8"):
+    """esphome.helpers.cpp_string_escape: printable ASCII as is, the rest octal."""
+    result = ""
+    for byte in string.encode(encoding):
+        if not 32 <= byte < 127 or byte in (ord("\\"), ord('"')):
+            result += f"\\{byte:03o}"
+        else:
+            result += chr(byte)
+    return f'"{result}"'
+
+
+class RawStatement(str):
+    pass
+
+
+class RawExpression(str):
+    pass
+
+
+class Component:
+    """The generated variable; method calls on it are recorded and ignored."""
+
+    def __getattr__(self, name):
+        return lambda *args: f"{name}({', '.join(map(str, args))})"
+
+
+def _install():
+    esphome = types.ModuleType("esphome")
+    cv = types.ModuleType("esphome.config_validation")
+    for name in ("Invalid", "Required", "Optional", "Schema", "string", "one_of", "ensure_list"):
+        setattr(cv, name, globals()[name])
+    cg = types.ModuleType("esphome.codegen")
+    cg.RawStatement, cg.RawExpression = RawStatement, RawExpression
+    cg.add_global = lambda statement: GLOBALS.append(str(statement))
+    cg.add = lambda expression: None
+    helpers = types.ModuleType("esphome.helpers")
+    helpers.cpp_string_escape = cpp_string_escape
+    esphome.config_validation, esphome.codegen, esphome.helpers = cv, cg, helpers
+    sys.modules.update({"esphome": esphome, "esphome.config_validation": cv, "esphome.codegen": cg,
+                        "esphome.helpers": helpers})
+
+
+def load(name):
+    """Import robco_display/<name>.py against the stand-ins."""
+    if "esphome" not in sys.modules:
+        _install()
+    spec = importlib.util.spec_from_file_location(name, COMPONENT / f"{name}.py")
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module
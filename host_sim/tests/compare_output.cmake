@@ -0,0 +1,10 @@
+# cmake -DCOMMAND="prog;args" -DEXPECTED=file -P compare_output.cmake
+# Fails when the command's standard output differs from the file.
+execute_process(COMMAND ${COMMAND} OUTPUT_VARIABLE actual RESULT_VARIABLE status)
+if(NOT status EQUAL 0)
+    message(FATAL_ERROR "${COMMAND} exited with ${status}")
+endif()
+file(READ ${EXPECTED} expected)
+if(NOT actual STREQUAL expected)
+    message(FATAL_ERROR "${EXPECTED} is out of date; regenerate it with: ${COMMAND}")
+endif()
@@ -0,0 +1,51 @@
+#!/usr/bin/env python3
+"""Render the printable ASCII glyphs of FSEX302.c into a plain PBM reference.
+
+Decodes the LVGL font tables straight from the C source, independently of
+GlyphBlitter, and places each glyph in a 12x24 cell the way LVGL's label
+renderer does: bottom edge ofs_y pixels above the baseline, which sits
+base_line pixels above the bottom of a line_height line. Cells are laid out
+19 to a row, characters 0x20-0x7E in order. test_glyph_blitter compares
+GlyphBlitter's output with the result.
+
+    python3 host_sim/tests/make_glyph_reference.py > host_sim/tests/data/fixedsys_cells.pbm
+"""
+import pathlib
+import re
+import sys
+
+FONT = pathlib.Path(__file__).resolve().parents[2] / "components" / "robco_display" / "FSEX302.c"
+CELL_W, CELL_H = 12, 24
+FIRST, COUNT, PER_ROW = 0x20, 95, 19
+
+
+def main():
+    src = FONT.read_text()
+    bitmap_src = src[src.index("glyph_bitmap[] = {"):src.index("};", src.index("glyph_bitmap[] = {"))]
+    bitmap = [int(v, 16) for v in re.findall(r"0x[0-9a-fA-F]+", re.sub(r"/\*.*?\*/", "", bitmap_src))]
+    glyphs = [tuple(int(v) for v in m) for m in re.findall(
+        r"\.bitmap_index = (\d+), \.adv_w = \d+, \.box_w = (\d+), \.box_h = (\d+), \.ofs_x = (-?\d+), \.ofs_y = (-?\d+)", src)]
+    line_height = int(re.search(r"\.line_height = (\d+)", src).group(1))
+    base_line = int(re.search(r"\.base_line = (\d+)", src).group(1))
+    glyph_id_start = int(re.search(r"\.range_start = 32, .range_length = 95, .glyph_id_start = (\d+)", src).group(1))
+
+    rows = (COUNT + PER_ROW - 1) // PER_ROW
+    image = [[0] * (PER_ROW * CELL_W) for _ in range(rows * CELL_H)]
+    for i in range(COUNT):
+        index, box_w, box_h, ofs_x, ofs_y = glyphs[glyph_id_start + i]
+        top = (line_height - base_line) - box_h - ofs_y
+        cell_x, cell_y = i % PER_ROW * CELL_W, i // PER_ROW * CELL_H
+        for gy in range(box_h):
+            for gx in range(box_w):
+                bit = index * 8 + gy * box_w + gx
+                x, y = ofs_x + gx, top + gy
+                if 0 <= x < CELL_W and 0 <= y < CELL_H and bitmap[bit >> 3] & (0x80 >> (bit & 7)):
+                    image[cell_y + y][cell_x + x] = 1
+    out = [f"P1\n# {FONT.name} glyphs {FIRST:#x}-{FIRST + COUNT - 1:#x}, {CELL_W}x{CELL_H} cells, {PER_ROW} per row",
+           f"{PER_ROW * CELL_W} {rows * CELL_H}"]
+    out += ["".join(str(p) for p in row) for row in image]
+    sys.stdout.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
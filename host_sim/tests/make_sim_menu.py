@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+"""Print host_sim/sim_menu.cpp from the component's code generators.
+
+The simulator has no ESPHome build, so sim_menu.cpp is a checked-in copy of
+what generate_menu_tables() and generate_status_bindings() emit for the stock
+menu with a log view added and the door status bound to vault/door/state.
+The sim_menu_current test fails when the copy and this output differ.
+
+    python3 host_sim/tests/make_sim_menu.py > host_sim/sim_menu.cpp
+"""
+import codegen_stub
+
+HEADER = """\
+// Checked-in snapshot of the tables robco_display/menu_tables.py and
+// status_bindings.py generate for the stock menu plus a log view, with the
+// door status bound to vault/door/state under a vault/# subscription.
+// Regenerate with tests/make_sim_menu.py; the sim_menu_current test fails
+// when this copy is out of date.
+#include "sim_menu.h"
+"""
+
+
+def main():
+    menu_tables = codegen_stub.load("menu_tables")
+    status_bindings = codegen_stub.load("status_bindings")
+    menu = menu_tables.DEFAULT_MENU[:-1] + [{"title": "Event Log", "type": "logs"}, ""]
+    menu = menu_tables.validate_menu(menu)
+    component = codegen_stub.Component()
+    nodes = menu_tables.generate_menu_tables(component, "sim", menu_tables.DEFAULT_HEADER,
+                                             menu_tables.DEFAULT_BOOT_MESSAGES, menu)
+    menu_globals = len(codegen_stub.GLOBALS)
+    bindings = [status_bindings.BINDING_SCHEMA({"topic": "vault/door/state", "menu_id": "door_status",
+                                                "map": {"opened": "Opened", "closed": "Closed"}})]
+    status_bindings.validate_bindings(bindings, ["vault/#"], nodes)
+    status_bindings.generate_status_bindings(component, "sim", bindings, ["vault/#"], nodes)
+
+    # sim_menu.h declares the two tables, so they lose static constexpr
+    lines = [g.replace("static constexpr MenuDefinition", "const MenuDefinition")
+              .replace("static constexpr StatusBindingTable", "const StatusBindingTable")
+             for g in codegen_stub.GLOBALS]
+    print(HEADER)
+    print("\n".join(lines[:menu_globals]))
+    print()
+    print("\n".join(lines[menu_globals:]))
+
+
+if __name__ == "__main__":
+    main()
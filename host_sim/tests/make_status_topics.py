@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+"""Generate a 1000-topic status binding table for test_status_bindings.
+
+Runs generate_status_bindings() from robco_display/status_bindings.py on
+bindings for topics like those of a large home install, and writes its tables
+followed by the hash topic_hash() gives for every topic under a few seeds, so
+the test can check that status_topic_hash() and StatusBindings::find() agree
+with the generator.
+
+    python3 host_sim/tests/make_status_topics.py status_topics.inc
+"""
+import sys
+
+import codegen_stub
+
+TOPIC_COUNT = 1000
+AREAS = ["garage", "kitchen", "vault", "reactor", "atrium", "clinic", "armory", "hydro"]
+DEVICES = ["door", "light", "fan", "pump", "sensor", "relay", "valve", "lock", "meter"]
+METRICS = ["state", "power", "temperature", "humidity", "battery", "signal"]
+
+
+def topics():
+    out = []
+    for i in range(TOPIC_COUNT):
+        area = AREAS[i % len(AREAS)]
+        device = DEVICES[i // len(AREAS) % len(DEVICES)]
+        metric = METRICS[i // (len(AREAS) * len(DEVICES)) % len(METRICS)]
+        out.append(f"home/{area}/{device}{i // (len(AREAS) * len(DEVICES) * len(METRICS))}/{metric}")
+    return out
+
+
+def main():
+    bindings_py = codegen_stub.load("status_bindings")
+    nodes = [{"menu_id": None, "type": "submenu"}]
+    bindings = []
+    for i, topic in enumerate(topics()):
+        nodes.append({"menu_id": f"status_{i}", "type": "status"})
+        binding = {"topic": topic, "menu_id": f"status_{i}", "format": "{value}", "map": {}}
+        if topic.endswith("/state"):
+            binding["map"] = {"on": "On", "off": "Off"}
+        elif topic.endswith("/power"):
+            binding["format"] = "{value} W"
+        bindings.append(binding)
+    bindings_py.validate_bindings(bindings, ["home/#"], nodes)
+    bindings_py.generate_status_bindings(codegen_stub.Component(), "topics", bindings, ["home/#"], nodes)
+
+    slots, seeds, _ = bindings_py.build_perfect_hash([b["topic"] for b in bindings])
+    rows = []
+    for binding in bindings:
+        key = binding["topic"].encode()
+        bucket_seed = seeds[bindings_py.topic_hash(0, key) & (len(seeds) - 1)]
+        for seed in (0, bucket_seed, bindings_py.MAX_SEED):
+            rows.append(f"{{{codegen_stub.cpp_string_escape(binding['topic'])}, {seed}, "
+                        f"{bindings_py.topic_hash(seed, key)}u}}")
+
+    with open(sys.argv[1], "w") as out:
+        out.write("// Generated by host_sim/tests/make_status_topics.py; do not edit\n")
+        out.write("\n".join(codegen_stub.GLOBALS) + "\n\n")
+        out.write("struct ExpectedHash {\n    const char *topic;\n    uint32_t seed;\n    uint32_t hash;\n};\n")
+        out.write("static constexpr ExpectedHash topics_expected_hashes[] = {\n  " + ",\n  ".join(rows) + "};\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,183 @@
+// CrtEffects: the packed path against the per-channel reference, and the
+// reference path against a golden image
+//   test_crt_effects crt_effects_golden.ppm [--update]
+#include "crt_effects.h"
+#include "test_support.h"
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace esphome::robco_display;
+
+static const int GOLDEN_W = 96, GOLDEN_H = 48;
+
+static uint16_t scale_channels(uint16_t px, uint8_t a)
+{
+    uint32_t r = ((px >> 11) & 0x1F) * a >> 5;
+    uint32_t g = ((px >> 5) & 0x3F) * a >> 5;
+    uint32_t b = (px & 0x1F) * a >> 5;
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+// A frame as the cell grid leaves it: bright phosphor strokes on black, a few
+// dim and off-colour pixels, and an inverse block
+static std::vector<uint16_t> test_pattern(int w, int h, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint16_t> px(w * h, 0);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+        {
+            uint16_t &p = px[y * w + x];
+            if ((x / 12 + y / 24) % 3 == 2 && x % 12 < 10)
+                p = 0x07E0;
+            else if ((x * 7 + y * 3) % 11 < 3 || (x % 12 == 5 && y % 24 > 4))
+                p = 0x07E0 | (rng() % 4 == 0 ? 0x0841 : 0);
+            else if (rng() % 17 == 0)
+                p = (uint16_t)rng();
+        }
+    return px;
+}
+
+static void test_scale_exhaustive()
+{
+    int wrong = 0;
+    for (uint32_t px = 0; px <= 0xFFFF; ++px)
+        for (uint8_t a = 0; a <= 32; ++a)
+            wrong += CrtEffects::scale_packed((uint16_t)px, a) != scale_channels((uint16_t)px, a);
+    CHECK_EQ(wrong, 0);
+}
+
+static void test_paths_agree()
+{
+    // Random configurations, frames and dirty regions, including edges of the buffer
+    std::mt19937 rng(11);
+    const int w = 120, h = 72;
+    for (int round = 0; round < 300; ++round)
+    {
+        CrtEffectConfig config;
+        config.scanline_level = rng() % 33;
+        config.bloom_level = rng() % 33;
+        CrtEffects fast, reference;
+        fast.configure(config, w);
+        reference.configure(config, w);
+        CHECK(!fast.enabled() || fast.self_test());
+        std::vector<uint16_t> a = test_pattern(w, h, round), b = a;
+        int rx = rng() % w, ry = rng() % h;
+        int rw = rng() % (w - rx) + 1, rh = rng() % (h - ry) + 1;
+        uint64_t allocs = test_alloc_count();
+        fast.apply(a.data(), w, rx, ry, rw, rh);
+        CHECK_EQ(test_alloc_count(), allocs);
+        reference.apply_reference(b.data(), w, rx, ry, rw, rh);
+        CHECK(a == b);
+    }
+}
+
+static bool read_ppm(const char *path, std::vector<uint8_t> &rgb, int &w, int &h)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return false;
+    int maxval = 0;
+    bool ok = fscanf(f, "P6 %d %d %d", &w, &h, &maxval) == 3 && maxval == 255 && fgetc(f) != EOF;
+    if (ok)
+    {
+        rgb.resize((size_t)w * h * 3);
+        ok = fread(rgb.data(), 1, rgb.size(), f) == rgb.size();
+    }
+    fclose(f);
+    return ok;
+}
+
+// RGB565 widened to 8 bits per channel by bit replication, so the file is
+// viewable and still maps back to exactly one RGB565 value
+static std::vector<uint8_t> to_rgb888(const std::vector<uint16_t> &px)
+{
+    std::vector<uint8_t> rgb;
+    for (uint16_t p : px)
+    {
+        uint8_t r = p >> 11, g = (p >> 5) & 0x3F, b = p & 0x1F;
+        rgb.push_back((r << 3) | (r >> 2));
+        rgb.push_back((g << 2) | (g >> 4));
+        rgb.push_back((b << 3) | (b >> 2));
+    }
+    return rgb;
+}
+
+static void test_golden(const char *path, bool update)
+{
+    // The settings robco_sim --crt-effects uses
+    CrtEffectConfig config;
+    config.scanline_level = 24;
+    config.bloom_level = 10;
+    CrtEffects effects;
+    effects.configure(config, GOLDEN_W);
+    std::vector<uint16_t> px = test_pattern(GOLDEN_W, GOLDEN_H, 1);
+    effects.apply_reference(px.data(), GOLDEN_W, 0, 0, GOLDEN_W, GOLDEN_H);
+    std::vector<uint8_t> rgb = to_rgb888(px);
+    if (update)
+    {
+        FILE *f = fopen(path, "wb");
+        CHECK(f != nullptr);
+        if (!f)
+            return;
+        fprintf(f, "P6\n%d %d\n255\n", GOLDEN_W, GOLDEN_H);
+        fwrite(rgb.data(), 1, rgb.size(), f);
+        fclose(f);
+        printf("wrote %s\n", path);
+        return;
+    }
+    std::vector<uint8_t> golden;
+    int w = 0, h = 0;
+    CHECK(read_ppm(path, golden, w, h));
+    CHECK_EQ(w, GOLDEN_W);
+    CHECK_EQ(h, GOLDEN_H);
+    size_t wrong = 0;
+    for (size_t i = 0; i < rgb.size() && i < golden.size(); ++i)
+        wrong += rgb[i] != golden[i];
+    if (wrong)
+        fprintf(stderr, "%zu channel values differ from %s\n", wrong, path);
+    CHECK(golden.size() == rgb.size() && wrong == 0);
+}
+
+static void bench()
+{
+    // A full 800x480 frame in 12x24 cells, as present() applies it after a redraw
+    const int w = 800, h = 480;
+    CrtEffectConfig config;
+    config.scanline_level = 24;
+    config.bloom_level = 10;
+    CrtEffects effects;
+    effects.configure(config, 12);
+    std::vector<uint16_t> px = test_pattern(w, h, 3);
+    for (int path = 0; path < 2; ++path)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int y = 0; y + 24 <= h; y += 24)
+            for (int x = 0; x + 12 <= w; x += 12)
+            {
+                if (path == 0)
+                    effects.apply_reference(px.data(), w, x, y, 12, 24);
+                else
+                    effects.apply(px.data(), w, x, y, 12, 24);
+            }
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        printf("%s path: full frame in %lld us on this host\n", path == 0 ? "reference" : "fast", (long long)us);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: test_crt_effects crt_effects_golden.ppm [--update]\n");
+        return 1;
+    }
+    bool update = argc > 2 && std::string(argv[2]) == "--update";
+    test_scale_exhaustive();
+    test_paths_agree();
+    test_golden(argv[1], update);
+    bench();
+    return test_result("test_crt_effects");
+}
@@ -0,0 +1,133 @@
+// GlyphBlitter and GlyphAtlas cells compared pixel for pixel with a reference
+// rendering of FSEX302.c made by make_glyph_reference.py
+#include "glyph_atlas.h"
+#include "glyph_blitter.h"
+#include "terminal_grid.h"
+#include "test_support.h"
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Compiled in the same way crt_terminal_renderer.cpp does
+#include "FSEX302.c"
+
+using namespace esphome::robco_display;
+
+static const int CELL_W = GlyphBlitter::CELL_W, CELL_H = GlyphBlitter::CELL_H;
+static const int PER_ROW = 19;
+static const uint16_t FG = 0x07E0, BG = 0x0000;
+
+struct Reference
+{
+    int width = 0, height = 0;
+    std::vector<uint8_t> pixels;
+
+    bool lit(char ch, int x, int y) const
+    {
+        int i = (uint8_t)ch - GlyphBlitter::FIRST_CHAR;
+        return pixels[(i / PER_ROW * CELL_H + y) * width + i % PER_ROW * CELL_W + x] != 0;
+    }
+};
+
+// Plain (P1) PBM: header, comments, then one digit per pixel
+static bool load_pbm(const char *path, Reference &ref)
+{
+    std::ifstream in(path);
+    std::string token;
+    in >> token;
+    if (token != "P1")
+        return false;
+    in >> std::ws;
+    while (in.peek() == '#')
+        std::getline(in, token);
+    in >> ref.width >> ref.height;
+    char c;
+    while ((int)ref.pixels.size() < ref.width * ref.height && in >> c)
+        ref.pixels.push_back(c == '1');
+    return (int)ref.pixels.size() == ref.width * ref.height;
+}
+
+// Draw every glyph once with the given blit and compare with the reference
+template <typename Blit>
+static void check_cells(const Reference &ref, const char *what, Blit &&blit)
+{
+    std::vector<uint16_t> cell(CELL_W * CELL_H);
+    for (uint32_t i = 0; i < GlyphBlitter::NUM_CHARS; ++i)
+    {
+        char ch = (char)(GlyphBlitter::FIRST_CHAR + i);
+        int wrong = 0;
+        for (uint8_t attr : {CELL_ATTR_NONE, CELL_ATTR_INVERSE, CELL_ATTR_UNDERLINE})
+        {
+            // Poison the cell so a pixel the blit skips shows up
+            std::fill(cell.begin(), cell.end(), 0xDEAD);
+            blit(cell.data(), CELL_W, ch, attr, FG, BG);
+            for (int y = 0; y < CELL_H; ++y)
+                for (int x = 0; x < CELL_W; ++x)
+                {
+                    bool on = ref.lit(ch, x, y);
+                    if (attr == CELL_ATTR_UNDERLINE && (y == CELL_H - 3 || y == CELL_H - 2))
+                        on = true;
+                    if (attr == CELL_ATTR_INVERSE)
+                        on = !on;
+                    wrong += cell[y * CELL_W + x] != (on ? FG : BG);
+                }
+        }
+        if (wrong)
+            fprintf(stderr, "%s: '%c' differs from the reference in %d pixels\n", what, ch, wrong);
+        CHECK_EQ(wrong, 0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Reference ref;
+    if (argc < 2 || !load_pbm(argv[1], ref))
+    {
+        fprintf(stderr, "usage: test_glyph_blitter fixedsys_cells.pbm\n");
+        return 1;
+    }
+    CHECK_EQ(ref.width, PER_ROW * CELL_W);
+
+    GlyphBlitter blitter;
+    CHECK(blitter.init(&fixedsys));
+    check_cells(ref, "blitter", [&](uint16_t *dst, size_t stride, char ch, uint8_t attr, uint16_t fg, uint16_t bg)
+                { blitter.blit(dst, stride, ch, attr, fg, bg); });
+
+    // Both atlas layouts, including colours other than the ones RGB565 mode pre-expanded
+    for (GlyphAtlasMode mode : {GlyphAtlasMode::MASK, GlyphAtlasMode::RGB565})
+    {
+        GlyphAtlas atlas;
+        CHECK(atlas.build(blitter, mode, FG, BG));
+        check_cells(ref, mode == GlyphAtlasMode::MASK ? "mask atlas" : "rgb565 atlas",
+                    [&](uint16_t *dst, size_t stride, char ch, uint8_t attr, uint16_t fg, uint16_t bg)
+                    { atlas.blit(dst, stride, ch, attr, fg, bg); });
+        std::vector<uint16_t> cell(CELL_W * CELL_H), expect(CELL_W * CELL_H);
+        atlas.blit(cell.data(), CELL_W, 'R', CELL_ATTR_NONE, 0xFFE0, 0x0841);
+        blitter.blit(expect.data(), CELL_W, 'R', CELL_ATTR_NONE, 0xFFE0, 0x0841);
+        CHECK(cell == expect);
+    }
+
+    // Cells land at their own offset in a wider framebuffer and touch nothing else
+    std::vector<uint16_t> fb(3 * CELL_W * CELL_H, 0x1234);
+    blitter.blit(fb.data() + CELL_W, 3 * CELL_W, 'A', CELL_ATTR_NONE, FG, BG);
+    int outside = 0, wrong = 0;
+    for (int y = 0; y < CELL_H; ++y)
+        for (int x = 0; x < 3 * CELL_W; ++x)
+        {
+            uint16_t px = fb[y * 3 * CELL_W + x];
+            if (x < CELL_W || x >= 2 * CELL_W)
+                outside += px != 0x1234;
+            else
+                wrong += px != (ref.lit('A', x - CELL_W, y) ? FG : BG);
+        }
+    CHECK_EQ(outside, 0);
+    CHECK_EQ(wrong, 0);
+
+    // Characters outside printable ASCII draw as blank cells
+    std::vector<uint16_t> cell(CELL_W * CELL_H, 0xDEAD);
+    blitter.blit(cell.data(), CELL_W, '\x7f', CELL_ATTR_NONE, FG, BG);
+    CHECK(std::count(cell.begin(), cell.end(), BG) == CELL_W * CELL_H);
+
+    return test_result("test_glyph_blitter");
+}
@@ -0,0 +1,261 @@
+// HidKeyTracker replaying recorded boot protocol report sequences: press and
+// release, chords, a link lost with keys held, typematic repeat, and Up/Down
+// repeats folded into one render per frame by the RenderScheduler the display uses
+#include "hid_key_tracker.h"
+#include "render_scheduler.h"
+#include "test_support.h"
+#include <initializer_list>
+#include <vector>
+
+using namespace esphome::pico_io_extension;
+using esphome::robco_display::RenderScheduler;
+using esphome::robco_display::RenderStats;
+
+static const uint8_t KEY_A = 0x04, KEY_B = 0x05, KEY_ENTER = 0x28, KEY_ESC = 0x29;
+static const uint8_t KEY_DOWN = 0x51, KEY_UP = 0x52, KEY_PAGE_DOWN = 0x4E;
+static const uint8_t MOD_LCTRL = 0x01, MOD_LSHIFT = 0x02;
+
+// One report as captured from the Pico, with its arrival time
+struct Recorded
+{
+    uint32_t ms;
+    uint8_t report[8];
+};
+
+struct Logged
+{
+    uint32_t ms;
+    KeyEvent event;
+};
+
+struct Replay
+{
+    HidKeyTracker keys;
+    std::vector<Logged> events;
+    uint32_t now_ms = 0;
+
+    Replay()
+    {
+        keys.set_event_callback([this](const KeyEvent &e) { events.push_back({now_ms, e}); });
+    }
+
+    // Feed the reports at their times, ticking the tracker every millisecond
+    // in between as loop() does, up to end_ms
+    void run(std::initializer_list<Recorded> reports, uint32_t end_ms)
+    {
+        auto next = reports.begin();
+        for (; now_ms <= end_ms; ++now_ms)
+        {
+            while (next != reports.end() && next->ms == now_ms)
+                keys.process_report((next++)->report, now_ms);
+            keys.tick(now_ms);
+        }
+    }
+
+    size_t count(KeyEventType type, uint8_t keycode) const
+    {
+        size_t n = 0;
+        for (const Logged &l : events)
+            n += l.event.type == type && l.event.keycode == keycode;
+        return n;
+    }
+};
+
+static void check_event(const Replay &r, size_t i, KeyEventType type, uint8_t keycode, uint8_t modifiers)
+{
+    CHECK(i < r.events.size());
+    if (i >= r.events.size())
+        return;
+    CHECK(r.events[i].event.type == type);
+    CHECK_EQ(r.events[i].event.keycode, keycode);
+    CHECK_EQ(r.events[i].event.modifiers, modifiers);
+}
+
+static void test_press_release()
+{
+    // A keyboard that resends its report every 8 ms while 'a' is held
+    Replay r;
+    r.run({{0, {0, 0, KEY_A}}, {8, {0, 0, KEY_A}}, {16, {0, 0, KEY_A}}, {24, {0, 0, KEY_A}}, {32, {0, 0, 0}}, {40, {0, 0, 0}}},
+          50);
+    CHECK_EQ(r.events.size(), 2);
+    check_event(r, 0, KeyEventType::PRESS, KEY_A, 0);
+    check_event(r, 1, KeyEventType::RELEASE, KEY_A, 0);
+    if (r.events.size() == 2)
+        CHECK_EQ(r.events[1].ms, 32);
+}
+
+static void test_chord()
+{
+    // Ctrl+a, then b joins, the keyboard reorders the slots, a lifts, Ctrl lifts, b lifts
+    Replay r;
+    r.run({{0, {MOD_LCTRL, 0, KEY_A}},
+           {20, {MOD_LCTRL, 0, KEY_A, KEY_B}},
+           {30, {MOD_LCTRL, 0, KEY_B, KEY_A}},
+           {40, {MOD_LCTRL, 0, KEY_B}},
+           {50, {0, 0, KEY_B}},
+           {60, {0, 0, 0}}},
+          70);
+    CHECK_EQ(r.events.size(), 4);
+    check_event(r, 0, KeyEventType::PRESS, KEY_A, MOD_LCTRL);
+    check_event(r, 1, KeyEventType::PRESS, KEY_B, MOD_LCTRL);
+    check_event(r, 2, KeyEventType::RELEASE, KEY_A, MOD_LCTRL);
+    check_event(r, 3, KeyEventType::RELEASE, KEY_B, 0);
+
+    // Phantom state while too many keys are down changes nothing
+    Replay p;
+    p.run({{0, {MOD_LSHIFT, 0, KEY_A, KEY_B}},
+           {10, {MOD_LSHIFT, 0, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01}},
+           {20, {MOD_LSHIFT, 0, KEY_A, KEY_B}},
+           {30, {0, 0, 0}}},
+          40);
+    CHECK_EQ(p.events.size(), 4);
+    CHECK_EQ(p.count(KeyEventType::PRESS, KEY_A), 1);
+    CHECK_EQ(p.count(KeyEventType::RELEASE, KEY_B), 1);
+}
+
+static void test_link_loss()
+{
+    // Down is repeating when the Pico stops answering, so its release never
+    // arrives; the component resets the tracker, which releases everything
+    Replay l;
+    l.run({{0, {MOD_LSHIFT, 0, KEY_A, KEY_DOWN}}}, 500);
+    CHECK_EQ(l.count(KeyEventType::REPEAT, KEY_DOWN), 3); // 400, 440, 480
+    l.keys.reset(500);
+    CHECK_EQ(l.count(KeyEventType::RELEASE, KEY_A), 1);
+    CHECK_EQ(l.count(KeyEventType::RELEASE, KEY_DOWN), 1);
+    CHECK_EQ(l.events.back().event.modifiers, 0);
+    l.run({}, 5000);
+    CHECK_EQ(l.count(KeyEventType::REPEAT, KEY_DOWN), 3);
+
+    // Nothing is down, so a second reset (link loss, then renegotiation) is silent
+    size_t events = l.events.size();
+    l.keys.reset(5000);
+    CHECK_EQ(l.events.size(), events);
+
+    // Still held when the link is back: a fresh press, with the full delay again
+    l.run({{5100, {0, 0, KEY_DOWN}}, {6000, {0, 0, 0}}}, 6100);
+    CHECK_EQ(l.count(KeyEventType::PRESS, KEY_DOWN), 2);
+    CHECK_EQ(l.count(KeyEventType::REPEAT, KEY_DOWN), 3 + 13); // 5500 .. 5980
+}
+
+static void test_repeat_timing()
+{
+    // Down held for a second; the keyboard sends only the press and the release
+    Replay r;
+    r.run({{0, {0, 0, KEY_DOWN}}, {1000, {0, 0, 0}}}, 1100);
+    CHECK_EQ(r.count(KeyEventType::REPEAT, KEY_DOWN), 15);
+    std::vector<uint32_t> times;
+    for (const Logged &l : r.events)
+        if (l.event.type == KeyEventType::REPEAT)
+            times.push_back(l.ms);
+    for (size_t i = 0; i < times.size(); ++i)
+        CHECK_EQ(times[i], 400 + 40 * i);
+
+    // Report spam does not speed repeats up or restart the delay
+    Replay spam;
+    spam.run({{0, {0, 0, KEY_DOWN}}, {100, {0, 0, KEY_DOWN}}, {200, {0, 0, KEY_DOWN}}, {300, {0, 0, KEY_DOWN}},
+              {400, {0, 0, KEY_DOWN}}, {420, {0, 0, KEY_DOWN}}, {1000, {0, 0, 0}}},
+             1100);
+    CHECK_EQ(spam.count(KeyEventType::REPEAT, KEY_DOWN), 15);
+
+    // Configured delay and rate
+    Replay slow;
+    slow.keys.set_repeat_delay(250);
+    slow.keys.set_repeat_interval(100);
+    slow.run({{0, {0, 0, KEY_PAGE_DOWN}}, {1000, {0, 0, 0}}}, 1100);
+    CHECK_EQ(slow.count(KeyEventType::REPEAT, KEY_PAGE_DOWN), 8);
+
+    Replay off;
+    off.keys.set_repeat_interval(0);
+    off.run({{0, {0, 0, KEY_DOWN}}, {1000, {0, 0, 0}}}, 1100);
+    CHECK_EQ(off.count(KeyEventType::REPEAT, KEY_DOWN), 0);
+
+    // A stalled loop gets one repeat, not a burst to catch up
+    Replay stalled;
+    const uint8_t down[8] = {0, 0, KEY_DOWN};
+    stalled.keys.process_report(down, 0);
+    CHECK_EQ(stalled.keys.tick(399), 0);
+    CHECK_EQ(stalled.keys.tick(1000), 1);
+    CHECK_EQ(stalled.keys.tick(1001), 0);
+    CHECK_EQ(stalled.keys.tick(1040), 1);
+}
+
+static void test_repeat_keys()
+{
+    // Holding Enter or Esc must not run the action again
+    Replay r;
+    r.run({{0, {0, 0, KEY_ENTER}}, {2000, {0, 0, 0}}, {2100, {0, 0, KEY_ESC}}, {4000, {0, 0, 0}}}, 4100);
+    CHECK_EQ(r.events.size(), 4);
+    CHECK_EQ(r.count(KeyEventType::REPEAT, KEY_ENTER), 0);
+    CHECK_EQ(r.count(KeyEventType::REPEAT, KEY_ESC), 0);
+
+    // The newest key takes over; a key that does not repeat stops it
+    Replay t;
+    t.run({{0, {0, 0, KEY_DOWN}}, {500, {0, 0, KEY_DOWN, KEY_UP}}, {1000, {0, 0, KEY_DOWN, KEY_UP, KEY_ENTER}},
+           {1500, {0, 0, 0}}},
+          1600);
+    CHECK_EQ(t.count(KeyEventType::REPEAT, KEY_DOWN), 3);  // 400, 440, 480
+    CHECK_EQ(t.count(KeyEventType::REPEAT, KEY_UP), 3);    // 900, 940, 980
+    CHECK_EQ(t.count(KeyEventType::REPEAT, KEY_ENTER), 0);
+
+    // Releasing the repeating key stops repeat even if an older key is still down
+    Replay u;
+    u.run({{0, {0, 0, KEY_DOWN}}, {100, {0, 0, KEY_DOWN, KEY_UP}}, {200, {0, 0, KEY_DOWN}}, {1000, {0, 0, 0}}}, 1100);
+    CHECK_EQ(u.count(KeyEventType::REPEAT, KEY_DOWN), 0);
+    CHECK_EQ(u.count(KeyEventType::REPEAT, KEY_UP), 0);
+}
+
+static void test_scroll_coalescing()
+{
+    // Fast scrolling: Down repeats every 10 ms for three seconds. Each event
+    // requests a render, as the display's key handler does, and loop() renders
+    // at most once per 40 ms frame.
+    Replay r;
+    r.keys.set_repeat_delay(250);
+    r.keys.set_repeat_interval(10);
+    RenderScheduler scheduler;
+    scheduler.set_frame_interval_us(40000);
+    size_t navigations = 0;
+    r.keys.set_event_callback([&](const KeyEvent &e)
+                              {
+                                  if (e.type != KeyEventType::RELEASE && (e.keycode == KEY_DOWN || e.keycode == KEY_UP))
+                                  {
+                                      navigations++;
+                                      scheduler.request();
+                                  }
+                              });
+    const Recorded reports[] = {{0, {0, 0, KEY_DOWN}}, {3000, {0, 0, 0}}};
+    size_t next = 0;
+    for (uint32_t ms = 0; ms <= 3100; ++ms)
+    {
+        if (next < 2 && reports[next].ms == ms)
+            r.keys.process_report(reports[next++].report, ms);
+        r.keys.tick(ms);
+        int64_t now_us = (int64_t)ms * 1000;
+        if (scheduler.should_render(now_us))
+        {
+            scheduler.begin_render(now_us);
+            scheduler.end_render(now_us + 5000);
+        }
+    }
+    RenderStats stats = scheduler.take_stats();
+    CHECK_EQ(navigations, 1 + (3000 - 250) / 10);
+    CHECK_EQ(stats.requests, navigations);
+    // One render for the press, then one per frame while repeating: 275 key
+    // events cost 71 renders
+    CHECK(stats.renders <= 1 + (3000 - 250 + 39) / 40 + 1);
+    CHECK(stats.renders >= (3000 - 250) / 40);
+    CHECK_EQ(stats.coalesced + stats.renders, stats.requests);
+    CHECK(!scheduler.is_pending());
+}
+
+int main()
+{
+    test_press_release();
+    test_chord();
+    test_link_loss();
+    test_repeat_timing();
+    test_repeat_keys();
+    test_scroll_coalescing();
+    return test_result("test_hid_key_tracker");
+}
@@ -0,0 +1,283 @@
+// LogStore on a file-backed partition with NOR flash rules: appends, wrap and
+// eviction, wear levelling, remounting, and power cut mid-write
+//   test_log_store scratch.bin
+#include "log_store.h"
+#include "test_support.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const size_t SECTOR = 4096, SECTORS = 6;
+
+// The partition lives in a file, so a remount reads back exactly what the
+// previous store wrote. Writes can only clear bits, as on NOR flash. A power
+// cut can be armed to stop the write that crosses it part way through.
+class FilePartition : public LogPartition
+{
+public:
+    explicit FilePartition(const char *path) : path_(path) {}
+    ~FilePartition() override
+    {
+        if (file_)
+            fclose(file_);
+    }
+
+    bool format()
+    {
+        if (file_)
+            fclose(file_);
+        file_ = fopen(path_.c_str(), "w+b");
+        if (!file_)
+            return false;
+        std::vector<uint8_t> blank(SECTORS * SECTOR, 0xFF);
+        erases_.assign(SECTORS, 0);
+        return fwrite(blank.data(), 1, blank.size(), file_) == blank.size() && fflush(file_) == 0;
+    }
+
+    size_t size() const override { return SECTORS * SECTOR; }
+    size_t sector_size() const override { return SECTOR; }
+
+    bool read(size_t offset, void *dst, size_t len) override
+    {
+        return offset + len <= size() && fseek(file_, offset, SEEK_SET) == 0 && fread(dst, 1, len, file_) == len;
+    }
+
+    bool write(size_t offset, const void *src, size_t len) override
+    {
+        uint8_t bytes[256];
+        if (len > sizeof(bytes) || !read(offset, bytes, len))
+            return false;
+        size_t n = len;
+        if (cut_after_ != SIZE_MAX)
+        {
+            n = std::min(len, cut_after_);
+            cut_after_ -= n;
+        }
+        for (size_t i = 0; i < n; ++i)
+            bytes[i] &= ((const uint8_t *)src)[i];
+        if (fseek(file_, offset, SEEK_SET) != 0 || fwrite(bytes, 1, n, file_) != n || fflush(file_) != 0)
+            return false;
+        return n == len;
+    }
+
+    bool erase_sector(size_t sector) override
+    {
+        if (cut_after_ == 0)
+            return false;
+        static const std::vector<uint8_t> blank(SECTOR, 0xFF);
+        erases_[sector]++;
+        return fseek(file_, sector * SECTOR, SEEK_SET) == 0 && fwrite(blank.data(), 1, SECTOR, file_) == SECTOR &&
+               fflush(file_) == 0;
+    }
+
+    // The power fails after this many more bytes have been written
+    void cut_power_after(size_t bytes) { cut_after_ = bytes; }
+    void restore_power() { cut_after_ = SIZE_MAX; }
+    void flip_bit(size_t offset, int bit)
+    {
+        uint8_t b;
+        read(offset, &b, 1);
+        b ^= 1 << bit;
+        fseek(file_, offset, SEEK_SET);
+        fwrite(&b, 1, 1, file_);
+        fflush(file_);
+    }
+    const std::vector<uint32_t> &erases() const { return erases_; }
+
+private:
+    std::string path_;
+    FILE *file_ = nullptr;
+    size_t cut_after_ = SIZE_MAX;
+    std::vector<uint32_t> erases_;
+};
+
+static std::string entry_text(int n)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%06d vault door %s after %d ms", n, n % 3 ? "opened" : "closed", n * 7 % 1000);
+    return buf;
+}
+
+static std::vector<std::string> entries(const LogStore &store)
+{
+    std::vector<std::string> out;
+    char buf[LogStore::kMaxEntryLength + 1];
+    for (size_t i = 0; i < store.count(); ++i)
+    {
+        size_t len = store.read(i, buf, sizeof(buf));
+        out.emplace_back(buf, len);
+    }
+    return out;
+}
+
+// Entries must be consecutive numbers ending at last
+static bool consecutive(const std::vector<std::string> &list, int last)
+{
+    for (size_t i = 0; i < list.size(); ++i)
+        if (list[i] != entry_text(last - (int)(list.size() - 1 - i)))
+            return false;
+    return true;
+}
+
+static void test_append_and_remount(const char *path)
+{
+    FilePartition flash(path);
+    CHECK(flash.format());
+    {
+        LogStore store;
+        CHECK(store.mount(&flash));
+        CHECK_EQ(store.count(), 0);
+        for (int i = 0; i < 5; ++i)
+        {
+            std::string e = entry_text(i);
+            CHECK(store.append(e.data(), e.size()));
+        }
+        CHECK_EQ(store.count(), 5);
+    }
+    LogStore store;
+    CHECK(store.mount(&flash));
+    CHECK_EQ(store.count(), 5);
+    CHECK(consecutive(entries(store), 4));
+    CHECK_EQ(store.stats().torn, 0);
+
+    // Long entries are cut to kMaxEntryLength; reads into small buffers are cut and terminated
+    std::string long_entry(200, 'x');
+    CHECK(store.append(long_entry.data(), long_entry.size()));
+    char buf[LogStore::kMaxEntryLength + 1];
+    CHECK_EQ(store.read(5, buf, sizeof(buf)), LogStore::kMaxEntryLength);
+    CHECK_EQ(store.read(0, buf, 4), 3);
+    CHECK(strcmp(buf, "000") == 0);
+    CHECK_EQ(store.read(99, buf, sizeof(buf)), 0);
+}
+
+static void test_wrap(const char *path)
+{
+    // Far more entries than fit: the ring holds the newest, stays within its
+    // capacity, wears every sector evenly and allocates nothing per append
+    FilePartition flash(path);
+    CHECK(flash.format());
+    LogStore store;
+    CHECK(store.mount(&flash));
+    size_t len = entry_text(0).size();
+    size_t capacity = store.capacity(len);
+    const int total = 5000;
+    std::vector<std::string> texts;
+    for (int i = 0; i < total; ++i)
+        texts.push_back(entry_text(i));
+    uint64_t allocs = test_alloc_count();
+    size_t max_count = 0;
+    for (const std::string &e : texts)
+    {
+        CHECK(store.append(e.data(), e.size()));
+        max_count = std::max(max_count, store.count());
+    }
+    CHECK_EQ(test_alloc_count() - allocs, 0);
+    CHECK(max_count <= capacity + capacity / (SECTORS - 1));
+    CHECK(store.count() >= capacity);
+    CHECK_EQ(store.stats().appends, total);
+    CHECK_EQ(store.stats().evicted + store.count(), total);
+    CHECK(consecutive(entries(store), total - 1));
+    auto erases = flash.erases();
+    auto [lo, hi] = std::minmax_element(erases.begin(), erases.end());
+    CHECK(*hi - *lo <= 1);
+
+    LogStore again;
+    CHECK(again.mount(&flash));
+    CHECK(entries(again) == entries(store));
+    std::string e = entry_text(total);
+    CHECK(again.append(e.data(), e.size()));
+    CHECK(consecutive(entries(again), total));
+}
+
+static void test_power_cut(const char *path)
+{
+    // Cut the power at every third byte of the last record in a sector, the
+    // next sector's header and the first record after it; after remounting, every completed entry is there and new
+    // entries go through and survive the next remount
+    FilePartition flash(path);
+    int cuts = 0, lost = 0, torn = 0;
+    for (size_t cut = 0; cut < 80; cut += 3)
+    {
+        CHECK(flash.format());
+        int written = 0;
+        {
+            LogStore store;
+            CHECK(store.mount(&flash));
+            // Fill to one record short of a full sector so the cut lands in the header too
+            size_t per_sector = store.capacity(entry_text(0).size()) / (SECTORS - 1);
+            while (store.count() < per_sector - 1)
+            {
+                std::string e = entry_text(written);
+                CHECK(store.append(e.data(), e.size()));
+                written++;
+            }
+            flash.cut_power_after(cut);
+            for (int i = 0; i < 3; ++i)
+            {
+                std::string e = entry_text(written);
+                bool ok = store.append(e.data(), e.size());
+                written++;
+                if (!ok)
+                    break;
+            }
+            flash.restore_power();
+        }
+        LogStore store;
+        CHECK(store.mount(&flash));
+        std::vector<std::string> list = entries(store);
+        // The entry being written may or may not have made it; nothing after it can have
+        CHECK((int)list.size() <= written);
+        CHECK(consecutive(list, (int)list.size() - 1));
+        lost += written - (int)list.size();
+        torn += store.stats().torn;
+        cuts++;
+        std::string e = entry_text((int)list.size());
+        CHECK(store.append(e.data(), e.size()));
+        LogStore after;
+        CHECK(after.mount(&flash));
+        CHECK(entries(after).size() == list.size() + 1);
+        CHECK(consecutive(entries(after), (int)list.size()));
+    }
+    // Only the entry being written when the power went can be missing
+    CHECK(lost <= cuts);
+    CHECK(torn > 0);
+}
+
+static void test_corruption(const char *path)
+{
+    // A flipped bit in a record drops it and the rest of its sector, nothing else
+    FilePartition flash(path);
+    CHECK(flash.format());
+    {
+        LogStore store;
+        CHECK(store.mount(&flash));
+        for (int i = 0; i < 200; ++i)
+        {
+            std::string e = entry_text(i);
+            store.append(e.data(), e.size());
+        }
+    }
+    flash.flip_bit(16 + 8 + 3, 2); // text of the first record in sector 0
+    LogStore store;
+    CHECK(store.mount(&flash));
+    CHECK_EQ(store.stats().torn, 1);
+    std::vector<std::string> list = entries(store);
+    CHECK(!list.empty() && list.size() < 200);
+    CHECK(consecutive(list, 199));
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: test_log_store scratch.bin\n");
+        return 1;
+    }
+    test_append_and_remount(argv[1]);
+    test_wrap(argv[1]);
+    test_power_cut(argv[1]);
+    test_corruption(argv[1]);
+    remove(argv[1]);
+    return test_result("test_log_store");
+}
@@ -0,0 +1,156 @@
+// MenuState's line view over the simulator's menu: which lines key presses and
+// status updates mark dirty, and heap allocations once the view is warm
+#include "menu_state.h"
+#include "sim_menu.h"
+#include "test_support.h"
+#include <chrono>
+#include <cstring>
+#include <string>
+
+static const uint8_t KEY_ENTER = 0x28, KEY_ESC = 0x29, KEY_DOWN = 0x51, KEY_UP = 0x52;
+static const size_t SCREEN_LINES = 20;
+
+static void open_menu(MenuState &menu)
+{
+    menu.set_definition(sim_menu);
+    menu.set_screen_lines(SCREEN_LINES);
+    menu.on_key_press(KEY_ENTER); // ends the boot text
+    menu.update_view();
+    menu.take_dirty_lines();
+    menu.take_scroll();
+}
+
+// Screen line starting with prefix, or -1
+static int find_line(const MenuState &menu, const char *prefix)
+{
+    for (size_t i = 0; i < SCREEN_LINES; ++i)
+        if (strncmp(menu.get_line(i).data, prefix, strlen(prefix)) == 0)
+            return (int)i;
+    return -1;
+}
+
+// What render_menu() does with the view after each change
+static size_t consume(MenuState &menu)
+{
+    menu.update_view();
+    menu.take_scroll();
+    uint32_t dirty = menu.take_dirty_lines();
+    size_t chars = 0;
+    for (size_t i = 0; i < SCREEN_LINES; ++i)
+        if (dirty & (1u << i))
+            chars += menu.get_line(i).len;
+    return chars;
+}
+
+static void test_key_press_lines()
+{
+    MenuState menu;
+    open_menu(menu);
+    // Moving the selection redraws the old and the new selected line only
+    int from = find_line(menu, "> Vault Door Control"), to = find_line(menu, "  System Status");
+    CHECK(from >= 0 && to >= 0);
+    uint32_t before = menu.get_line_generation(from) + menu.get_line_generation(to);
+    menu.on_key_press(KEY_DOWN);
+    menu.update_view();
+    CHECK_EQ(menu.take_dirty_lines(), (1u << from) | (1u << to));
+    CHECK_EQ(menu.get_line_generation(from) + menu.get_line_generation(to), before + 2);
+    CHECK_EQ(find_line(menu, "> System Status"), to);
+    // A key that changes nothing on screen dirties nothing
+    menu.on_key_press(0x04);
+    menu.update_view();
+    CHECK_EQ(menu.take_dirty_lines(), 0);
+}
+
+static void test_key_press_allocations()
+{
+    // Walk into and out of every submenu until the view has seen every list,
+    // then count allocations over the same walk
+    const uint8_t walk[] = {KEY_DOWN, KEY_ENTER, KEY_DOWN, KEY_UP, KEY_ESC, KEY_DOWN, KEY_ENTER, KEY_ESC,
+                            KEY_DOWN, KEY_ENTER, KEY_ESC, KEY_UP, KEY_UP, KEY_ENTER, KEY_DOWN, KEY_ESC};
+    MenuState menu;
+    open_menu(menu);
+    for (uint8_t key : walk)
+    {
+        menu.on_key_press(key);
+        consume(menu);
+    }
+    const int presses = 10000;
+    size_t chars = 0;
+    uint64_t allocs = test_alloc_count();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < presses; ++i)
+    {
+        menu.on_key_press(walk[i % sizeof(walk)]);
+        chars += consume(menu);
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    CHECK_EQ(test_alloc_count() - allocs, 0);
+    CHECK(chars > 0);
+    printf("key press + update_view: %.0f ns on this host, %llu allocations in %d presses\n", (double)ns / presses,
+           (unsigned long long)(test_alloc_count() - allocs), presses);
+}
+
+static void test_status_updates()
+{
+    // 1000 door state updates, as MQTT delivers them, while System Status is open
+    MenuState menu;
+    open_menu(menu);
+    menu.on_key_press(KEY_DOWN);
+    menu.on_key_press(KEY_ENTER);
+    consume(menu);
+    MenuTree &tree = menu.get_menu_tree();
+    int32_t door = tree.find_id("door_status");
+    CHECK(door != MenuTree::kNoNode);
+    int line = find_line(menu, "  Door: Unknown");
+    CHECK(line >= 0);
+    if (door == MenuTree::kNoNode || line < 0)
+        return;
+    uint32_t version = tree.status(door).version;
+    uint32_t generation = menu.get_line_generation(line);
+    int wrong_lines = 0;
+    uint64_t allocs = test_alloc_count();
+    for (int i = 0; i < 1000; ++i)
+    {
+        char value[24];
+        int len = snprintf(value, sizeof(value), i % 2 ? "Opened (%d ms)" : "Closed (%d ms)", 100 + i);
+        CHECK(tree.set_status(door, value, len));
+        menu.update_view();
+        wrong_lines += menu.take_dirty_lines() != 1u << line;
+    }
+    CHECK_EQ(test_alloc_count() - allocs, 0);
+    CHECK_EQ(wrong_lines, 0);
+    CHECK_EQ(tree.status(door).version, version + 1000);
+    CHECK_EQ(menu.get_line_generation(line), generation + 1000);
+    CHECK(strcmp(menu.get_line(line).data, "  Door: Opened (1099 ms)") == 0);
+
+    // The same value again is not a change
+    CHECK(!tree.set_status(door, "Opened (1099 ms)", 16));
+    menu.update_view();
+    CHECK_EQ(menu.take_dirty_lines(), 0);
+
+    // Updates for a menu that is not open redraw nothing, and show once it is
+    menu.on_key_press(KEY_ESC);
+    consume(menu);
+    allocs = test_alloc_count();
+    for (int i = 0; i < 1000; ++i)
+    {
+        char value[24];
+        int len = snprintf(value, sizeof(value), "Moving %d", i);
+        tree.set_status(door, value, len);
+        menu.update_view();
+        wrong_lines += menu.take_dirty_lines() != 0;
+    }
+    CHECK_EQ(test_alloc_count() - allocs, 0);
+    CHECK_EQ(wrong_lines, 0);
+    menu.on_key_press(KEY_ENTER);
+    consume(menu);
+    CHECK_EQ(find_line(menu, "  Door: Moving 999"), line);
+}
+
+int main()
+{
+    test_key_press_lines();
+    test_key_press_allocations();
+    test_status_updates();
+    return test_result("test_menu_state");
+}
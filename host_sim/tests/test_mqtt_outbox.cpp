@@ -0,0 +1,306 @@
+// MqttOutbox driven through a scripted transport: queueing while offline,
+// retry backoff when the client refuses a publish, dedupe, ack latency, and
+// the timeouts that end a command without an ack
+#include "mqtt_outbox.h"
+#include "test_support.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const int64_t MS = 1000;
+
+// The MQTT client as the outbox sees it: connected or not, and refusing the
+// next few publishes when told to, as esp-mqtt does while its outbox is full
+class MockTransport : public OutboxTransport
+{
+public:
+    bool connected = true;
+    int refuse = 0;
+    int attempts = 0;
+    std::vector<std::string> published;
+
+    bool is_connected() override { return connected; }
+    bool publish(const char *topic, const char *payload, uint8_t qos) override
+    {
+        attempts++;
+        if (refuse > 0)
+        {
+            refuse--;
+            return false;
+        }
+        published.push_back(std::string(topic) + " " + payload);
+        return true;
+    }
+};
+
+struct Logged
+{
+    OutboxEvent event;
+    std::string topic;
+    uint32_t ms;
+};
+
+struct Fixture
+{
+    MockTransport transport;
+    MqttOutbox outbox;
+    std::vector<Logged> events;
+
+    Fixture()
+    {
+        outbox.set_transport(&transport);
+        outbox.set_listener([this](const OutboxCommand &command, OutboxEvent event, uint32_t ms)
+                            { events.push_back({event, command.topic, ms}); });
+    }
+
+    // Call process() every millisecond from from_ms to to_ms, as loop() does
+    void run(int64_t from_ms, int64_t to_ms)
+    {
+        for (int64_t ms = from_ms; ms <= to_ms; ++ms)
+            outbox.process(ms * MS);
+    }
+
+    size_t count(OutboxEvent event) const
+    {
+        size_t n = 0;
+        for (const Logged &l : events)
+            n += l.event == event;
+        return n;
+    }
+};
+
+static void test_offline_queueing()
+{
+    // Commands queued while the broker is away go out in order, one per
+    // process() call, once it is back
+    Fixture f;
+    f.transport.connected = false;
+    CHECK(f.outbox.enqueue("garage/door/open", "1234", "opened", 0));
+    CHECK(f.outbox.enqueue("garage/light", "on", "", 10 * MS));
+    CHECK(f.outbox.enqueue("garage/door/close", "", "closed", 20 * MS));
+    f.run(0, 5000);
+    CHECK_EQ(f.transport.attempts, 0);
+    CHECK_EQ(f.outbox.size(), 3);
+
+    f.transport.connected = true;
+    f.outbox.process(5001 * MS);
+    CHECK_EQ(f.transport.published.size(), 1);
+    f.outbox.process(5002 * MS);
+    f.outbox.process(5003 * MS);
+    CHECK_EQ(f.transport.published.size(), 3);
+    if (f.transport.published.size() == 3)
+    {
+        CHECK(f.transport.published[0] == "garage/door/open 1234");
+        CHECK(f.transport.published[1] == "garage/light on");
+        CHECK(f.transport.published[2] == "garage/door/close ");
+    }
+    // A command without an ack is done once published; the others wait for theirs
+    CHECK_EQ(f.outbox.size(), 2);
+    CHECK_EQ(f.count(OutboxEvent::QUEUED), 3);
+    CHECK_EQ(f.count(OutboxEvent::PUBLISHED), 3);
+
+    OutboxStats stats = f.outbox.take_stats();
+    CHECK_EQ(stats.queued, 3);
+    CHECK_EQ(stats.published, 3);
+    CHECK_EQ(stats.retries, 0);
+    CHECK_EQ(f.outbox.take_stats().queued, 0);
+}
+
+static void test_retry_backoff()
+{
+    // The client refuses five publishes: each retry waits twice as long as the
+    // one before, starting at 250 ms, and the command still goes out once
+    Fixture f;
+    f.transport.refuse = 5;
+    std::vector<int64_t> attempt_ms;
+    CHECK(f.outbox.enqueue("garage/door/open", "1234", "opened", 0));
+    for (int64_t ms = 0; ms <= 20000 && f.transport.published.empty(); ++ms)
+    {
+        int before = f.transport.attempts;
+        f.outbox.process(ms * MS);
+        if (f.transport.attempts != before)
+            attempt_ms.push_back(ms);
+    }
+    const int64_t expect[] = {0, 250, 750, 1750, 3750, 7750};
+    CHECK_EQ(attempt_ms.size(), 6);
+    for (size_t i = 0; i < attempt_ms.size() && i < 6; ++i)
+        CHECK_EQ(attempt_ms[i], expect[i]);
+    CHECK_EQ(f.transport.published.size(), 1);
+    OutboxStats stats = f.outbox.take_stats();
+    CHECK_EQ(stats.retries, 5);
+    CHECK_EQ(stats.published, 1);
+
+    // The delay stops growing at 8 s
+    Fixture g;
+    g.transport.refuse = 1000;
+    g.outbox.set_expire_us(600 * 1000 * MS);
+    CHECK(g.outbox.enqueue("garage/door/open", "1234", "opened", 0));
+    g.run(0, 120000);
+    // 0, 250, 750, 1750, 3750, 7750, then every 8 s from 15750 to 119750
+    CHECK_EQ(g.transport.attempts, 6 + (119750 - 15750) / 8000 + 1);
+
+    // A waiting command blocks the ones behind it, so order is kept
+    Fixture h;
+    h.transport.refuse = 1;
+    CHECK(h.outbox.enqueue("a", "1", "", 0));
+    CHECK(h.outbox.enqueue("b", "2", "", 0));
+    h.run(0, 249);
+    CHECK(h.transport.published.empty());
+    h.run(250, 260);
+    CHECK_EQ(h.transport.published.size(), 2);
+    if (h.transport.published.size() == 2)
+        CHECK(h.transport.published[0] == "a 1");
+}
+
+static void test_dedupe()
+{
+    // Pressing the key again before the command goes out does not queue it twice
+    Fixture f;
+    f.transport.connected = false;
+    for (int i = 0; i < 5; ++i)
+        CHECK(f.outbox.enqueue("garage/door/open", "1234", "opened", i * 100 * MS));
+    CHECK_EQ(f.outbox.size(), 1);
+    // Open, Close, Open: only the newest command is a duplicate candidate, so
+    // the broker gets the Open the user asked for last
+    CHECK(f.outbox.enqueue("garage/door/close", "", "closed", 500 * MS));
+    CHECK(f.outbox.enqueue("garage/door/open", "1234", "opened", 510 * MS));
+    CHECK_EQ(f.outbox.size(), 3);
+    f.transport.connected = true;
+    f.run(600, 610);
+    // Sent and waiting for its ack is not a duplicate either
+    CHECK(f.outbox.enqueue("garage/door/open", "1234", "opened", 700 * MS));
+    f.run(701, 710);
+    const std::vector<std::string> expected = {"garage/door/open 1234", "garage/door/close ", "garage/door/open 1234",
+                                               "garage/door/open 1234"};
+    CHECK(f.transport.published == expected);
+    OutboxStats stats = f.outbox.take_stats();
+    CHECK_EQ(stats.queued, 4);
+    CHECK_EQ(stats.deduped, 4);
+
+    // Fields that do not fit are refused rather than cut
+    std::string long_topic(OutboxCommand::kMaxTopic + 1, 't');
+    CHECK(!f.outbox.enqueue(long_topic.c_str(), "", "", 0));
+    CHECK(!f.outbox.enqueue("t", "", "much too long an ack", 0));
+    CHECK_EQ(f.outbox.size(), 4);
+}
+
+static void test_ack_latency()
+{
+    // Latency runs from the key press to the state update, so time spent
+    // offline counts
+    Fixture f;
+    f.transport.connected = false;
+    CHECK(f.outbox.enqueue("garage/door/open", "1234", "opened", 1000 * MS));
+    f.run(1000, 2999);
+    f.transport.connected = true;
+    f.run(3000, 3100);
+    // An update nothing is waiting for is not an ack
+    CHECK(!f.outbox.acknowledge("closed", 3200 * MS));
+    uint32_t ms = 0;
+    CHECK(f.outbox.acknowledge("opened", 3450 * MS, &ms));
+    CHECK_EQ(ms, 2450);
+    CHECK_EQ(f.count(OutboxEvent::ACKED), 1);
+    if (!f.events.empty())
+        CHECK_EQ(f.events.back().ms, 2450);
+
+    // The oldest published command gets the ack; unsent ones cannot be acked
+    CHECK(f.outbox.enqueue("garage/door/close", "", "closed", 4000 * MS));
+    CHECK(f.outbox.enqueue("garage/door/close", "x", "closed", 4000 * MS));
+    f.outbox.process(4010 * MS);
+    CHECK(f.outbox.acknowledge("closed", 4100 * MS, &ms));
+    CHECK_EQ(ms, 100);
+    CHECK(!f.outbox.acknowledge("closed", 4110 * MS));
+    f.outbox.process(4120 * MS);
+    CHECK(f.outbox.acknowledge("closed", 4300 * MS, &ms));
+    CHECK_EQ(ms, 300);
+    OutboxStats stats = f.outbox.take_stats();
+    CHECK_EQ(stats.acked, 3);
+    CHECK_EQ(stats.max_ack_ms, 2450);
+}
+
+static void test_timeouts()
+{
+    Fixture f;
+    f.outbox.set_expire_us(5000 * MS);
+    f.outbox.set_ack_timeout_us(2000 * MS);
+
+    // Published but never confirmed
+    CHECK(f.outbox.enqueue("garage/door/open", "1234", "opened", 0));
+    f.run(0, 1999);
+    CHECK_EQ(f.count(OutboxEvent::NO_ACK), 0);
+    f.outbox.process(2000 * MS);
+    CHECK_EQ(f.count(OutboxEvent::NO_ACK), 1);
+    CHECK(!f.outbox.acknowledge("opened", 2100 * MS));
+
+    // Never published
+    f.transport.connected = false;
+    CHECK(f.outbox.enqueue("garage/door/close", "", "closed", 3000 * MS));
+    f.run(3000, 7999);
+    CHECK_EQ(f.count(OutboxEvent::EXPIRED), 0);
+    f.outbox.process(8000 * MS);
+    CHECK_EQ(f.count(OutboxEvent::EXPIRED), 1);
+    CHECK_EQ(f.outbox.size(), 0);
+
+    // A full outbox drops its oldest command for the new one
+    char payload[8];
+    for (size_t i = 0; i <= MqttOutbox::kCapacity; ++i)
+    {
+        snprintf(payload, sizeof(payload), "%zu", i);
+        CHECK(f.outbox.enqueue("garage/light", payload, "", 9000 * MS));
+    }
+    CHECK_EQ(f.outbox.size(), MqttOutbox::kCapacity);
+    CHECK_EQ(f.count(OutboxEvent::DROPPED), 1);
+    f.transport.connected = true;
+    f.transport.published.clear();
+    f.run(9001, 9100);
+    CHECK_EQ(f.transport.published.size(), MqttOutbox::kCapacity);
+    if (!f.transport.published.empty())
+        CHECK(f.transport.published[0] == "garage/light 1");
+
+    OutboxStats stats = f.outbox.take_stats();
+    CHECK_EQ(stats.unacked, 1);
+    CHECK_EQ(stats.expired, 1);
+    CHECK_EQ(stats.dropped, 1);
+}
+
+static void test_allocations()
+{
+    // Queueing, publishing and acking allocate nothing; the transport and
+    // listener here only count, so any allocation is the outbox's
+    struct CountingTransport : OutboxTransport
+    {
+        int published = 0;
+        bool is_connected() override { return true; }
+        bool publish(const char *topic, const char *payload, uint8_t qos) override
+        {
+            published++;
+            return true;
+        }
+    } transport;
+    MqttOutbox outbox;
+    int acked = 0;
+    outbox.set_transport(&transport);
+    outbox.set_listener([&acked](const OutboxCommand &command, OutboxEvent event, uint32_t ms)
+                        { acked += event == OutboxEvent::ACKED; });
+    uint64_t allocs = test_alloc_count();
+    for (int i = 0; i < 1000; ++i)
+    {
+        outbox.enqueue("garage/door/open", "1234", "opened", i * 10 * MS);
+        outbox.process((i * 10 + 1) * MS);
+        outbox.acknowledge("opened", (i * 10 + 5) * MS);
+    }
+    CHECK_EQ(test_alloc_count() - allocs, 0);
+    CHECK_EQ(transport.published, 1000);
+    CHECK_EQ(acked, 1000);
+}
+
+int main()
+{
+    test_offline_queueing();
+    test_retry_backoff();
+    test_dedupe();
+    test_ack_latency();
+    test_timeouts();
+    test_allocations();
+    return test_result("test_mqtt_outbox");
+}
@@ -0,0 +1,130 @@
+// RenderTrace on a cycle counter the test sets: histogram buckets, percentiles,
+// windows taken by two readers, counter wraparound, the enable switch, and
+// what a scope costs per frame
+#include "render_trace.h"
+#include "test_support.h"
+#include <chrono>
+
+using namespace esphome::robco_display;
+
+static const uint32_t MHZ = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+static uint32_t fake_cycles = 0;
+
+extern "C" uint32_t esp_cpu_get_cycle_count()
+{
+    return fake_cycles;
+}
+
+static void record_us(RenderTrace &trace, TraceStage stage, uint32_t us)
+{
+    uint32_t start = fake_cycles;
+    fake_cycles += us * MHZ;
+    trace.record_since(stage, start);
+}
+
+static void test_buckets()
+{
+    RenderTrace trace, base;
+    // 0 us, then 1, 2-3, 4-7 ... us, and one far past the last bucket
+    const uint32_t samples[] = {0, 1, 3, 4, 7, 100, 1000, 5000000};
+    for (uint32_t us : samples)
+        record_us(trace, TraceStage::DRAW, us);
+    TraceSummary s = trace.take(TraceStage::DRAW, base);
+    CHECK_EQ(s.count, 8);
+    CHECK_EQ(s.total_us, 0 + 1 + 3 + 4 + 7 + 100 + 1000 + 5000000);
+    CHECK_EQ(s.peak_us, 5000000);
+    CHECK_EQ(s.buckets[0], 1);
+    CHECK_EQ(s.buckets[1], 1);
+    CHECK_EQ(s.buckets[2], 1);
+    CHECK_EQ(s.buckets[3], 2);
+    CHECK_EQ(s.buckets[7], 1);  // 100 us: 64-127
+    CHECK_EQ(s.buckets[10], 1); // 1000 us: 512-1023
+    CHECK_EQ(s.buckets[TraceSummary::NUM_BUCKETS - 1], 1);
+    // Percentiles give the bucket's upper bound; the last bucket gives the peak
+    CHECK_EQ(s.percentile_us(50), 8);
+    CHECK_EQ(s.percentile_us(75), 128);
+    CHECK_EQ(s.percentile_us(100), 5000000);
+    CHECK_EQ(s.avg_us(), s.total_us / 8);
+    // Other stages saw nothing
+    CHECK_EQ(trace.take(TraceStage::KEY, base).count, 0);
+    CHECK_EQ(TraceSummary().percentile_us(95), 0);
+}
+
+static void test_windows()
+{
+    // The sensors and the log command read the same trace with their own
+    // bases; neither takes samples away from the other
+    RenderTrace trace, sensors, dump;
+    for (int i = 0; i < 10; ++i)
+        record_us(trace, TraceStage::VIEW, 50);
+    CHECK_EQ(trace.take(TraceStage::VIEW, sensors).count, 10);
+    for (int i = 0; i < 5; ++i)
+        record_us(trace, TraceStage::VIEW, 200);
+    TraceSummary s = trace.take(TraceStage::VIEW, sensors);
+    CHECK_EQ(s.count, 5);
+    CHECK_EQ(s.total_us, 1000);
+    CHECK_EQ(s.percentile_us(95), 256);
+    TraceSummary d = trace.take(TraceStage::VIEW, dump);
+    CHECK_EQ(d.count, 15);
+    CHECK_EQ(d.total_us, 1500);
+    CHECK_EQ(trace.take(TraceStage::VIEW, dump).count, 0);
+
+    // The cycle counter wraps every 18 s at 240 MHz; a stage that spans the
+    // wrap still measures the right time
+    RenderTrace wrap, base;
+    fake_cycles = UINT32_MAX - 10 * MHZ;
+    record_us(wrap, TraceStage::FLUSH, 30);
+    CHECK_EQ(wrap.take(TraceStage::FLUSH, base).total_us, 30);
+}
+
+static void test_enabled()
+{
+    RenderTrace trace, base;
+    trace.set_enabled(false);
+    {
+        TraceScope scope(trace, TraceStage::KEY);
+        fake_cycles += 500 * MHZ;
+    }
+    CHECK_EQ(trace.take(TraceStage::KEY, base).count, 0);
+    trace.set_enabled(true);
+    {
+        TraceScope scope(trace, TraceStage::KEY);
+        fake_cycles += 500 * MHZ;
+    }
+    TraceSummary s = trace.take(TraceStage::KEY, base);
+    CHECK_EQ(s.count, 1);
+    CHECK_EQ(s.total_us, 500);
+    CHECK(RenderTrace::stage_name(TraceStage::KEY_TO_DRAW)[0] != '?');
+}
+
+static void test_overhead()
+{
+    // A frame records about eight samples; against a 40 ms frame the budget
+    // for 1% is 400 us, so a scope has to stay far below 50 us. On the device
+    // a counter read is one instruction; here it is a load, so this bounds the
+    // bookkeeping around it.
+    RenderTrace trace;
+    const int scopes = 1000000;
+    uint64_t allocs = test_alloc_count();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < scopes; ++i)
+    {
+        TraceScope scope(trace, (TraceStage)(i % RenderTrace::NUM_STAGES));
+        fake_cycles += 7;
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    CHECK_EQ(test_alloc_count() - allocs, 0);
+    double per_scope = (double)ns / scopes;
+    CHECK(per_scope < 1000);
+    printf("TraceScope: %.1f ns on this host, %.4f%% of a 40 ms frame at 8 scopes per frame\n", per_scope,
+           per_scope * 8 / 40e6 * 100);
+}
+
+int main()
+{
+    test_buckets();
+    test_windows();
+    test_enabled();
+    test_overhead();
+    return test_result("test_render_trace");
+}
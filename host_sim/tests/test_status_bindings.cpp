@@ -0,0 +1,120 @@
+// StatusBindings against a 1000-topic table from make_status_topics.py: the
+// C++ hash matches the generator's, every bound topic finds its own binding,
+// unbound topics find none, and lookups allocate nothing
+#include "status_bindings.h"
+#include "test_support.h"
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Generated at build time by make_status_topics.py
+#include "status_topics.inc"
+
+static const size_t TOPICS = 1000;
+
+static void test_hash_agrees()
+{
+    int wrong = 0;
+    for (const ExpectedHash &e : topics_expected_hashes)
+    {
+        uint32_t hash = status_topic_hash(e.seed, e.topic, strlen(e.topic));
+        if (hash != e.hash && wrong++ < 5)
+            fprintf(stderr, "'%s' seed %u: %08x, the generator has %08x\n", e.topic, e.seed, hash, e.hash);
+    }
+    CHECK_EQ(sizeof(topics_expected_hashes) / sizeof(topics_expected_hashes[0]), TOPICS * 3);
+    CHECK_EQ(wrong, 0);
+}
+
+static void test_lookup()
+{
+    StatusBindings bindings;
+    bindings.set_table(&topics_status_bindings);
+    CHECK_EQ(topics_status_bindings.binding_count, TOPICS);
+
+    // Every slot that holds a topic is found by that topic, and no slot twice
+    std::vector<std::string> bound;
+    int wrong = 0;
+    for (uint32_t slot = 0; slot <= topics_status_bindings.slot_mask; ++slot)
+    {
+        const StatusBinding &binding = topics_status_slots[slot];
+        if (binding.topic == nullptr)
+            continue;
+        bound.push_back(binding.topic);
+        wrong += bindings.find(binding.topic, strlen(binding.topic)) != &binding;
+    }
+    CHECK_EQ(bound.size(), TOPICS);
+    CHECK_EQ(wrong, 0);
+
+    // Near misses: prefixes, extensions, one changed byte, and other levels
+    std::vector<std::string> unbound;
+    for (const std::string &topic : bound)
+    {
+        unbound.push_back(topic.substr(0, topic.size() - 1));
+        unbound.push_back(topic + "x");
+        unbound.push_back(topic + "/set");
+        std::string changed = topic;
+        changed[changed.size() / 2] ^= 0x20;
+        unbound.push_back(changed);
+    }
+    unbound.push_back("");
+    unbound.push_back("home/#");
+    size_t found = 0;
+    for (const std::string &topic : unbound)
+        found += bindings.find(topic.data(), topic.size()) != nullptr;
+    CHECK_EQ(found, 0);
+
+    // Topics arrive as a pointer and length into the MQTT buffer, not terminated
+    std::string buffer = bound[0] + "/unterminated";
+    const StatusBinding *binding = bindings.find(buffer.data(), bound[0].size());
+    CHECK(binding != nullptr && bound[0] == binding->topic);
+
+    StatusBindings empty;
+    CHECK(empty.find(bound[0].data(), bound[0].size()) == nullptr);
+
+    uint64_t allocs = test_alloc_count();
+    const int rounds = 100;
+    size_t hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+        for (const std::string &topic : bound)
+            hits += bindings.find(topic.data(), topic.size()) != nullptr;
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    CHECK_EQ(test_alloc_count() - allocs, 0);
+    CHECK_EQ(hits, rounds * TOPICS);
+    printf("find: %.0f ns per topic on this host over %zu topics in %u slots\n", (double)ns / hits, TOPICS,
+           topics_status_bindings.slot_mask + 1);
+}
+
+static void test_format()
+{
+    StatusBindings bindings;
+    bindings.set_table(&topics_status_bindings);
+    const char *state = "home/garage/door0/state", *power = "home/garage/door0/power";
+    const StatusBinding *s = bindings.find(state, strlen(state));
+    const StatusBinding *p = bindings.find(power, strlen(power));
+    CHECK(s != nullptr && p != nullptr);
+    if (s == nullptr || p == nullptr)
+        return;
+    char out[16];
+    CHECK_EQ(bindings.format(*s, "on", 2, out, sizeof(out)), 2);
+    CHECK(strcmp(out, "On") == 0);
+    // Only exact payloads are mapped
+    CHECK_EQ(bindings.format(*s, "onn", 2, out, sizeof(out)), 2);
+    CHECK(strcmp(out, "On") == 0);
+    bindings.format(*s, "online", 6, out, sizeof(out));
+    CHECK(strcmp(out, "online") == 0);
+    bindings.format(*p, "1500", 4, out, sizeof(out));
+    CHECK(strcmp(out, "1500 W") == 0);
+    // Cut to fit, suffix included
+    CHECK_EQ(bindings.format(*p, "123456789012345", 15, out, 8), 7);
+    CHECK(strcmp(out, "1234567") == 0);
+}
+
+int main()
+{
+    test_hash_agrees();
+    test_lookup();
+    test_format();
+    return test_result("test_status_bindings");
+}
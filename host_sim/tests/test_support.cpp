@@ -0,0 +1,86 @@
+// Allocation counting and the heap_caps_* calls component code makes, for
+// tests that link component sources without the rest of the simulator
+#include "test_support.h"
+#include "esp_heap_caps.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+int test_failures = 0;
+
+static std::atomic<uint64_t> allocs{0};
+
+uint64_t test_alloc_count()
+{
+    return allocs.load(std::memory_order_relaxed);
+}
+
+int test_result(const char *name)
+{
+    if (test_failures)
+        fprintf(stderr, "%s: %d check(s) failed\n", name, test_failures);
+    else
+        printf("%s: ok\n", name);
+    return test_failures ? 1 : 0;
+}
+
+void *operator new(size_t size)
+{
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    return calloc(n, size);
+}
+
+void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps)
+{
+    allocs.fetch_add(1, std::memory_order_relaxed);
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return caps & MALLOC_CAP_SPIRAM ? 8 * 1024 * 1024 : 320 * 1024;
+}
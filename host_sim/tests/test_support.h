@@ -0,0 +1,36 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+
+// Checks for the host unit tests. A failed check prints where it failed and
+// the test carries on; main() returns test_result() so ctest sees the failure.
+
+extern int test_failures;
+
+#define CHECK(cond)                                                      \
+    do                                                                   \
+    {                                                                    \
+        if (!(cond))                                                     \
+        {                                                                \
+            fprintf(stderr, "%s:%d: CHECK(%s)\n", __FILE__, __LINE__, #cond); \
+            test_failures++;                                             \
+        }                                                                \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                   \
+    do                                                                   \
+    {                                                                    \
+        long long check_a_ = (long long)(a), check_b_ = (long long)(b);  \
+        if (check_a_ != check_b_)                                        \
+        {                                                                \
+            fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s): %lld != %lld\n",   \
+                    __FILE__, __LINE__, #a, #b, check_a_, check_b_);     \
+            test_failures++;                                             \
+        }                                                                \
+    } while (0)
+
+// operator new and heap_caps_* calls since start, as sim_alloc_count() counts them
+uint64_t test_alloc_count();
+
+// Prints a summary line; the exit status for main()
+int test_result(const char *name);
@@ -0,0 +1,252 @@
+// VtParser writing into a TerminalGrid: cursor addressing, erase in display
+// and line, scroll regions with insert and delete line, SGR attributes, the
+// DEC line drawing set, and UTF-8 that is cut short or split across feeds
+#include "vt_parser.h"
+#include "test_support.h"
+#include <cstring>
+#include <string>
+
+using namespace esphome::robco_display;
+
+static const size_t ROWS = 8, COLS = 20;
+
+struct Terminal
+{
+    TerminalGrid grid;
+    VtParser parser;
+
+    Terminal()
+    {
+        grid.resize(ROWS, COLS);
+        parser.attach(&grid, nullptr);
+    }
+
+    void feed(const char *text) { parser.feed((const uint8_t *)text, strlen(text)); }
+
+    // Row contents with trailing blanks dropped
+    std::string row(size_t r) const
+    {
+        std::string s;
+        for (size_t c = 0; c < COLS; ++c)
+            s += grid.cell(r, c).ch;
+        return s.substr(0, s.find_last_not_of(' ') + 1);
+    }
+
+    // Puts "row N" on every line, leaving the cursor on the last one
+    void fill()
+    {
+        for (size_t r = 0; r < ROWS; ++r)
+        {
+            char line[32];
+            snprintf(line, sizeof(line), "\x1b[%zu;1Hrow %zu", r + 1, r);
+            feed(line);
+        }
+    }
+};
+
+static void test_cursor_position()
+{
+    Terminal t;
+    t.feed("\x1b[3;5HX");
+    CHECK(t.row(2) == "    X");
+    CHECK_EQ(t.parser.cursor_row(), 2);
+    CHECK_EQ(t.parser.cursor_col(), 5);
+
+    // Missing and zero parameters mean 1
+    t.feed("\x1b[HA\x1b[;3HB\x1b[0;0fC");
+    CHECK(t.row(0) == "C B");
+
+    // Past the edge clamps to the last row and column
+    t.feed("\x1b[99;99HZ");
+    CHECK_EQ(t.grid.cell(ROWS - 1, COLS - 1).ch, 'Z');
+    CHECK_EQ(t.parser.cursor_row(), (int)ROWS - 1);
+    CHECK_EQ(t.parser.cursor_col(), (int)COLS - 1);
+
+    // The cursor stays in the last column until the next printable wraps it
+    t.feed("\x1b[1;20Hxy");
+    CHECK_EQ(t.grid.cell(0, COLS - 1).ch, 'x');
+    CHECK(t.row(1) == "y");
+}
+
+static void test_erase()
+{
+    Terminal t;
+    t.fill();
+
+    // EL: from the cursor, up to it, and the whole line
+    t.feed("\x1b[1;3H\x1b[K");
+    CHECK(t.row(0) == "ro");
+    t.feed("\x1b[2;3H\x1b[1K");
+    CHECK(t.row(1) == "    1");
+    t.feed("\x1b[3;3H\x1b[2K");
+    CHECK(t.row(2) == "");
+    CHECK(t.row(3) == "row 3");
+
+    // ED 1 clears up to and including the cursor, ED 0 from it on
+    t.feed("\x1b[5;2H\x1b[1J");
+    CHECK(t.row(3) == "");
+    CHECK(t.row(4) == "  w 4");
+    t.feed("\x1b[6;4H\x1b[J");
+    CHECK(t.row(4) == "  w 4");
+    CHECK(t.row(5) == "row");
+    CHECK(t.row(6) == "");
+    CHECK(t.row(7) == "");
+
+    // ED 2 clears everything and leaves the cursor where it was
+    t.fill();
+    t.feed("\x1b[4;6H\x1b[2J");
+    for (size_t r = 0; r < ROWS; ++r)
+        CHECK(t.row(r) == "");
+    CHECK_EQ(t.parser.cursor_row(), 3);
+    CHECK_EQ(t.parser.cursor_col(), 5);
+}
+
+static void test_scroll_region()
+{
+    Terminal t;
+    t.fill();
+
+    // DECSTBM homes the cursor; a line feed at the bottom margin scrolls only the region
+    t.feed("\x1b[3;5r");
+    CHECK_EQ(t.parser.cursor_row(), 0);
+    CHECK_EQ(t.parser.cursor_col(), 0);
+    t.feed("\x1b[5;1H\nnew");
+    CHECK(t.row(1) == "row 1");
+    CHECK(t.row(2) == "row 3");
+    CHECK(t.row(3) == "row 4");
+    CHECK(t.row(4) == "new");
+    CHECK(t.row(5) == "row 5");
+
+    // Reverse index at the top margin scrolls the region down
+    t.feed("\x1b[3;1H\x1bM");
+    CHECK(t.row(2) == "");
+    CHECK(t.row(3) == "row 3");
+    CHECK(t.row(4) == "row 4");
+    CHECK(t.row(5) == "row 5");
+
+    // A region that is not at least two rows is ignored
+    t.feed("\x1b[2;2H\x1b[4;4r");
+    CHECK_EQ(t.parser.cursor_row(), 1);
+    CHECK_EQ(t.parser.cursor_col(), 1);
+
+    // Without parameters the region is the whole screen again
+    t.feed("\x1b[r\x1b[8;1H\n");
+    CHECK(t.row(0) == "row 1");
+    CHECK(t.row(ROWS - 1) == "");
+}
+
+static void test_insert_delete_lines()
+{
+    Terminal t;
+    t.fill();
+    t.feed("\x1b[2;6r");
+
+    // IL pushes the rest of the region down and drops what leaves it
+    t.feed("\x1b[3;4H\x1b[2L");
+    CHECK_EQ(t.parser.cursor_col(), 0);
+    CHECK(t.row(1) == "row 1");
+    CHECK(t.row(2) == "");
+    CHECK(t.row(3) == "");
+    CHECK(t.row(4) == "row 2");
+    CHECK(t.row(5) == "row 3");
+    CHECK(t.row(6) == "row 6");
+
+    // DL pulls it back up and blanks the bottom of the region
+    t.feed("\x1b[3;1H\x1b[2M");
+    CHECK(t.row(2) == "row 2");
+    CHECK(t.row(3) == "row 3");
+    CHECK(t.row(4) == "");
+    CHECK(t.row(5) == "");
+    CHECK(t.row(6) == "row 6");
+
+    // More lines than the region holds clears it
+    t.feed("\x1b[2;1H\x1b[99M");
+    for (size_t r = 1; r <= 5; ++r)
+        CHECK(t.row(r) == "");
+    CHECK(t.row(0) == "row 0");
+
+    // Outside the region both are ignored
+    t.feed("\x1b[7;1H\x1b[L\x1b[M");
+    CHECK(t.row(6) == "row 6");
+    CHECK(t.row(7) == "row 7");
+}
+
+static void test_sgr()
+{
+    Terminal t;
+    t.feed("a\x1b[7mb\x1b[4mc\x1b[27md\x1b[0me\x1b[4;7mf\x1b[mg");
+    const uint8_t expected[] = {CELL_ATTR_NONE,
+                                CELL_ATTR_INVERSE,
+                                CELL_ATTR_INVERSE | CELL_ATTR_UNDERLINE,
+                                CELL_ATTR_UNDERLINE,
+                                CELL_ATTR_NONE,
+                                CELL_ATTR_INVERSE | CELL_ATTR_UNDERLINE,
+                                CELL_ATTR_NONE};
+    for (size_t c = 0; c < sizeof(expected); ++c)
+        CHECK_EQ(t.grid.cell(0, c).attr, expected[c]);
+
+    // Colours are dropped along with their sub-parameters, which would
+    // otherwise read as inverse (7) and underline (4)
+    t.feed("\r\n\x1b[38;5;7mh\x1b[48;2;4;7;4mi\x1b[1;31;7mj");
+    CHECK_EQ(t.grid.cell(1, 0).attr, CELL_ATTR_NONE);
+    CHECK_EQ(t.grid.cell(1, 1).attr, CELL_ATTR_NONE);
+    CHECK_EQ(t.grid.cell(1, 2).attr, CELL_ATTR_INVERSE);
+
+    // Erasing writes blanks without the current attributes
+    t.feed("\x1b[K");
+    CHECK_EQ(t.grid.cell(1, 3).attr, CELL_ATTR_NONE);
+}
+
+static void test_dec_graphics()
+{
+    Terminal t;
+    // G0 as line drawing: corners, lines and a tee; ASCII below 0x5F passes through
+    t.feed("\x1b(0lqqkAx\x1b(Bq");
+    CHECK(t.row(0) == "+--+A|q");
+
+    // G1 as line drawing, switched in with SO and out with SI
+    t.feed("\r\n\x1b)0q\x0eq\x0fq");
+    CHECK(t.row(1) == "q-q");
+
+    // DECSC and DECRC carry the designation along
+    t.feed("\r\n\x1b(0\x1b" "7\x1b(B\x1b" "8x");
+    CHECK(t.row(2) == "|");
+}
+
+static void test_utf8()
+{
+    Terminal t;
+    // Each character outside ASCII becomes one '?', whatever its length
+    t.feed("a\xc3\xa9" "b\xe2\x94\x80" "c\xf0\x9f\x98\x80" "d");
+    CHECK(t.row(0) == "a?b?c?d");
+
+    // A sequence cut short by ASCII or a new lead byte leaves that byte alone
+    t.feed("\r\n\xe2\x94" "e\xf0\xc3\xa9" "f");
+    CHECK(t.row(1) == "?e??f");
+
+    // Controls and escapes end a cut-short sequence and still act
+    t.feed("\r\n\xe2\r\xc3\x1b[5Gg");
+    CHECK(t.row(2) == "?   g");
+
+    // Stray continuation bytes are dropped
+    t.feed("\r\n\x80\xbfh");
+    CHECK(t.row(3) == "h");
+
+    // A character split across two feeds is still one '?'
+    t.feed("\r\n\xe2");
+    t.feed("\x94");
+    t.feed("\x80i");
+    CHECK(t.row(4) == "?i");
+}
+
+int main()
+{
+    test_cursor_position();
+    test_erase();
+    test_scroll_region();
+    test_insert_delete_lines();
+    test_sgr();
+    test_dec_graphics();
+    test_utf8();
+    return test_result("test_vt_parser");
+}